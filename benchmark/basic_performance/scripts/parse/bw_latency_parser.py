@@ -25,6 +25,7 @@
 #
 
 import csv
+import json
 import os
 import re
 from collections import defaultdict
@@ -32,11 +33,53 @@ from collections import defaultdict
 from loguru import logger
 
 
+RESULT_SCHEMA_VERSION = 1
+
+
+def parse_result_json(json_path):
+    # result.jsonl holds one record per job; bw vs latency runs have exactly one
+    with open(json_path) as f:
+        for line in f:
+            record = json.loads(line)
+            if record.get("schema_version") != RESULT_SCHEMA_VERSION:
+                logger.error(f"Unsupported result schema in {json_path}")
+                return None
+            summary = record["summary"]
+            if "total_bandwidth_mib_s" not in summary or "measured_latency_ns" not in summary:
+                continue
+            config = record["config"]
+            return {
+                "Access Type": config["access_type"],
+                "Latency Pattern": config["latency_pattern"],
+                "Bandwidth Pattern": config["bandwidth_pattern"],
+                "Size": f"{config['thread_buffer_size'] // (1024 * 1024)}MiB",
+                "Threads": config["num_threads"],
+                "Job Id": config["job_id"],
+                "LoadStore Type": config["loadstore_type"],
+                "Block Size (bytes)": config["lt_pattern_block_size"],
+                "Mem alloc Type": config["mem_alloc_type"],
+                "Chasing Type": config["chasing_type"],
+                "Total Bandwidth (MiB/s)": float(summary["total_bandwidth_mib_s"]),
+                "Measured Latency (ns)": int(summary["measured_latency_ns"]),
+            }
+    return None
+
+
 def parse_result_logs(base_dir):
     parsed_data = defaultdict(lambda: defaultdict(lambda: defaultdict(list)))
 
     for root, _, files in os.walk(base_dir):
-        if "result.log" in files:
+        if "result.jsonl" in files:
+            json_path = os.path.join(root, "result.jsonl")
+            result = parse_result_json(json_path)
+            if result:
+                access_type = result.pop("Access Type")
+                latency_pattern = result.pop("Latency Pattern")
+                bw_pattern = result.pop("Bandwidth Pattern")
+                parsed_data[access_type][latency_pattern][bw_pattern].append(result)
+            else:
+                logger.error(f"Skipping result file due to missing data: {json_path}")
+        elif "result.log" in files:
             log_path = os.path.join(root, "result.log")
             with open(log_path) as f:
                 content = f.read()
@@ -59,6 +102,7 @@ def parse_result_logs(base_dir):
                 # Bandwidth 및 Latency 추출
                 total_bandwidth = re.search(r"Total Bandwidth : ([\d.]+) MiB/s", content)
                 measured_latency = re.search(r"Measured Latency : (\d+) ns", content)
+                chasing_type = re.search(r"Chasing Type: (\w+)", content)
 
                 if test_info and total_bandwidth and measured_latency:
                     (
@@ -81,6 +125,7 @@ def parse_result_logs(base_dir):
                             "LoadStore Type": loadstore_type,
                             "Block Size (bytes)": int(block_size),
                             "Mem alloc Type": mem_alloc_type,
+                            "Chasing Type": chasing_type.group(1) if chasing_type else "RANDOM",
                             "Total Bandwidth (MiB/s)": float(total_bandwidth.group(1)),
                             "Measured Latency (ns)": int(measured_latency.group(1)),
                         }
@@ -110,6 +155,7 @@ def save_results_to_csv(data, output_file):
             "Total Bandwidth (MiB/s)",
             "Measured Latency (ns)",
             "Latency Pattern",
+            "Chasing Type",
             "Bandwidth Pattern",
         ]
         writer = csv.DictWriter(f, fieldnames=fieldnames)
@@ -122,6 +168,7 @@ def save_results_to_csv(data, output_file):
                         row = {
                             "Access Type": access_type,
                             "Latency Pattern": latency_pattern,
+                            "Chasing Type": test["Chasing Type"],
                             "Bandwidth Pattern": bw_pattern,
                             "LoadStore Type": test["LoadStore Type"],
                             "Threads": test["Threads"],
@@ -60,7 +60,8 @@ def parse_pattern(base_dir):
             log_path = os.path.join(root, "result.log")
             with open(log_path, "r") as f:
                 content = f.read()
-                test_info = re.search(
+                # One result.log holds every point of a batched session
+                for test_info in re.finditer(
                     r"=============== Test Information ===============.*?"
                     r"Number of Block:\s+(\d+).*?"
                     r"Stride Size:\s+(\d+).*?"
@@ -68,14 +69,13 @@ def parse_pattern(base_dir):
                     r"Core ID:\s+(\d+).*?"
                     r"Node ID:\s+(\d+).*?"
                     r"Access Order:\s+(\w+).*?"
-                    r"Load/Store Type:\s+(\w+).*?"
+                    r"Load/Store Type:\s+([\w-]+).*?"
                     r"=============== Test Results ===============.*?"
                     r"Average Store Latency:\s+(\d+)\s+cycles,\s+([\d.]+)\s+ns.*?"
                     r"Average Load Latency:\s+(\d+)\s+cycles,\s+([\d.]+)\s+ns",
                     content,
                     re.DOTALL  # Use DOTALL instead of MULTILINE to match across lines
-                )
-                if test_info:
+                ):
                     (
                         block_num,
                         stride_size,
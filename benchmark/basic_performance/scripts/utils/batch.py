@@ -156,6 +156,15 @@ def get_bin_path(build_type):
     return paths[build_type]
 
 
+RUN_OPTION_KEYS = [
+    "perf_events",
+    "convergence_target_ci",
+    "convergence_time_cap",
+    "convergence_min_batches",
+    "convergence_statistic",
+]
+
+
 def make_yaml_file(
     output_path,
     job_id,
@@ -174,6 +183,9 @@ def make_yaml_file(
     pattern_iteration,
     bw_load_pattern_block_size,
     bw_store_pattern_block_size,
+    chasing_type,
+    page_size_type,
+    options=None,
 ):
     config = {
         "job_id": job_id,
@@ -192,7 +204,11 @@ def make_yaml_file(
         "pattern_iteration": pattern_iteration,
         "bw_load_pattern_block_size": bw_load_pattern_block_size,
         "bw_store_pattern_block_size": bw_store_pattern_block_size,
+        "chasing_type": chasing_type,
+        "page_size_type": page_size_type,
     }
+    # Run-wide settings that are not swept, copied as they are
+    config.update(options or {})
     with open(output_path, "w") as file:
         yaml.dump(config, file)
     pass
@@ -253,6 +269,8 @@ def run_bw_latency_test(script_path, build_type, output_path, machine_type):
         config["pattern_iteration_array"],
         config["bandwidth_load_pattern_block_size"],
         config["bandwidth_store_pattern_block_size"],
+        config.get("chasing_type_array", [1]),
+        config.get("page_size_type_array", [0]),
     )
     prepare_run(script_path, machine_type)
     for (
@@ -271,6 +289,8 @@ def run_bw_latency_test(script_path, build_type, output_path, machine_type):
         pattern_iteration,
         bw_load_pattern_block_size,
         bw_store_pattern_block_size,
+        chasing_type,
+        page_size_type,
     ) in param_combinations:
         if not validate_buffer_size(thread_buffer_size, numa_node, machine_type):
             thread_buffer_size = search_valid_buffer_size(thread_buffer_size, numa_node, machine_type)
@@ -293,6 +313,9 @@ def run_bw_latency_test(script_path, build_type, output_path, machine_type):
             pattern_iteration,
             bw_load_pattern_block_size,
             bw_store_pattern_block_size,
+            chasing_type,
+            page_size_type,
+            {key: config[key] for key in RUN_OPTION_KEYS if key in config},
         )
         run_all(yaml_path, build_type, output_path)
         if build_type in ["designtest"]:
@@ -58,10 +58,12 @@ def make_yaml_file(
     dimm_start_addr_phys,
     cxl_start_addr_phys,
     test_size,
-    stride_size,
-    block_num,
+    stride_size_array,
+    block_num_array,
     socket_num,
-    snc_mode
+    snc_mode,
+    engine,
+    sample_interval,
 ):
     with open(yaml_path, "w") as f:
         yaml.dump(
@@ -77,10 +79,12 @@ def make_yaml_file(
                 "dimm_start_addr_phys": dimm_start_addr_phys,
                 "cxl_start_addr_phys": cxl_start_addr_phys,
                 "test_size": test_size,
-                "stride_size": stride_size,
-                "block_num": block_num,
+                "stride_size_array": stride_size_array,
+                "block_num_array": block_num_array,
                 "socket_num": socket_num,
                 "snc_mode": snc_mode,
+                "engine": engine,
+                "sample_interval": sample_interval,
             },
             f,
         )
@@ -142,7 +146,9 @@ def check_and_remove_module(module_name):
         logger.info(f"{module_name} module not found")
 
 
-def insert_module():
+# engine: 0 loads the module when it is built and otherwise leaves the run to
+# the userspace engine, 1 requires the module, 2 never loads it.
+def insert_module(required=True):
     logger.info("Inserting module")
     module_path = (
         get_workspace_path()
@@ -155,13 +161,21 @@ def insert_module():
         / "pointer_chasing.ko"
     )
     if not os.path.exists(module_path):
+        if not required:
+            logger.warning(f"Module file {module_path} does not exist, using the userspace engine.")
+            return False
         logger.error(f"Module file {module_path} does not exist.")
         sys.exit(1)
 
     cmd = f"insmod {module_path}"
     check_and_remove_module("pointer_chasing")
-    run_as_sudo(cmd)
-    pass
+    result = run_as_sudo(cmd)
+    if result is not None and result.exited != 0:
+        if not required:
+            logger.warning("Failed to insert the module, using the userspace engine.")
+            return False
+        raise RuntimeError(f"Command failed with exit code {result.exited}: {cmd}")
+    return True
 
 
 def remove_kernel_file():
@@ -195,44 +209,40 @@ def load_global_env():
         raise Exception("Error please make machine env file first @ utils/env_files")
     load_dotenv(dotenv_path=path)
     logger.info(f"hostname: {host_name}")
-    logger.info(f"dimm_phys_addr: {os.getenv('dimm_physical_start_addr')}")
-    logger.info(f"cxl_phys_addr: {os.getenv('cxl_physical_start_addr')}")
+    logger.info(f"dimm_phys_addr: {os.getenv('dimm_physical_start_addr', '0')}")
+    logger.info(f"cxl_phys_addr: {os.getenv('cxl_physical_start_addr', '0')}")
 
 
 def run_cache_test(script_path, output_path):
     config = batchutils.load_config(script_path)
-    insert_module()
+    engine = config.get("engine", 0)
+    module_inserted = False
+    if engine != 2:
+        module_inserted = insert_module(required=engine == 1)
     load_global_env()
-    dimm_phys_addr = os.getenv("dimm_physical_start_addr")
-    cxl_phys_addr = os.getenv("cxl_physical_start_addr")
+    # Physical addresses are only used by the kernel module
+    dimm_phys_addr = os.getenv("dimm_physical_start_addr", "0")
+    cxl_phys_addr = os.getenv("cxl_physical_start_addr", "0")
     test_size = int(os.getenv("test_size"), 16)
     socket_num = int(os.getenv("socket_number"))
     snc_mode = int(os.getenv("snc_mode"))
     test_type = config["test_type"]
     repeat = config["repeat"]
     use_flush = config["use_flush"]
+    # The stride x block_num heatmap and the flush/ldst types of one core,
+    # node and access order run as a single session of main_cache
     param_combinations = itertools.product(
         config["core_id"],
         config["node_id"],
-        config["flush_type"],
-        config["ldst_type"],
         config["access_order"],
-        config["stride_size_array"],
-        config["block_num_array"]
     )
     prepare_run(script_path)
     try:
         for (
             core_id,
             node_id,
-            flush_type,
-            ldst_type,
             access_order,
-            stride_size,
-            block_num
         ) in param_combinations:
-            if block_num * stride_size >= test_size:
-                continue
             yaml_path = get_workspace_path() / "benchmark" / "basic_performance" / "scripts" / "batch" / "temp.yaml"
             make_yaml_file(
                 yaml_path,
@@ -241,16 +251,18 @@ def run_cache_test(script_path, output_path):
                 use_flush,
                 core_id,
                 node_id,
-                flush_type,
-                ldst_type,
+                config["flush_type"],
+                config["ldst_type"],
                 access_order,
                 dimm_phys_addr,
                 cxl_phys_addr,
                 test_size,
-                stride_size,
-                block_num,
+                config["stride_size_array"],
+                config["block_num_array"],
                 socket_num,
-                snc_mode
+                snc_mode,
+                engine,
+                config.get("sample_interval", 0),
             )
             run_test(yaml_path, output_path)
             time.sleep(1)
@@ -261,7 +273,8 @@ def run_cache_test(script_path, output_path):
         try:
             wrap_up_run(script_path)
         finally:
-            try:
-                check_and_remove_module("pointer_chasing")
-            finally:
-                remove_kernel_file()
+            if module_inserted:
+                try:
+                    check_and_remove_module("pointer_chasing")
+                finally:
+                    remove_kernel_file()
@@ -29,18 +29,28 @@
 #ifndef CXL_PERF_APP_DATA_STRUCTURE_H
 #define CXL_PERF_APP_DATA_STRUCTURE_H
 
+#include <barrier>
 #include <chrono>
 #include <condition_variable>
 #include <core/system_define.h>
 #include <functional>
 #include <iostream>
+#include <machine/x86/pointer_chasing/pointer_chasing_ioctl.h>
 #include <mutex>
+#include <string>
 #include <thread>
+#include <utils/convergence.h>
+#include <utils/histogram.h>
+#include <utils/noise_monitor.h>
+#include <utils/perf_counter.h>
 #include <vector>
 
 struct WorkerTestLog {
   uint64_t size;
-  uint64_t latency;
+  // ns; fractional for the per-hop latency of the pointer chase
+  double latency;
+  uint64_t prepare_time;
+  uint64_t flush_time;
 };
 
 struct JobInfo {
@@ -60,6 +70,13 @@ struct JobInfo {
   BwPatternSize bw_store_pattern_block_size;
   uint32_t pattern_iteration;
   uint64_t thread_buffer_size;
+  CHASING_TYPE chasing_type;
+  PageSizeType page_size_type;
+  std::string perf_events;
+  double convergence_target;
+  double convergence_time_cap;
+  uint32_t convergence_min_batches;
+  ConvergenceStatistic convergence_statistic;
 };
 
 struct WorkerContext {
@@ -75,6 +92,7 @@ struct WorkerContext {
   uint64_t access_cnt;
   LoadStoreType ldst_type;
   LatencyPattern latency_pattern;
+  CHASING_TYPE chasing_type;
   BwPattern bw_pattern;
   BwPatternSize bw_load_pattern_block_size;
   BwPatternSize bw_store_pattern_block_size;
@@ -88,7 +106,23 @@ struct WorkerContext {
   std::mutex mutex;
   WorkerTestLog log;
   MemAllocType mem_alloc_type;
+  PageSizeType page_size_type;
+  std::string page_size_info;
+  uint64_t page_size; // size of the pages actually backing addr
+  std::vector<int> prepare_cpus; // helper CPUs for populating the buffer
+  // Shared by all workers of the job, so no one starts measuring while
+  // another still prepares its buffer
+  std::shared_ptr<std::barrier<>> start_barrier;
+  bool start_arrived;
   uint32_t pattern_iteration;
+  std::string perf_events;
+  std::shared_ptr<PerfCounterGroup> perf_counter;
+  PerfCounterValues perf_counts;
+  std::shared_ptr<NoiseMonitor> noise_monitor;
+  NoiseReport noise;
+  Histogram samples;
+  ConvergenceController convergence;
+  std::atomic<bool> converged;
 
   void get_work_descriptor(const std::shared_ptr<JobInfo> &job_info,
                            uint32_t coreid) {
@@ -104,11 +138,20 @@ struct WorkerContext {
     access_cnt = size / lt_pattern_access_size;
     ldst_type = job_info->ldst_type;
     latency_pattern = job_info->latency_pattern;
+    chasing_type = job_info->chasing_type;
     bw_pattern = job_info->bw_pattern;
     numa_id = job_info->numa_id;
     socket_id = job_info->socket_id;
     mem_alloc_type = job_info->mem_alloc_type;
+    page_size_type = job_info->page_size_type;
+    page_size = 4 * MEMUNIT::KiB; // until the buffer is allocated
     pattern_iteration = job_info->pattern_iteration;
+    perf_events = job_info->perf_events;
+    convergence.configure(job_info->convergence_target,
+                          job_info->convergence_time_cap,
+                          job_info->convergence_min_batches,
+                          job_info->convergence_statistic);
+    converged = false;
     bw_load_pattern_block_size = job_info->bw_load_pattern_block_size;
     bw_store_pattern_block_size = job_info->bw_store_pattern_block_size;
   }
@@ -125,34 +168,22 @@ struct WorkerInfo {
   std::vector<std::shared_ptr<WorkerContext>> worker_ctx;
 };
 
+// One cache test session: settings shared by all points, the engine and
+// the points themselves. sample_interval streams every Nth access of a
+// point besides its per-repeat totals; 0 streams the totals only. With
+// more than one core in core_ids, every point runs on all of them at once.
+struct CacheTestInfo {
+  pchasing_args_t args = {};
+  CacheEngine engine = CacheEngine::AUTO;
+  std::vector<pchasing_point_t> points;
+  std::vector<uint64_t> core_ids;
+  uint64_t sample_interval = 0;
+};
+
 using WorkFunc = std::function<void(std::shared_ptr<WorkerContext>)>;
 
 using StrideFunc = std::function<void(
     uint8_t *start_addr, uint64_t size, uint64_t skip, uint64_t delay,
     uint64_t count, uint64_t block_size, uint64_t *time_log)>;
 
-typedef struct pchasing_args {
-  uint64_t in_block_num;
-  uint64_t in_stride_size;
-  uint64_t in_repeat;
-  uint64_t in_core_id; 
-  uint64_t in_node_id;
-  uint64_t in_use_flush;
-  uint64_t in_flush_type;
-  uint64_t in_access_order;
-  uint64_t in_dimm_start_addr_phys;
-  uint64_t in_cxl_start_addr_phys;
-  uint64_t in_test_size;
-  uint64_t in_snc_mode;
-  uint64_t in_socket_num;
-  uint64_t in_ldst_type;
-  uint64_t in_test_type;
-  uint64_t out_latency_cycle_ld;
-  uint64_t out_latency_cycle_st;
-  uint64_t out_total_cycle_ld;
-  uint64_t out_total_cycle_st;
-  uint64_t out_total_ns_ld;
-  uint64_t out_total_ns_st;
-} pchasing_args_t;
-
 #endif // CXL_PERF_APP_DATA_STRUCTURE_H
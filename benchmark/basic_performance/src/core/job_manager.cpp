@@ -28,6 +28,7 @@
 
 #include <core/job_manager.h>
 #include <iostream>
+#include <machine/machine_dependency.h>
 #include <utils/logger.h>
 
 JobManager::JobManager() : _worker_factory(std::make_shared<WorkerFactory>()) {}
@@ -35,6 +36,12 @@ JobManager::JobManager() : _worker_factory(std::make_shared<WorkerFactory>()) {}
 void JobManager::prepare(const fs::path &output_path,
                          const std::shared_ptr<JobInfo> &jobInfo) {
   Logger::get_instance().open(output_path);
+  CycleTimer::calibrate();
+  Logger::get_instance().append(
+      "Cycle Timer : " + std::string(CycleTimer::name()) + ", " +
+      std::to_string(1.0 / CycleTimer::ns_per_cycle()) + " cycles/ns, " +
+      "overhead " + std::to_string(CycleTimer::overhead_cycles()) +
+      " cycles");
   _worker_handler = _worker_factory->get(jobInfo->job_id);
   if (!_worker_handler) {
     throw std::runtime_error("Worker not found");
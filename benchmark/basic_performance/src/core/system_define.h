@@ -75,9 +75,32 @@ enum class MemAllocType : uint32_t {
   NON_CONTIGUOUS_HUGE_PAGE = 1,
 };
 
+enum class PageSizeType : uint32_t {
+  PAGE_4K = 0,
+  PAGE_THP = 1,
+  PAGE_2M_HUGETLB = 2,
+  PAGE_1G_HUGETLB = 3,
+  PAGE_SIZE_TYPE_MAX
+};
+
+enum class CacheEngine : uint32_t {
+  AUTO = 0, // kernel module when /dev/pointer_chasing exists, else user space
+  KERNEL_MODULE = 1,
+  USER_SPACE = 2,
+};
+
 enum class CHASING_TYPE : uint32_t {
   CHASING_TYPE_LINEAR = 0,
   CHASING_TYPE_RANDOM,
+  // random order inside each page of the backing page size, pages visited
+  // in address order
+  CHASING_TYPE_PAGE_LOCAL_RANDOM,
+  // random order inside each 2 MiB region, regions visited in address order
+  CHASING_TYPE_REGION_2M_RANDOM,
+  // the same line of every page before moving to the next line
+  CHASING_TYPE_PAGE_STRIDE,
+  // a single line per page, pages visited in random order (TLB worst case)
+  CHASING_TYPE_LINE_PER_PAGE,
   CHASING_TYPE_MAX
 };
 
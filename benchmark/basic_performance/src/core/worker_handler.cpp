@@ -26,14 +26,18 @@
  *
  */
 
+#include <algorithm>
 #include <cerrno>
 #include <core/system_define.h>
 #include <core/worker_handler.h>
 #include <cstring>
 #include <iostream>
 #include <memory/mem_allocator.h>
+#include <memory/mem_preparer.h>
 #include <pthread.h>
 #include <sched.h>
+#include <utils/result_writer.h>
+#include <utils/timer.h>
 
 WorkerHandler::WorkerHandler() : _worker_info(std::make_shared<WorkerInfo>()) {}
 
@@ -48,16 +52,48 @@ void WorkerHandler::initialize(const std::shared_ptr<JobInfo> &job_info,
   _worker_info->socket_id = job_info->socket_id;
   _worker_info->mem_alloc_type = job_info->mem_alloc_type;
 
+  PageSizeType page_size_type = MemAllocator::reserve(
+      job_info->thread_buffer_size, job_info->num_threads,
+      static_cast<int>(job_info->numa_id), job_info->mem_alloc_type,
+      job_info->page_size_type);
+  // Split the node's CPUs other than the measured cores between the workers
+  // for populating their buffers
+  std::vector<int> helper_cpus;
+  for (int cpu :
+       MemPreparer::get_node_cpus(static_cast<int>(job_info->numa_id))) {
+    bool measured = false;
+    for (uint32_t i = 0; i < job_info->num_threads; i++) {
+      measured |= get_core_number(i, job_info->socket_id) ==
+                  static_cast<std::size_t>(cpu);
+    }
+    if (!measured) {
+      helper_cpus.push_back(cpu);
+    }
+  }
+  size_t prepare_threads = helper_cpus.size() / job_info->num_threads;
+  auto start_barrier =
+      std::make_shared<std::barrier<>>(job_info->num_threads);
+
   for (int i = 0; i < job_info->num_threads; i++) {
     auto ctx = std::make_shared<WorkerContext>();
     ctx->get_work_descriptor(job_info, i);
+    ctx->page_size_type = page_size_type;
+    if (prepare_threads == 0 && !helper_cpus.empty()) {
+      ctx->prepare_cpus = {helper_cpus[i % helper_cpus.size()]};
+    } else {
+      ctx->prepare_cpus.assign(
+          helper_cpus.begin() + i * prepare_threads,
+          helper_cpus.begin() + (i + 1) * prepare_threads);
+    }
+    ctx->start_barrier = start_barrier;
+    ctx->start_arrived = false;
     ctx->func = nullptr;
-    ctx->log = {0, 0};
+    ctx->log = {0, 0, 0, 0};
     ctx->stop_flag = false;
     _worker_info->worker_ctx.emplace_back(ctx);
   }
 
-  logger.append(generate_test_info(job_info));
+  logger.append(generate_test_info(job_info, page_size_type));
   for (int i = 0; i < job_info->num_threads; i++) {
     _worker_info->workers.emplace_back(WorkerHandler::work,
                                        _worker_info->worker_ctx[i]);
@@ -77,8 +113,11 @@ std::size_t WorkerHandler::get_core_number(int thread_num, SocketId socket_id) {
   return base_offset + thread_num;
 }
 
+// page_size_type is the page size the buffers got, after any fallback from
+// the requested one.
 std::string
-WorkerHandler::generate_test_info(const std::shared_ptr<JobInfo> &job_info) {
+WorkerHandler::generate_test_info(const std::shared_ptr<JobInfo> &job_info,
+                                  PageSizeType page_size_type) {
   std::string access_type = static_cast<int>(job_info->socket_id) ==
                                     static_cast<int>(job_info->numa_id)
                                 ? "LOCAL"
@@ -86,7 +125,13 @@ WorkerHandler::generate_test_info(const std::shared_ptr<JobInfo> &job_info) {
   access_type += "_" + std::to_string(static_cast<int>(job_info->socket_id)) +
                  "_" + std::to_string(static_cast<int>(job_info->numa_id));
   std::string ldst_type =
-      job_info->ldst_type == LoadStoreType::LOAD ? "LOAD" : "STORE";
+      job_info->ldst_type == LoadStoreType::LOAD    ? "LOAD"
+      : job_info->ldst_type == LoadStoreType::STORE ? "STORE"
+      : job_info->ldst_type == LoadStoreType::NT_LOAD  ? "NT_LOAD"
+      : job_info->ldst_type == LoadStoreType::NT_STORE ? "NT_STORE"
+      : job_info->ldst_type == LoadStoreType::LOAD_WITH_FLUSH
+          ? "LOAD_WITH_FLUSH"
+          : "STORE_WITH_FLUSH";
   std::string mem_alloc_type =
       job_info->mem_alloc_type == MemAllocType::CONTIGUOUS_HUGE_PAGE
           ? "CONTIGUOUS_HUGE_PAGE"
@@ -96,6 +141,17 @@ WorkerHandler::generate_test_info(const std::shared_ptr<JobInfo> &job_info) {
                                                               : "RANDOM_PC_LAT";
   std::string bw_pattern =
       job_info->bw_pattern == BwPattern::STRIDE_BW ? "STRIDE_BW" : "SIMPLE_BW";
+  std::string chasing_type =
+      job_info->chasing_type == CHASING_TYPE::CHASING_TYPE_LINEAR ? "LINEAR"
+      : job_info->chasing_type == CHASING_TYPE::CHASING_TYPE_RANDOM
+          ? "RANDOM"
+      : job_info->chasing_type == CHASING_TYPE::CHASING_TYPE_PAGE_LOCAL_RANDOM
+          ? "PAGE_LOCAL_RANDOM"
+      : job_info->chasing_type == CHASING_TYPE::CHASING_TYPE_REGION_2M_RANDOM
+          ? "REGION_2M_RANDOM"
+      : job_info->chasing_type == CHASING_TYPE::CHASING_TYPE_PAGE_STRIDE
+          ? "PAGE_STRIDE"
+          : "LINE_PER_PAGE";
   std::string bw_load_pattern_block_size =
       job_info->bw_load_pattern_block_size == BwPatternSize::SIZE_64B
           ? "SIZE_64B"
@@ -114,6 +170,32 @@ WorkerHandler::generate_test_info(const std::shared_ptr<JobInfo> &job_info) {
           ? "SIZE_256B"
           : "SIZE_512B";
 
+  _start_time = ResultWriter::get_timestamp();
+  _job_config = JsonObject();
+  _job_config.add("job_id", static_cast<uint32_t>(job_info->job_id))
+      .add("num_threads", job_info->num_threads)
+      .add("thread_buffer_size", job_info->thread_buffer_size)
+      .add("access_type", access_type)
+      .add("numa_id", static_cast<uint32_t>(job_info->numa_id))
+      .add("socket_id", static_cast<uint32_t>(job_info->socket_id))
+      .add("loadstore_type", ldst_type)
+      .add("lt_pattern_block_size", job_info->lt_pattern_block_size)
+      .add("lt_pattern_access_size", job_info->lt_pattern_access_size)
+      .add("lt_pattern_stride_size", job_info->lt_pattern_stride_size)
+      .add("delay", job_info->delay)
+      .add("mem_alloc_type", mem_alloc_type)
+      .add("latency_pattern", latency_pattern)
+      .add("bandwidth_pattern", bw_pattern)
+      .add("bw_load_pattern_block_size", bw_load_pattern_block_size)
+      .add("bw_store_pattern_block_size", bw_store_pattern_block_size)
+      .add("pattern_iteration", job_info->pattern_iteration)
+      .add("chasing_type", chasing_type)
+      .add("page_size_type",
+           MemAllocator::get_page_size_name(job_info->page_size_type))
+      .add("obtained_page_size_type",
+           MemAllocator::get_page_size_name(page_size_type))
+      .add("perf_events", job_info->perf_events);
+
   std::string msg =
       "========================================================================"
       "===================\n"
@@ -142,11 +224,122 @@ WorkerHandler::generate_test_info(const std::shared_ptr<JobInfo> &job_info) {
       "Bandwidth Store Pattern Block Size: " +
       bw_store_pattern_block_size +
       "\n"
+      "Chasing Type: " +
+      chasing_type +
+      "\n"
+      "Page Size: " + MemAllocator::get_page_size_name(page_size_type) +
+      "\n"
+      "Perf Events: " +
+      (job_info->perf_events.empty() ? "NONE" : job_info->perf_events) +
+      "\n"
       "========================================================================"
       "===================\n";
   return msg;
 }
 
+void WorkerHandler::report_preparation(Logger &logger) {
+  for (auto &worker_ctx : get_worker_info()->worker_ctx) {
+    logger.append("Worker : [" + std::to_string(worker_ctx->core_id) + "] " +
+                  "Page Size : " + worker_ctx->page_size_info);
+  }
+  for (auto &worker_ctx : get_worker_info()->worker_ctx) {
+    logger.append("Worker : [" + std::to_string(worker_ctx->core_id) + "] " +
+                  "Prepare Time : " +
+                  std::to_string(worker_ctx->log.prepare_time) + " ns, " +
+                  "Flush Time : " + std::to_string(worker_ctx->log.flush_time) +
+                  " ns");
+  }
+}
+
+void WorkerHandler::report_convergence(Logger &logger) {
+  for (auto &worker_ctx : get_worker_info()->worker_ctx) {
+    if (worker_ctx->convergence.count() == 0) {
+      continue;
+    }
+    logger.append("Worker : [" + std::to_string(worker_ctx->core_id) + "] " +
+                  "CI : " +
+                  worker_ctx->convergence.describe(worker_ctx->samples.unit()));
+  }
+}
+
+void WorkerHandler::report_noise(Logger &logger) {
+  for (auto &worker_ctx : get_worker_info()->worker_ctx) {
+    if (worker_ctx->noise.window_ns == 0) {
+      continue;
+    }
+    logger.append("Worker : [" + std::to_string(worker_ctx->core_id) + "] " +
+                  "Noise : " + worker_ctx->noise.describe());
+  }
+}
+
+void WorkerHandler::report_perf_counters(Logger &logger) {
+  for (auto &worker_ctx : get_worker_info()->worker_ctx) {
+    if (worker_ctx->perf_counts.empty()) {
+      continue;
+    }
+    std::string msg =
+        "Worker : [" + std::to_string(worker_ctx->core_id) + "] Counters :";
+    uint64_t cycles = 0, instructions = 0;
+    for (const auto &[name, value] : worker_ctx->perf_counts) {
+      msg += " " + name + "=" + std::to_string(value);
+      if (name == "cycles") {
+        cycles = value;
+      } else if (name == "instructions") {
+        instructions = value;
+      }
+    }
+    if (cycles != 0 && instructions != 0) {
+      msg += " ipc=" + std::to_string(static_cast<double>(instructions) /
+                                      static_cast<double>(cycles));
+    }
+    logger.append(msg);
+  }
+}
+
+JsonObject
+WorkerHandler::get_worker_result(const std::shared_ptr<WorkerContext> &ctx) {
+  JsonObject result;
+  result.add("worker", ctx->core_id)
+      .add("size_bytes", ctx->log.size)
+      .add("latency_ns", ctx->log.latency);
+  if (ctx->log.latency != 0 && ctx->log.size != 0) {
+    result.add("bandwidth_mib_s",
+               ctx->log.size * 1e9 / ctx->log.latency / MEMUNIT::MiB);
+  }
+  result.add("prepare_time_ns", ctx->log.prepare_time)
+      .add("flush_time_ns", ctx->log.flush_time)
+      .add("page_size", ctx->page_size_info);
+  JsonObject counters;
+  for (const auto &[name, value] : ctx->perf_counts) {
+    counters.add(name, value);
+  }
+  result.add("counters", counters)
+      .add("histogram", ctx->samples.to_json())
+      .add("ci", ctx->convergence.to_json())
+      .add("noise", ctx->noise.to_json());
+  return result;
+}
+
+// One record per job: the configuration, every worker and the handler's
+// summary.
+void WorkerHandler::write_result(const JsonObject &summary) {
+  std::vector<JsonObject> workers;
+  uint32_t noisy_workers = 0;
+  for (auto &worker_ctx : get_worker_info()->worker_ctx) {
+    workers.push_back(get_worker_result(worker_ctx));
+    noisy_workers += worker_ctx->noise.flags.empty() ? 0 : 1;
+  }
+  JsonObject record;
+  record.add("start_time", _start_time)
+      .add("end_time", ResultWriter::get_timestamp())
+      .add("config", _job_config)
+      .add("workers", workers)
+      .add("noisy_workers", noisy_workers)
+      .add("summary", summary);
+  ResultWriter writer(Logger::get_instance().get_directory());
+  writer.write("basic_performance", record);
+}
+
 void WorkerHandler::start() {
   std::cout << "Start worker threads" << std::endl;
   auto worker_info = get_worker_info();
@@ -174,6 +367,7 @@ void WorkerHandler::wrap_up() {
       worker.join();
     }
   }
+  MemAllocator::release();
 }
 
 void WorkerHandler::work(std::shared_ptr<WorkerContext> ctx) {
@@ -182,17 +376,35 @@ void WorkerHandler::work(std::shared_ptr<WorkerContext> ctx) {
       std::unique_lock<std::mutex> lock(ctx->mutex);
       ctx->ready.wait(lock, [&] { return ctx->func != nullptr; });
     }
-    ctx->addr = static_cast<uint8_t *>(MemAllocator::allocate(
-        ctx->size, static_cast<int>(ctx->numa_id), ctx->mem_alloc_type));
+    ctx->addr = static_cast<uint8_t *>(
+        MemAllocator::allocate(ctx->size, static_cast<int>(ctx->numa_id),
+                               ctx->mem_alloc_type, ctx->page_size_type));
     ctx->end_addr = ctx->addr + ctx->size;
-    std::memset(ctx->addr, 1, ctx->size);
+    Timer timer;
+    timer.start();
+    MemPreparer::populate(ctx->addr, ctx->size, ctx->prepare_cpus, 1);
+    ctx->log.prepare_time = static_cast<uint64_t>(timer.elapsed());
+    if (!ctx->perf_events.empty()) {
+      ctx->perf_counter = std::make_shared<PerfCounterGroup>();
+      if (!ctx->perf_counter->open(ctx->perf_events, sched_getcpu())) {
+        ctx->perf_counter = nullptr;
+      }
+    }
+    ctx->noise_monitor = std::make_shared<NoiseMonitor>();
+    ctx->noise_monitor->open(sched_getcpu());
+    ctx->page_size_info = MemAllocator::describe_page_size(ctx->addr);
+    ctx->page_size = MemAllocator::get_backing_page_size(ctx->addr);
 
     ctx->func(ctx);
+    PatternHandler::leave_start_barrier(ctx);
+    ctx->perf_counter = nullptr;
+    ctx->noise_monitor = nullptr;
 
     MemAllocator::deallocate(ctx->addr, ctx->size, ctx->mem_alloc_type);
   } catch (const std::exception &e) {
     std::cerr << "Error in Worker " << ctx->core_id << ": " << e.what()
               << std::endl;
+    PatternHandler::leave_start_barrier(ctx);
 
     if (ctx->addr) {
       MemAllocator::deallocate(ctx->addr, ctx->size, ctx->mem_alloc_type);
@@ -257,6 +469,7 @@ void WorkerHandlerForBandwidth::assign_handler(
 }
 
 void WorkerHandlerForBandwidth::report(Logger &logger) {
+  report_preparation(logger);
   uint64_t bandwidth_sum = 0;
   for (auto &worker_ctx : get_worker_info()->worker_ctx) {
     bandwidth_sum +=
@@ -273,11 +486,28 @@ void WorkerHandlerForBandwidth::report(Logger &logger) {
   }
   logger.append("Total Bandwidth : " + std::to_string(bandwidth_sum) +
                 " MiB/s");
+  report_convergence(logger);
+  report_noise(logger);
+  report_perf_counters(logger);
+  write_result(JsonObject().add("total_bandwidth_mib_s", bandwidth_sum));
 }
 
 void WorkerHandlerForBandwidth::wait() {
   auto worker_info = get_worker_info();
-  std::this_thread::sleep_for(std::chrono::seconds(10));
+  // Runs for the time cap (10 s by default), or until every worker's
+  // bandwidth converged if a convergence target is set
+  auto deadline = std::chrono::steady_clock::now() +
+                  worker_info->worker_ctx[0]->convergence.time_cap();
+  while (std::chrono::steady_clock::now() < deadline) {
+    bool all_converged = true;
+    for (auto &ctx : worker_info->worker_ctx) {
+      all_converged = all_converged && ctx->converged;
+    }
+    if (all_converged) {
+      break;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
   std::cout << "Send signal to stop worker threads" << std::endl;
   for (int i = 0; i < worker_info->num_threads; ++i) {
     {
@@ -292,7 +522,12 @@ WorkerHandlerForLatency::WorkerHandlerForLatency()
     : WorkerHandler(),
       _stride_latency_handler(std::make_shared<StrideLatencyPatternHandler>()),
       _pointer_chase_latency_handler(
-          std::make_shared<PointerChaseLatencyPatternHandler>()) {}
+          std::make_shared<PointerChaseLatencyPatternHandler>()) {
+  _latency_pattern_handler_map[LatencyPattern::STRIDE_LAT] =
+      _stride_latency_handler;
+  _latency_pattern_handler_map[LatencyPattern::RANDOM_PC_LAT] =
+      _pointer_chase_latency_handler;
+}
 
 void WorkerHandlerForLatency::assign_handler(
     int thread_num, std::shared_ptr<WorkerContext> ctx) {
@@ -304,7 +539,8 @@ void WorkerHandlerForLatency::assign_handler(
 }
 
 void WorkerHandlerForLatency::report(Logger &logger) {
-  uint64_t latency_sum = 0;
+  report_preparation(logger);
+  double latency_sum = 0.0;
   for (auto &worker_ctx : get_worker_info()->worker_ctx) {
     latency_sum += worker_ctx->log.latency;
     std::string msg =
@@ -315,6 +551,11 @@ void WorkerHandlerForLatency::report(Logger &logger) {
   logger.append("Average Latency : " +
                 std::to_string(latency_sum / get_worker_info()->num_threads) +
                 " ns");
+  report_convergence(logger);
+  report_noise(logger);
+  report_perf_counters(logger);
+  write_result(JsonObject().add(
+      "average_latency_ns", latency_sum / get_worker_info()->num_threads));
 }
 
 WorkerHandlerForBwVsLatency::WorkerHandlerForBwVsLatency()
@@ -368,6 +609,7 @@ void WorkerHandlerForBwVsLatency::wait() {
 }
 
 void WorkerHandlerForBwVsLatency::report(Logger &logger) {
+  report_preparation(logger);
   uint64_t bandwidth_sum = 0;
   for (int i = 1; i < get_worker_info()->num_threads; i++) {
     auto ctx = get_worker_info()->worker_ctx[i];
@@ -386,4 +628,13 @@ void WorkerHandlerForBwVsLatency::report(Logger &logger) {
   logger.append("Measured Latency : " +
                 std::to_string(get_worker_info()->worker_ctx[0]->log.latency) +
                 " ns");
+  report_convergence(logger);
+  report_noise(logger);
+  report_perf_counters(logger);
+  // Worker 0 measures latency while the others load the device
+  write_result(JsonObject()
+                   .add("total_bandwidth_mib_s", bandwidth_sum)
+                   .add("measured_latency_ns",
+                        get_worker_info()->worker_ctx[0]->log.latency)
+                   .add("latency_worker", 0));
 }
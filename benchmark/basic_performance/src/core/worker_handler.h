@@ -30,6 +30,7 @@
 #define CXL_PERF_APP_DT_WORKER_HANDLER_H
 #include <core/data_structure.h>
 #include <tasks/pattern_handler.h>
+#include <utils/json_object.h>
 #include <utils/logger.h>
 
 class WorkerHandler {
@@ -49,10 +50,21 @@ public:
                               std::shared_ptr<WorkerContext> ctx) = 0;
   virtual void report(Logger &logger) = 0;
 
+protected:
+  void report_preparation(Logger &logger);
+  void report_convergence(Logger &logger);
+  void report_noise(Logger &logger);
+  void report_perf_counters(Logger &logger);
+  JsonObject get_worker_result(const std::shared_ptr<WorkerContext> &ctx);
+  void write_result(const JsonObject &summary);
+
 private:
   std::shared_ptr<WorkerInfo> _worker_info;
+  JsonObject _job_config;
+  std::string _start_time;
   std::size_t get_core_number(int thread_num, SocketId socket_id);
-  std::string generate_test_info(const std::shared_ptr<JobInfo> &job_info);
+  std::string generate_test_info(const std::shared_ptr<JobInfo> &job_info,
+                                 PageSizeType page_size_type);
 };
 
 class WorkerHandlerForBandwidth : public WorkerHandler {
@@ -31,6 +31,7 @@
 
 #include <cstring>
 #include <iostream>
+#include <machine/arm/cycle_counter_arm.h>
 #include <machine/arm/mem_utils_arm.h>
 #include <utils/timer.h>
 
@@ -118,8 +119,9 @@ public:
     }
   }
 
+  template <typename TimerT>
   static inline void load_with_flush(uint8_t *addr, uint64_t size,
-                                     uint64_t *time_log, Timer &timer) {
+                                     uint64_t *time_log, TimerT &timer) {
     long size_cnt = 0;
     while (size_cnt < size) {
       timer.start();
@@ -257,8 +259,9 @@ public:
     }
   }
 
+  template <typename TimerT>
   static inline void store_with_flush(uint8_t *addr, uint64_t size,
-                                      uint64_t *time_log, Timer &timer) {
+                                      uint64_t *time_log, TimerT &timer) {
     long size_cnt = 0;
     while (size_cnt < size) {
       timer.start();
@@ -284,11 +287,41 @@ public:
 
   ~PointerChaseLdStPattern() = default;
 
+#pragma GCC push_options
+#pragma GCC optimize("O3")
+  // Each element holds the address of the next one, so every load depends on
+  // the previous one and no barrier or counter read is needed inside the walk.
+  static inline uint64_t *chase_64B(uint64_t *start, uint64_t hops) {
+    uint64_t *curr = start;
+    uint64_t unrolled = hops / 8;
+    for (uint64_t i = 0; i < unrolled; i++) {
+      asm volatile("ldr %0, [%0]\n\t"
+                   "ldr %0, [%0]\n\t"
+                   "ldr %0, [%0]\n\t"
+                   "ldr %0, [%0]\n\t"
+                   "ldr %0, [%0]\n\t"
+                   "ldr %0, [%0]\n\t"
+                   "ldr %0, [%0]\n\t"
+                   "ldr %0, [%0]\n\t"
+                   : "+r"(curr)
+                   :
+                   : "memory");
+    }
+    for (uint64_t i = 0; i < hops % 8; i++) {
+      asm volatile("ldr %0, [%0]\n\t" : "+r"(curr) : : "memory");
+    }
+    return curr;
+  }
+#pragma GCC pop_options
+
 #pragma GCC push_options
 #pragma GCC optimize("O0")
-  static inline void load_64B(uint64_t *base_addr, uint64_t region_size,
-                              uint64_t stride_size, uint64_t block_size,
-                              uint64_t *time_log, Timer &timer) {
+  template <typename TimerT>
+  static inline void load_64B_with_flush(uint64_t *base_addr,
+                                         uint64_t region_size,
+                                         uint64_t stride_size,
+                                         uint64_t block_size,
+                                         uint64_t *time_log, TimerT &timer) {
     uint64_t scanned_size = 0;
     uint64_t curr_pos = 0;
     uint64_t next_pos = 0;
@@ -323,10 +356,12 @@ public:
 
 #pragma GCC push_options
 #pragma GCC optimize("O0")
-  static inline void store_64B(uint64_t *base_addr, uint64_t region_size,
-                               uint64_t stride_size, uint64_t block_size,
-                               uint64_t *cindex, uint64_t *time_log,
-                               Timer &timer) {
+  template <typename TimerT>
+  static inline void store_64B_with_flush(uint64_t *base_addr,
+                                          uint64_t region_size,
+                                          uint64_t stride_size,
+                                          uint64_t block_size, uint64_t *cindex,
+                                          uint64_t *time_log, TimerT &timer) {
     uint64_t scanned_size = 0;
     uint64_t curr_pos = 0;
     uint64_t next_pos = 0;
@@ -0,0 +1,50 @@
+/*
+ *
+ * MIT License
+ *
+ * Copyright (c) 2025 Jangseon Park
+ * Affiliation: University of California San Diego CSE
+ * Email: jap036@ucsd.edu
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef CXL_PERF_APP_DT_CYCLE_COUNTER_MOCKUP_H
+#define CXL_PERF_APP_DT_CYCLE_COUNTER_MOCKUP_H
+#include <chrono>
+#include <cstdint>
+#include <utils/counter_timer.h>
+
+class CycleCounter {
+public:
+  static inline __attribute__((always_inline)) uint64_t start() {
+    return std::chrono::steady_clock::now().time_since_epoch().count();
+  }
+
+  static inline __attribute__((always_inline)) uint64_t stop() {
+    return std::chrono::steady_clock::now().time_since_epoch().count();
+  }
+
+  static const char *name() { return "steady_clock"; }
+};
+
+using CycleTimer = CounterTimer<CycleCounter>;
+
+#endif // CXL_PERF_APP_DT_CYCLE_COUNTER_MOCKUP_H
@@ -28,7 +28,9 @@
 
 #ifndef CXL_PERF_APP_DT_LDST_PATTERN_MOCKUP_H
 #define CXL_PERF_APP_DT_LDST_PATTERN_MOCKUP_H
+#include <cstdint>
 #include <cstring>
+#include <machine/mockup/cycle_counter_mockup.h>
 #include <utils/timer.h>
 
 class LdStPattern {
@@ -72,8 +74,9 @@ public:
     }
   }
 
+  template <typename TimerT>
   static inline void load_with_flush(uint8_t *addr, uint64_t size,
-                                     uint64_t *time_log, Timer &timer) {
+                                     uint64_t *time_log, TimerT &timer) {
     long size_cnt = 0;
     volatile char buffer[64]; // 64-byte buffer to simulate cache line access
     while (size_cnt < size) {
@@ -125,8 +128,9 @@ public:
     }
   }
 
+  template <typename TimerT>
   static inline void store_with_flush(uint8_t *addr, uint64_t size,
-                                      uint64_t *time_log, Timer &timer) {
+                                      uint64_t *time_log, TimerT &timer) {
     std::cout << "mockup store_with_flush" << std::endl;
     long size_cnt = 0;
     volatile char buffer[64] = {0}; // 64-byte buffer initialized with zeros
@@ -140,4 +144,58 @@ public:
     }
   }
 };
+
+class PointerChaseLdStPattern {
+public:
+  PointerChaseLdStPattern() = default;
+  ~PointerChaseLdStPattern() = default;
+
+  static inline uint64_t *chase_64B(uint64_t *start, uint64_t hops) {
+    volatile uint64_t *curr = start;
+    for (uint64_t i = 0; i < hops; i++) {
+      curr = reinterpret_cast<volatile uint64_t *>(*curr);
+    }
+    return const_cast<uint64_t *>(curr);
+  }
+
+  template <typename TimerT>
+  static inline void load_64B_with_flush(uint64_t *base_addr,
+                                         uint64_t region_size,
+                                         uint64_t stride_size,
+                                         uint64_t block_size,
+                                         uint64_t *time_log, TimerT &timer) {
+    uint64_t scanned_size = 0;
+    uint64_t curr_pos = 0;
+    *time_log = 0;
+    while (scanned_size < region_size) {
+      volatile uint64_t *curr_addr =
+          base_addr + curr_pos * stride_size / sizeof(uint64_t);
+      timer.start();
+      curr_pos = *curr_addr;
+      *time_log += timer.elapsed();
+      scanned_size += block_size;
+    }
+  }
+
+  template <typename TimerT>
+  static inline void store_64B_with_flush(uint64_t *base_addr,
+                                          uint64_t region_size,
+                                          uint64_t stride_size,
+                                          uint64_t block_size, uint64_t *cindex,
+                                          uint64_t *time_log, TimerT &timer) {
+    uint64_t scanned_size = 0;
+    uint64_t curr_pos = 0;
+    *time_log = 0;
+    while (scanned_size < region_size) {
+      volatile uint64_t *curr_addr =
+          base_addr + curr_pos * stride_size / sizeof(uint64_t);
+      uint64_t next_pos = cindex[curr_pos];
+      timer.start();
+      *curr_addr = next_pos;
+      *time_log += timer.elapsed();
+      curr_pos = next_pos;
+      scanned_size += block_size;
+    }
+  }
+};
 #endif // CXL_PERF_APP_DT_LDST_PATTERN_MOCKUP_H
@@ -0,0 +1,63 @@
+/*
+ *
+ * MIT License
+ *
+ * Copyright (c) 2025 Jangseon Park
+ * Affiliation: University of California San Diego CSE
+ * Email: jap036@ucsd.edu
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef CXL_PERF_APP_DT_CYCLE_COUNTER_X86_H
+#define CXL_PERF_APP_DT_CYCLE_COUNTER_X86_H
+#include <cstdint>
+#include <utils/counter_timer.h>
+
+class CycleCounter {
+public:
+  // rdtscp waits for all earlier instructions to execute and the trailing
+  // lfence keeps later instructions from starting before the TSC is read.
+  static inline __attribute__((always_inline)) uint64_t start() {
+    uint32_t lo, hi, aux;
+    asm volatile("rdtscp\n\t"
+                 "lfence\n\t"
+                 : "=a"(lo), "=d"(hi), "=c"(aux)
+                 :
+                 : "memory");
+    return (static_cast<uint64_t>(hi) << 32) | lo;
+  }
+
+  static inline __attribute__((always_inline)) uint64_t stop() {
+    uint32_t lo, hi, aux;
+    asm volatile("rdtscp\n\t"
+                 "lfence\n\t"
+                 : "=a"(lo), "=d"(hi), "=c"(aux)
+                 :
+                 : "memory");
+    return (static_cast<uint64_t>(hi) << 32) | lo;
+  }
+
+  static const char *name() { return "rdtscp"; }
+};
+
+using CycleTimer = CounterTimer<CycleCounter>;
+
+#endif // CXL_PERF_APP_DT_CYCLE_COUNTER_X86_H
@@ -28,6 +28,7 @@
 
 #ifndef CXL_PERF_APP_DT_MEM_UTILS_X86_H
 #define CXL_PERF_APP_DT_MEM_UTILS_X86_H
+#include <cpuid.h>
 #include <memory/mem_utils.h>
 
 class MemUtils : public MemUtilizable {
@@ -35,7 +36,19 @@ public:
   MemUtils() = default;
   ~MemUtils() override = default;
 
+  // clflushopt is only ordered by fences, so the lines of a whole buffer are
+  // flushed in parallel and a single sfence waits for all of them.
   inline void flush_cache(uint8_t *addr, uint64_t size) override {
+    if (has_clflushopt()) {
+      for (uint64_t i = 0; i < size; i += 64) {
+        asm volatile("clflushopt %0"
+                     :
+                     : "m"(*(uint8_t *)(addr + i))
+                     : "memory");
+      }
+      asm volatile("sfence" ::: "memory");
+      return;
+    }
     for (uint64_t i = 0; i < size; i += 64) {
       asm volatile("clflush %0" : : "m"(*(uint8_t *)(addr + i)) : "memory");
     }
@@ -43,6 +56,18 @@ public:
   }
 
   inline void fence_memory() override { asm volatile("mfence" ::: "memory"); }
+
+private:
+  static bool has_clflushopt() {
+    static const bool supported = [] {
+      unsigned int eax, ebx, ecx, edx;
+      if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) {
+        return false;
+      }
+      return (ebx & bit_CLFLUSHOPT) != 0;
+    }();
+    return supported;
+  }
 };
 
 #endif // CXL_PERF_APP_DT_MEM_UTILS_X86_H
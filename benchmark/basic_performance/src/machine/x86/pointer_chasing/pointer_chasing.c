@@ -40,12 +40,16 @@
 #include <linux/numa.h>
 #include <linux/io.h>
 #include <linux/ktime.h>
+#include <linux/mm.h>
+#include <linux/vmalloc.h>
+#include <linux/atomic.h>
+#include <linux/mutex.h>
+#include <linux/sched/task.h>
+#include <asm/fpu/api.h>
 
-#define DEVICE_NAME "pointer_chasing"
+#include "pointer_chasing_ioctl.h"
 
-#define PCH_IOC_MAGIC   'p'
-#define PCH_IOC_RUN     _IOWR(PCH_IOC_MAGIC, 1, pchasing_args_t)
-#define PCH_IOC_STOP    _IO(PCH_IOC_MAGIC, 2)
+#define DEVICE_NAME "pointer_chasing"
 
 #ifndef PCH_BLOCK_SIZE
 #define PCH_BLOCK_SIZE  64ULL
@@ -53,32 +57,82 @@
 
 #define RDRAND_MAX_RETRY 32
 
-typedef struct pchasing_args {
-  uint64_t in_block_num;
-  uint64_t in_stride_size;
-  uint64_t in_repeat;
-  uint64_t in_core_id; 
-  uint64_t in_node_id;
-  uint64_t in_use_flush;
-  uint64_t in_flush_type;
-  uint64_t in_access_order;
-  uint64_t in_dimm_start_addr_phys;
-  uint64_t in_cxl_start_addr_phys;
-  uint64_t in_test_size;
-  uint64_t in_snc_mode;
-  uint64_t in_socket_num;
-  uint64_t in_test_type;
-  uint64_t in_ldst_type;
-  uint64_t out_latency_cycle_ld;
-  uint64_t out_latency_cycle_st;
-  uint64_t out_total_cycle_ld;
-  uint64_t out_total_cycle_st;
-  uint64_t out_total_ns_ld;
-  uint64_t out_total_ns_st;
-} pchasing_args_t;
+/* largest block_num, the size of the index window the module used to keep */
+#define PCH_MAX_BLOCKS (1ULL << 27)
+
+/*
+ * View of the test buffer as chunks of 1 << shift physically contiguous
+ * bytes, each reached through the direct map so the chase does not pay
+ * for 4K vmap TLB entries. Pinned user buffers keep their pages for
+ * unpinning; the physical window is a single run and has none. base offsets
+ * a view into the buffer, e.g. a per-core slice.
+ */
+struct pch_buffer {
+  uint8_t **chunk;
+  uint64_t nr_chunks;
+  unsigned int shift;
+  uint64_t base;
+  uint64_t size;
+  struct page **pages;
+  unsigned long nr_pages;
+};
+
+/* settings, buffer and points of one ioctl, handed to the kthread */
+struct pch_session {
+  pchasing_args_t args;
+  struct pch_buffer buf;
+  pchasing_point_t *points;
+  uint64_t num_points;
+  uint64_t num_done;
+  uint64_t sample_interval;
+};
+
+/*
+ * What the store/load loops stream to the ring for the current point; NULL
+ * when the loops run concurrently, since the ring has a single producer.
+ */
+struct pch_trace {
+  uint32_t point;
+  uint64_t sample_interval;
+};
 
 static struct task_struct *pch_thread;
 static struct completion pch_comp;
+/* one run ioctl at a time: they share pch_thread, pch_comp and the ring */
+static DEFINE_MUTEX(pch_run_lock);
+
+/* timing ring shared with userspace, see pchasing_ring_t */
+static pchasing_ring_t *pch_ring;
+static pchasing_record_t *pch_records;
+
+/*
+ * Single producer: only the kthread pushes. The record is published by the
+ * release store of head, and a slot is reused only after the reader's
+ * release store of tail has moved past it.
+ */
+static inline void pch_ring_push(uint32_t point, uint16_t kind,
+                                 uint64_t repeat, uint64_t cycles)
+{
+  uint64_t head = pch_ring->head;
+  pchasing_record_t *rec;
+
+  if (head - smp_load_acquire(&pch_ring->tail) >= PCH_RING_RECORDS) {
+    WRITE_ONCE(pch_ring->dropped, pch_ring->dropped + 1);
+    return;
+  }
+  rec = &pch_records[head % PCH_RING_RECORDS];
+  rec->point = point;
+  rec->kind = kind;
+  rec->flags = repeat == 0 ? PCH_RECORD_WARMUP : 0;
+  rec->cycles = cycles;
+  smp_store_release(&pch_ring->head, head + 1);
+}
+
+static inline void *pch_addr(const struct pch_buffer *buf, uint64_t off)
+{
+  off += buf->base;
+  return buf->chunk[off >> buf->shift] + (off & ((1ULL << buf->shift) - 1));
+}
 
 static inline int pch_stop_requested(uint64_t iter)
 {
@@ -131,6 +185,88 @@ static inline __attribute__((always_inline)) void pch_clwb(void *addr)
   asm volatile("clwb (%0)" :: "r"(addr));
 }
 
+/*
+ * Timed accesses per ldst_type: 0 plain mov, 1 non-temporal, 2 locked
+ * read-modify-write. Each type has its own fenced rdtscp pair, so the type
+ * is never decided inside the timed window. The non-temporal load,
+ * movntdqa, only bypasses the caches on write-combining memory; on the
+ * write-back test buffer it is an ordinary load.
+ */
+static inline __attribute__((always_inline)) uint64_t
+pch_timed_store(uint64_t ldst_type, uint64_t *addr, uint64_t val)
+{
+  uint64_t start;
+
+  if (ldst_type == 1) {
+      pch_mfence();
+      start = pch_rdtscp();
+      asm volatile("movnti %[val], (%[addr])\n\t"
+                   :: [val] "r" (val), [addr] "r" (addr) : "memory");
+      pch_mfence();
+      return pch_rdtscp() - start;
+  }
+  if (ldst_type == 2) {
+      /* xchg with a memory operand is always locked */
+      pch_mfence();
+      start = pch_rdtscp();
+      asm volatile("xchgq %[val], (%[addr])\n\t"
+                   : [val] "+r" (val) : [addr] "r" (addr) : "memory");
+      pch_mfence();
+      return pch_rdtscp() - start;
+  }
+  pch_mfence();
+  start = pch_rdtscp();
+  asm volatile("movq %[val], (%[addr])\n\t"
+               :: [val] "r" (val), [addr] "r" (addr) : "memory");
+  pch_mfence();
+  return pch_rdtscp() - start;
+}
+
+/*
+ * movntdqa needs SSE state, which a kthread only owns between
+ * kernel_fpu_begin() and kernel_fpu_end(), and a 16-byte aligned address.
+ * The locked load adds 0, leaving the value in place.
+ */
+static inline __attribute__((always_inline)) uint64_t
+pch_timed_load(uint64_t ldst_type, uint64_t *addr, uint64_t *val)
+{
+  uint64_t start, end;
+
+  if (ldst_type == 1) {
+      kernel_fpu_begin();
+      pch_mfence();
+      start = pch_rdtscp();
+      asm volatile("movntdqa (%[addr]), %%xmm0\n\t"
+                   "movq %%xmm0, %[val]\n\t"
+                   : [val] "=r" (*val) : [addr] "r" (addr) : "xmm0", "memory");
+      pch_mfence();
+      end = pch_rdtscp();
+      kernel_fpu_end();
+      return end - start;
+  }
+  if (ldst_type == 2) {
+      *val = 0;
+      pch_mfence();
+      start = pch_rdtscp();
+      asm volatile("lock xaddq %[val], (%[addr])\n\t"
+                   : [val] "+r" (*val) : [addr] "r" (addr) : "memory");
+      pch_mfence();
+      return pch_rdtscp() - start;
+  }
+  pch_mfence();
+  start = pch_rdtscp();
+  asm volatile("movq (%[addr]), %[val]\n\t"
+               : [val] "=r" (*val) : [addr] "r" (addr) : "memory");
+  pch_mfence();
+  return pch_rdtscp() - start;
+}
+
+/* the non-temporal load needs every block 16-byte aligned */
+static inline bool pch_ldst_valid(uint64_t ldst_type, uint64_t stride_size)
+{
+  return ldst_type <= 2 && (ldst_type != 1 || stride_size % 16 == 0);
+}
+
 static inline int get_rand(uint64_t *rd, uint64_t range)
 {
   uint8_t ok;
@@ -194,28 +330,7 @@ static int init_chasing_index(uint64_t *cindex, uint64_t csize, uint64_t access_
   return 0;
 }
 
-static int pointer_chasing_reset(uint64_t *base_addr,
-                          uint64_t block_num,
-                          uint64_t stride_size,
-                          uint64_t *cindex)
-{
-  uint64_t accessed_block_num = 0;
-  uint64_t curr_pos = 0;
-  while (accessed_block_num < block_num) {
-      if (pch_stop_requested(accessed_block_num) != 0) {
-          return -EINTR;
-      }
-      uint64_t *curr_addr = (uint64_t *)((uint64_t)base_addr + curr_pos * stride_size);
-
-      *curr_addr = 0;
-
-      curr_pos = cindex[curr_pos];
-      accessed_block_num++;
-  }
-  return 0;
-}
-
-static int pointer_chasing_store(uint64_t *base_addr,
+static int pointer_chasing_store(const struct pch_buffer *buf,
                           uint64_t block_num,
                           uint64_t stride_size,
                           uint64_t repeat,
@@ -224,8 +339,11 @@ static int pointer_chasing_store(uint64_t *base_addr,
                           uint64_t use_flush,
                           uint64_t flush_type,
                           uint64_t test_type,
-                          uint64_t ldst_type)
+                          uint64_t ldst_type,
+                          const struct pch_trace *trace)
 {
+  uint64_t sample_interval = trace ? trace->sample_interval : 0;
+  uint64_t sample_left = sample_interval;
   int i = 0;
 
   for (i = 0; i < repeat; i++) {
@@ -240,24 +358,16 @@ static int pointer_chasing_store(uint64_t *base_addr,
           if (pch_stop_requested(accessed_block_num) != 0) {
               return -EINTR;
           }
-          uint64_t *curr_addr = (uint64_t *)((uint64_t)base_addr + curr_pos * stride_size);
+          uint64_t *curr_addr = (uint64_t *)pch_addr(buf, curr_pos * stride_size);
           next_pos = cindex[curr_pos];
 
-          pch_mfence();
-          uint64_t start = pch_rdtscp();
-
-          // store operation
           // *curr_addr = next_pos;
-          __asm__ volatile(
-              "movq %[val], (%[addr])\n\t"
-              :
-              : [val] "r" (next_pos), [addr] "r" (curr_addr)
-              : "memory"
-          );
-
-          pch_mfence();
-          uint64_t end = pch_rdtscp();
-          timing_store[i] += end - start;
+          uint64_t cycles = pch_timed_store(ldst_type, curr_addr, next_pos);
+          timing_store[i] += cycles;
+          if (sample_interval && --sample_left == 0) {
+              sample_left = sample_interval;
+              pch_ring_push(trace->point, PCH_RECORD_ACCESS_ST, i, cycles);
+          }
           
           curr_pos = next_pos;
           accessed_block_num++;
@@ -276,7 +386,7 @@ static int pointer_chasing_store(uint64_t *base_addr,
               if (pch_stop_requested(accessed_block_num) != 0) {
                   return -EINTR;
               }
-              uint64_t *curr_addr = (uint64_t *)((uint64_t)base_addr + curr_pos * stride_size);
+              uint64_t *curr_addr = (uint64_t *)pch_addr(buf, curr_pos * stride_size);
               if (flush_type == 0) pch_clflush(curr_addr);
               else if (flush_type == 1) pch_clflushopt(curr_addr);
               else if (flush_type == 2) pch_clwb(curr_addr);
@@ -290,11 +400,14 @@ static int pointer_chasing_store(uint64_t *base_addr,
               timing_store[i] = end - start;
           }
       }
+      if (trace) {
+          pch_ring_push(trace->point, PCH_RECORD_REPEAT_ST, i, timing_store[i]);
+      }
   }
   return 0;
 }
 
-static int pointer_chasing_load(uint64_t *base_addr,
+static int pointer_chasing_load(const struct pch_buffer *buf,
                           uint64_t block_num,
                           uint64_t stride_size,
                           uint64_t repeat,
@@ -303,8 +416,11 @@ static int pointer_chasing_load(uint64_t *base_addr,
                           uint64_t use_flush,
                           uint64_t flush_type,
                           uint64_t test_type,
-                          uint64_t ldst_type)
+                          uint64_t ldst_type,
+                          const struct pch_trace *trace)
 {
+  uint64_t sample_interval = trace ? trace->sample_interval : 0;
+  uint64_t sample_left = sample_interval;
   int i = 0;
 
   for (i = 0; i < repeat; i++) {
@@ -319,23 +435,15 @@ static int pointer_chasing_load(uint64_t *base_addr,
           if (pch_stop_requested(accessed_block_num) != 0) {
               return -EINTR;
           }
-          uint64_t *curr_addr = (uint64_t *)((uint64_t)base_addr + curr_pos * stride_size);
+          uint64_t *curr_addr = (uint64_t *)pch_addr(buf, curr_pos * stride_size);
 
-          pch_mfence();
-          uint64_t start = pch_rdtscp();
-
-          // load operation
           // next_pos = *curr_addr;
-          __asm__ volatile(
-              "movq (%[addr]), %[val]\n\t"
-              : [val] "=r" (next_pos)
-              : [addr] "r" (curr_addr)
-              : "memory"
-          );    
-
-          pch_mfence();
-          uint64_t end = pch_rdtscp();
-          timing_load[i] += end - start;
+          uint64_t cycles = pch_timed_load(ldst_type, curr_addr, &next_pos);
+          timing_load[i] += cycles;
+          if (sample_interval && --sample_left == 0) {
+              sample_left = sample_interval;
+              pch_ring_push(trace->point, PCH_RECORD_ACCESS_LD, i, cycles);
+          }
 
           curr_pos = next_pos;
           accessed_block_num++;
@@ -354,7 +462,7 @@ static int pointer_chasing_load(uint64_t *base_addr,
               if (pch_stop_requested(accessed_block_num) != 0) {
                   return -EINTR;
               }
-              uint64_t *curr_addr = (uint64_t *)((uint64_t)base_addr + curr_pos * stride_size);
+              uint64_t *curr_addr = (uint64_t *)pch_addr(buf, curr_pos * stride_size);
               if (flush_type == 0) pch_clflush(curr_addr);
               else if (flush_type == 1) pch_clflushopt(curr_addr);
               else if (flush_type == 2) pch_clwb(curr_addr);
@@ -368,46 +476,229 @@ static int pointer_chasing_load(uint64_t *base_addr,
               timing_load[i] = end - start;
           }
       }
+      if (trace) {
+          pch_ring_push(trace->point, PCH_RECORD_REPEAT_LD, i, timing_load[i]);
+      }
   }
   return 0;
 }
 
 
-static int pointer_chasing_thread(void *data)
+/* touch the pages of [from, to) so that later points start warm */
+static int pch_touch(const struct pch_buffer *buf, uint64_t from, uint64_t to)
+{
+  uint64_t off;
+
+  for (off = round_down(from, PAGE_SIZE); off < to; off += PAGE_SIZE) {
+    if (pch_stop_requested(off >> PAGE_SHIFT) != 0) {
+      return -EINTR;
+    }
+    (void)READ_ONCE(*(uint64_t *)pch_addr(buf, off));
+  }
+  return 0;
+}
+
+static int pointer_chasing_point(pchasing_args_t *args,
+                                 pchasing_point_t *point,
+                                 const struct pch_trace *trace,
+                                 uint64_t *cindex,
+                                 const struct pch_buffer *buf,
+                                 uint64_t *timing_st,
+                                 uint64_t *timing_ld)
 {
-  pchasing_args_t *args = (pchasing_args_t *)data;
-  void *base_addr_virt = NULL;
+  uint64_t block_num = point->in_block_num;
+  uint64_t stride_size = point->in_stride_size;
+  uint64_t repeat = args->in_repeat;
+  uint64_t start_cycle_st, end_cycle_st, start_cycle_ld, end_cycle_ld;
+  uint64_t start_ns_st, end_ns_st, start_ns_ld, end_ns_ld;
+  uint64_t sum_st = 0, sum_ld = 0;
+  uint64_t i;
+  int ret;
+
+  memset(timing_st, 0, sizeof(uint64_t)*repeat);
+  memset(timing_ld, 0, sizeof(uint64_t)*repeat);
+
+  pch_mfence();
+  start_cycle_st = pch_rdtscp();
+  start_ns_st = ktime_get_ns();
+  ret = pointer_chasing_store(buf, block_num, stride_size, repeat, cindex, timing_st,
+                              args->in_use_flush, point->in_flush_type, args->in_test_type,
+                              point->in_ldst_type, trace);
+  if (ret != 0) {
+    return ret;
+  }
+  pch_mfence();
+  end_cycle_st = pch_rdtscp();
+  end_ns_st = ktime_get_ns();
+
+  pch_mfence();
+  start_cycle_ld = pch_rdtscp();
+  start_ns_ld = ktime_get_ns();
+  ret = pointer_chasing_load(buf, block_num, stride_size, repeat, cindex, timing_ld,
+                             args->in_use_flush, point->in_flush_type, args->in_test_type,
+                             point->in_ldst_type, trace);
+  if (ret != 0) {
+    return ret;
+  }
+  pch_mfence();
+  end_cycle_ld = pch_rdtscp();
+  end_ns_ld = ktime_get_ns();
+
+  for (i = 1; i < repeat; i++) {
+      sum_st += timing_st[i];
+      sum_ld += timing_ld[i];
+  }
+  point->out_latency_cycle_st = sum_st / block_num / (repeat - 1);
+  point->out_latency_cycle_ld = sum_ld / block_num / (repeat - 1);
+  point->out_total_cycle_st = end_cycle_st - start_cycle_st;
+  point->out_total_cycle_ld = end_cycle_ld - start_cycle_ld;
+  point->out_total_ns_st = end_ns_st - start_ns_st;
+  point->out_total_ns_ld = end_ns_ld - start_ns_ld;
+  return 0;
+}
+
+/*
+ * Largest chunk the pinned pages allow: a chunk boundary must not fall
+ * inside a physically contiguous run, so every break in the pfns caps the
+ * chunk size at the alignment of its page index. 1G hugetlb pages give 1G
+ * chunks, fragmented 4K pages one chunk per page.
+ */
+static unsigned int pch_chunk_shift(struct page **pages, unsigned long nr_pages)
+{
+  unsigned int shift = PUD_SHIFT;
+  unsigned long i;
+
+  for (i = 1; i < nr_pages; i++) {
+    if (page_to_pfn(pages[i]) != page_to_pfn(pages[i - 1]) + 1) {
+      shift = min_t(unsigned int, shift, PAGE_SHIFT + __ffs(i));
+    }
+  }
+  return shift;
+}
+
+/*
+ * Runs in the ioctl, in the caller's mm. Pages are pinned without
+ * FOLL_LONGTERM, which would migrate them off ZONE_MOVABLE and with that
+ * off most CXL nodes; the pin only lasts for the ioctl anyway.
+ */
+static int pch_buffer_get(pchasing_args_t *args, struct pch_buffer *buf)
+{
+  uint64_t node_id = args->in_node_id;
+  uint64_t cxl_mem_node = args->in_snc_mode * args->in_socket_num;
   uint64_t base_addr_phys = 0;
-  uint64_t block_num = args->in_block_num;
-  uint64_t stride_size = args->in_stride_size;
+  uint64_t i;
+  long pinned;
+
+  memset(buf, 0, sizeof(*buf));
+
+  if (args->in_buf_addr != 0) {
+    if (args->in_buf_size == 0 || !PAGE_ALIGNED(args->in_buf_addr) ||
+        !PAGE_ALIGNED(args->in_buf_size)) {
+      pr_err("%s: buffer must be page aligned.\n", __func__);
+      return -EINVAL;
+    }
+    buf->size = args->in_buf_size;
+    buf->nr_pages = buf->size >> PAGE_SHIFT;
+    buf->pages = kvmalloc_array(buf->nr_pages, sizeof(*buf->pages), GFP_KERNEL);
+    if (!buf->pages) {
+      return -ENOMEM;
+    }
+    for (i = 0; i < buf->nr_pages; i += pinned) {
+      pinned = pin_user_pages_fast(args->in_buf_addr + (i << PAGE_SHIFT),
+                                   (int)min_t(uint64_t, buf->nr_pages - i, INT_MAX),
+                                   FOLL_WRITE, buf->pages + i);
+      if (pinned <= 0) {
+        pr_err("%s: pin_user_pages_fast failed: %ld\n", __func__, pinned);
+        unpin_user_pages(buf->pages, i);
+        kvfree(buf->pages);
+        buf->pages = NULL;
+        return pinned < 0 ? (int)pinned : -EFAULT;
+      }
+    }
+    buf->shift = pch_chunk_shift(buf->pages, buf->nr_pages);
+  } else {
+    if (!node_online(node_id)) {
+      pr_err("Node %llu is not online or does not exist.\n", node_id);
+      return -ENODEV;
+    }
+    if (node_id == 0) {
+        base_addr_phys = args->in_dimm_start_addr_phys;
+    }
+    else if (node_id == cxl_mem_node) {
+        base_addr_phys = args->in_cxl_start_addr_phys;
+    }
+    else {
+        pr_err("pointer-chasing is not supported on this node.\n");
+        return -EINVAL;
+    }
+    buf->size = args->in_test_size;
+    buf->shift = PUD_SHIFT;
+  }
+
+  buf->nr_chunks = DIV_ROUND_UP(buf->size, 1ULL << buf->shift);
+  buf->chunk = kvmalloc_array(buf->nr_chunks, sizeof(*buf->chunk), GFP_KERNEL);
+  if (!buf->chunk) {
+    if (buf->pages) {
+      unpin_user_pages(buf->pages, buf->nr_pages);
+      kvfree(buf->pages);
+      buf->pages = NULL;
+    }
+    return -ENOMEM;
+  }
+  for (i = 0; i < buf->nr_chunks; i++) {
+    if (buf->pages) {
+      buf->chunk[i] = page_address(buf->pages[i << (buf->shift - PAGE_SHIFT)]);
+    } else {
+      buf->chunk[i] = (uint8_t *)phys_to_virt(base_addr_phys) + (i << buf->shift);
+    }
+  }
+
+  if (buf->pages) {
+    pr_info("%s: pinned 0x%llx bytes at 0x%llx, first page on node %d, %llu chunks of 0x%llx\n",
+            __func__, buf->size, args->in_buf_addr, page_to_nid(buf->pages[0]),
+            buf->nr_chunks, 1ULL << buf->shift);
+  } else {
+    pr_info("%s: phys_addr: 0x%llx, virt_addr: 0x%llx, size: 0x%llx\n", __func__,
+            base_addr_phys, (uint64_t)buf->chunk[0], buf->size);
+  }
+  return 0;
+}
+
+static void pch_buffer_put(struct pch_buffer *buf)
+{
+  if (buf->pages) {
+    unpin_user_pages_dirty_lock(buf->pages, buf->nr_pages, true);
+    kvfree(buf->pages);
+    buf->pages = NULL;
+  }
+  kvfree(buf->chunk);
+  buf->chunk = NULL;
+}
+
+/*
+ * Runs every point of the session on the session's buffer. The touched
+ * pages, the timing buffers and the chasing index, which lives on the
+ * kthread's node rather than on the memory under test, are set up once;
+ * the index is only rebuilt when block_num changes between points.
+ */
+static int pointer_chasing_thread(void *data)
+{
+  struct pch_session *sess = (struct pch_session *)data;
+  pchasing_args_t *args = &sess->args;
+  const struct pch_buffer *buf = &sess->buf;
   uint64_t repeat = args->in_repeat;
   uint64_t core_id = args->in_core_id;
   uint64_t node_id = args->in_node_id;
-  uint64_t use_flush = args->in_use_flush;
   uint64_t access_order = args->in_access_order;
-  uint64_t dimm_start_addr_phys = args->in_dimm_start_addr_phys;
-  uint64_t cxl_start_addr_phys = args->in_cxl_start_addr_phys;
-  uint64_t test_size = args->in_test_size;
-  uint64_t snc_mode = args->in_snc_mode;
-  uint64_t socket_num = args->in_socket_num;
-  uint64_t ldst_type = args->in_ldst_type;
-  uint64_t test_type = args->in_test_type;
-  uint64_t flush_type = args->in_flush_type;
-  uint64_t cxl_mem_node = snc_mode * socket_num;
-  uint64_t region_skip = block_num * stride_size;
   uint64_t *cindex = NULL;
   uint64_t *timing_ld  = NULL;
   uint64_t *timing_st = NULL;
+  uint64_t cindex_blocks = 0, max_blocks = 0;
+  uint64_t touched_test = 0;
   int online_numa_node_count = num_online_nodes();
   uint64_t node_start_t, node_end_t;
+  uint64_t p;
   int i;
-  uint64_t hash = 0;
-  uint64_t *buf;
-  int pages;
-  uint64_t *test_buf;
-  uint64_t start_cycle_st, end_cycle_st, start_cycle_ld, end_cycle_ld;
-  uint64_t start_ns_st, end_ns_st, start_ns_ld, end_ns_ld;
-  uint64_t sum_st = 0, sum_ld = 0;
   int ret = 0;
 
   pr_info("%s: number of online NUMA nodes: %d\n", __func__, online_numa_node_count);
@@ -419,206 +710,542 @@ static int pointer_chasing_thread(void *data)
         __func__, i, node_start_t, node_end_t);
   }
 
-  if (!node_online(node_id)) {
-    pr_err("Node %llu is not online or does not exist.\n", node_id);
-    ret = -ENODEV;
-    goto out_complete;
-  }
-
-  pr_info("%s: started pointer-chasing on CPU [%llu] and NUMA node [%llu]\n", __func__, core_id, node_id);
+  pr_info("%s: started pointer-chasing on CPU [%llu] and NUMA node [%llu] for %llu points\n",
+          __func__, core_id, node_id, sess->num_points);
 
-  if (node_id == 0) {
-      base_addr_phys = dimm_start_addr_phys;
-      base_addr_virt = phys_to_virt(base_addr_phys);
-  }
-  else if (node_id == cxl_mem_node) {
-      base_addr_phys = cxl_start_addr_phys;
-      base_addr_virt = phys_to_virt(base_addr_phys);
-  }
-  else {
-      pr_err("pointer-chasing is not supported on this node.\n");
-      ret = -EINVAL;
-      goto out_complete;
+  if (repeat < 2) {
+    pr_err("repeat must be at least 2.\n");
+    ret = -EINVAL;
+    goto out_complete;
   }
-  
-  pr_info("%s: phys_addr: 0x%llx, virt_addr: 0x%llx, size: 0x%llx\n", __func__, base_addr_phys, (uint64_t)base_addr_virt, test_size);
 
-  /* fill page tables */
-  pages = roundup(2 * region_skip, PAGE_SIZE) >> PAGE_SHIFT;
-  for (i = 0; i < pages; i++) {
-    ret = pch_stop_requested(i);
-    if (ret != 0) {
-      goto out_complete;
+  for (p = 0; p < sess->num_points; p++) {
+    if (sess->points[p].in_block_num <= PCH_MAX_BLOCKS) {
+      max_blocks = max(max_blocks, sess->points[p].in_block_num);
     }
-    buf  = (uint64_t *)base_addr_virt + (i << PAGE_SHIFT);
-    hash = hash ^ *buf;
   }
+  cindex = (uint64_t*)kvzalloc_node(max_blocks * sizeof(uint64_t), GFP_KERNEL,
+                                    cpu_to_node((int)core_id));
+  timing_st = (uint64_t*)kmalloc_array(repeat, sizeof(uint64_t), GFP_KERNEL);
+  timing_ld = (uint64_t*)kmalloc_array(repeat, sizeof(uint64_t), GFP_KERNEL);
 
-  cindex = (uint64_t*)base_addr_virt; //(uint64_t*)kmalloc(sizeof(uint64_t)*block_num, GFP_KERNEL);
-  timing_st = (uint64_t*)kmalloc(sizeof(uint64_t)*repeat, GFP_KERNEL);
-  timing_ld = (uint64_t*)kmalloc(sizeof(uint64_t)*repeat, GFP_KERNEL);
-
-  if (!timing_ld || !timing_st) {
+  if (!cindex || !timing_ld || !timing_st) {
       pr_err("kmalloc failed.\n");
       ret = -ENOMEM;
       goto out_cleanup;
   }
 
-  memset(cindex, 0, sizeof(uint64_t)*block_num);
-  memset(timing_st, 0, sizeof(uint64_t)*repeat);
-  memset(timing_ld, 0, sizeof(uint64_t)*repeat);
+  for (p = 0; p < sess->num_points; p++) {
+    pchasing_point_t *point = &sess->points[p];
+    struct pch_trace trace = { (uint32_t)p, sess->sample_interval };
+    uint64_t block_num = point->in_block_num;
+    uint64_t region_skip = block_num * point->in_stride_size;
+
+    if (block_num == 0 || point->in_stride_size < sizeof(uint64_t) ||
+        block_num > PCH_MAX_BLOCKS || region_skip > buf->size ||
+        !pch_ldst_valid(point->in_ldst_type, point->in_stride_size)) {
+      point->out_status = -EINVAL;
+      continue;
+    }
 
-  ret = init_chasing_index(cindex, block_num, access_order);
-  if (ret != 0) {
-      pr_err("init_chasing_index failed.\n");
-      if (ret > 0) {
-        ret = -EFAULT;
+    /* warm the buffer, only the part no earlier point has touched */
+    if (region_skip > touched_test) {
+      ret = pch_touch(buf, touched_test, region_skip);
+      if (ret != 0) {
+        goto out_cleanup;
       }
-      goto out_cleanup;
-  }
-  pr_info("%s: finished cindex generation.\n", __func__);
-
-  test_buf = (uint64_t *)((uint64_t)base_addr_virt + 0x40000000); // First 1GB for storing cindex
-
-  pch_mfence();
-  start_cycle_st = pch_rdtscp();
-  start_ns_st = ktime_get_ns();
-  ret = pointer_chasing_store(test_buf, block_num, stride_size, repeat, cindex, timing_st, use_flush, flush_type, test_type, ldst_type);
-  if (ret != 0) {
-    goto out_cleanup;
-  }
-  pch_mfence();
-  end_cycle_st = pch_rdtscp();
-  end_ns_st = ktime_get_ns();
-  pr_info("%s: finished store pointer-chasing, start_cycle: %llu, end_cycle: %llu, start_ns: %llu, end_ns: %llu\n"
-          , __func__, start_cycle_st, end_cycle_st, start_ns_st, end_ns_st);
-  
-  pch_mfence();
-  start_cycle_ld = pch_rdtscp();
-  start_ns_ld = ktime_get_ns();
-  ret = pointer_chasing_load(test_buf, block_num, stride_size, repeat, cindex, timing_ld, use_flush, flush_type, test_type, ldst_type);
-  if (ret != 0) {
-    goto out_cleanup;
-  }
-  pch_mfence();
-  end_cycle_ld = pch_rdtscp();
-  end_ns_ld = ktime_get_ns();
-  pr_info("%s: finished load pointer-chasing, start_cycle: %llu, end_cycle: %llu, start_ns: %llu, end_ns: %llu\n"
-          , __func__, start_cycle_ld, end_cycle_ld, start_ns_ld, end_ns_ld);
+      touched_test = region_skip;
+    }
 
-  for (i = 1; i < repeat; i++) {
-      sum_st += timing_st[i];
-      sum_ld += timing_ld[i];
-  }
-  args->out_latency_cycle_st = sum_st / block_num / (repeat - 1);
-  args->out_latency_cycle_ld = sum_ld / block_num / (repeat - 1);
-  args->out_total_cycle_st = end_cycle_st - start_cycle_st;
-  args->out_total_cycle_ld = end_cycle_ld - start_cycle_ld;
-  args->out_total_ns_st = end_ns_st - start_ns_st;
-  args->out_total_ns_ld = end_ns_ld - start_ns_ld;
+    if (block_num != cindex_blocks) {
+      memset(cindex, 0, sizeof(uint64_t)*max(block_num, cindex_blocks));
+      cindex_blocks = 0;
+      ret = init_chasing_index(cindex, block_num, access_order);
+      if (ret != 0) {
+          pr_err("init_chasing_index failed.\n");
+          if (ret > 0) {
+            ret = -EFAULT;
+          }
+          goto out_cleanup;
+      }
+      cindex_blocks = block_num;
+    }
 
-  ret = pointer_chasing_reset((uint64_t *)base_addr_virt, block_num, stride_size, cindex);
-  if (ret != 0) {
-    goto out_cleanup;
+    ret = pointer_chasing_point(args, point, &trace, cindex, buf,
+                                timing_st, timing_ld);
+    if (ret != 0) {
+      point->out_status = ret;
+      goto out_cleanup;
+    }
+    point->out_status = 0;
+    sess->num_done++;
   }
-  // pr_info("%s: finished reset pointer-chasing.\n", __func__);
 
 out_cleanup:
-  memset(cindex, 0, sizeof(uint64_t)*block_num);
+  kvfree(cindex);
   kfree(timing_st);
   kfree(timing_ld);
 
 out_complete:
   complete(&pch_comp);
   if (ret == 0) {
-    pr_info("%s: finished pointer-chasing\n", __func__);
+    pr_info("%s: finished pointer-chasing, %llu of %llu points done\n",
+            __func__, sess->num_done, sess->num_points);
   } else if (ret == -EINTR) {
     pr_info("%s: interrupted by stop request\n", __func__);
   }
   return ret;
 }
 
-static long pointer_chasing_ioctl(struct file *file, unsigned int cmd, unsigned long arg)
+/* runs the session in a kthread bound to in_core_id and waits for it */
+static int pch_run_thread(struct pch_session *sess)
 {
-  pchasing_args_t karg;
   int ret;
   int wait_ret;
 
-  if (_IOC_TYPE(cmd) != PCH_IOC_MAGIC) {
-      pr_err("Invalid magic number.\n");
+  if (pch_thread) {
+      pr_info("%s: Thread already exists, please stop it first or handle accordingly.\n", __func__);
+      kthread_stop(pch_thread);
+      put_task_struct(pch_thread);
+      pch_thread = NULL;
+  }
+
+  init_completion(&pch_comp);
+
+  pch_thread = kthread_create(pointer_chasing_thread, (void *)sess, "pch_thread");
+  if (IS_ERR(pch_thread)) {
+      pr_err("kthread_create failed.\n");
+      ret = PTR_ERR(pch_thread);
+      pch_thread = NULL;
+      return ret;
+  }
+  /* the thread exits after complete(), keep its task for kthread_stop() */
+  get_task_struct(pch_thread);
+
+  kthread_bind(pch_thread, (int)sess->args.in_core_id);
+  wake_up_process(pch_thread);
+  wait_ret = wait_for_completion_interruptible(&pch_comp);
+  if (wait_ret < 0) {
+      pr_info("%s: interrupted while waiting for pointer-chasing thread.\n", __func__);
+  }
+
+  ret = kthread_stop(pch_thread);
+  put_task_struct(pch_thread);
+  pch_thread = NULL;
+  if (wait_ret < 0) {
+      return wait_ret;
+  }
+  if (ret == -EINTR) {
+      pr_info("%s: pointer_chasing_thread stopped by request.\n", __func__);
+      return -EINTR;
+  }
+  if (ret < 0) {
+      pr_err("%s: pointer_chasing_thread failed: %d\n", __func__, ret);
+      return ret;
+  }
+  pr_info("%s: pointer_chasing_thread finished.\n", __func__);
+  return 0;
+}
+
+/* holds the session's buffer for the whole run */
+static int pch_run_session(struct pch_session *sess)
+{
+  int ret;
+
+  ret = pch_buffer_get(&sess->args, &sess->buf);
+  if (ret != 0) {
+      return ret;
+  }
+  ret = pch_run_thread(sess);
+  pch_buffer_put(&sess->buf);
+  return ret;
+}
+
+static long pch_ioctl_run(unsigned long arg)
+{
+  struct pch_session sess = {};
+  pchasing_point_t point = {};
+  int ret;
+
+  if (copy_from_user(&sess.args, (void __user *)arg, sizeof(sess.args))) {
+      pr_err("copy_from_user failed.\n");
+      return -EFAULT;
+  }
+
+  pr_info("%s: block_num=%llu, stride_size=%llu, repeat=%llu, core_id=%llu, node_id=%llu, flush=%llu\n, access_order=%llu\n", 
+          __func__,
+          sess.args.in_block_num,
+          sess.args.in_stride_size,
+          sess.args.in_repeat,
+          sess.args.in_core_id,
+          sess.args.in_node_id,
+          sess.args.in_use_flush,
+          sess.args.in_access_order);
+
+  point.in_block_num = sess.args.in_block_num;
+  point.in_stride_size = sess.args.in_stride_size;
+  point.in_ldst_type = sess.args.in_ldst_type;
+  point.in_flush_type = sess.args.in_flush_type;
+  point.out_status = -EINVAL;
+  sess.points = &point;
+  sess.num_points = 1;
+
+  ret = pch_run_session(&sess);
+  if (ret == 0 && point.out_status != 0) {
+      ret = (int)point.out_status;
+  }
+  if (ret != 0) {
+      return ret;
+  }
+
+  sess.args.out_latency_cycle_ld = point.out_latency_cycle_ld;
+  sess.args.out_latency_cycle_st = point.out_latency_cycle_st;
+  sess.args.out_total_cycle_ld = point.out_total_cycle_ld;
+  sess.args.out_total_cycle_st = point.out_total_cycle_st;
+  sess.args.out_total_ns_ld = point.out_total_ns_ld;
+  sess.args.out_total_ns_st = point.out_total_ns_st;
+  if (copy_to_user((void __user *)arg, &sess.args, sizeof(sess.args))) {
+      pr_err("copy_to_user failed.\n");
+      return -EFAULT;
+  }
+  return 0;
+}
+
+/*
+ * Results are copied back even when the run is interrupted, so the caller
+ * keeps the points finished before the stop (out_num_done).
+ */
+static long pch_ioctl_run_batch(unsigned long arg)
+{
+  struct pch_session sess = {};
+  pchasing_batch_t batch;
+  void __user *upoints;
+  size_t bytes;
+  uint64_t p;
+  int ret;
+
+  if (copy_from_user(&batch, (void __user *)arg, sizeof(batch))) {
+      pr_err("copy_from_user failed.\n");
+      return -EFAULT;
+  }
+  if (batch.in_num_points == 0 || batch.in_num_points > PCH_MAX_BATCH_POINTS) {
+      pr_err("%s: invalid number of points %llu.\n", __func__, batch.in_num_points);
       return -EINVAL;
   }
 
-  switch (cmd) {
-  case PCH_IOC_RUN:
-      if (copy_from_user(&karg, (void __user *)arg, sizeof(karg))) {
-          pr_err("copy_from_user failed.\n");
-          return -EFAULT;
-      }
+  upoints = u64_to_user_ptr(batch.in_points);
+  bytes = batch.in_num_points * sizeof(pchasing_point_t);
+  sess.args = batch.in_args;
+  sess.num_points = batch.in_num_points;
+  sess.sample_interval = batch.in_sample_interval;
+  sess.points = kvmalloc(bytes, GFP_KERNEL);
+  if (!sess.points) {
+      return -ENOMEM;
+  }
+  if (copy_from_user(sess.points, upoints, bytes)) {
+      pr_err("copy_from_user failed.\n");
+      kvfree(sess.points);
+      return -EFAULT;
+  }
+  for (p = 0; p < sess.num_points; p++) {
+      sess.points[p].out_status = -ECANCELED;
+  }
 
-      pr_info("%s: block_num=%llu, stride_size=%llu, repeat=%llu, core_id=%llu, node_id=%llu, flush=%llu\n, access_order=%llu\n", 
-              __func__,
-              karg.in_block_num,
-              karg.in_stride_size,
-              karg.in_repeat,
-              karg.in_core_id,
-              karg.in_node_id,
-              karg.in_use_flush,
-              karg.in_access_order);
+  pr_info("%s: points=%llu, repeat=%llu, core_id=%llu, node_id=%llu, flush=%llu, access_order=%llu, sample_interval=%llu\n",
+          __func__,
+          sess.num_points,
+          sess.args.in_repeat,
+          sess.args.in_core_id,
+          sess.args.in_node_id,
+          sess.args.in_use_flush,
+          sess.args.in_access_order,
+          sess.sample_interval);
+
+  ret = pch_run_session(&sess);
+
+  batch.out_num_done = sess.num_done;
+  if (copy_to_user(upoints, sess.points, bytes) ||
+      copy_to_user((void __user *)arg, &batch, sizeof(batch))) {
+      pr_err("copy_to_user failed.\n");
+      ret = ret ? ret : -EFAULT;
+  }
+  kvfree(sess.points);
+  return ret;
+}
 
-      if (pch_thread) {
-          pr_info("%s: Thread already exists, please stop it first or handle accordingly.\n", __func__);
-          kthread_stop(pch_thread);
-          pch_thread = NULL;
+/* start line shared by the kthreads of one PCH_IOC_RUN_MULTI session */
+struct pch_multi_ctx {
+  /* workers that have not reached the start line yet */
+  atomic_t pending;
+  /* set by a worker whose setup failed, the others then skip the run */
+  atomic_t abort;
+};
+
+/* one kthread of a PCH_IOC_RUN_MULTI session and its slice of the buffer */
+struct pch_worker {
+  struct pch_multi_ctx *ctx;
+  struct task_struct *task;
+  pchasing_args_t *args;
+  pchasing_point_t *point;
+  uint64_t core_id;
+  struct pch_buffer buf;
+  struct completion done;
+  int ret;
+};
+
+static int pointer_chasing_worker(void *data)
+{
+  struct pch_worker *w = (struct pch_worker *)data;
+  pchasing_point_t *point = w->point;
+  uint64_t block_num = point->in_block_num;
+  uint64_t repeat = w->args->in_repeat;
+  uint64_t *cindex, *timing_st, *timing_ld;
+  int ret = 0;
+
+  cindex = (uint64_t*)kvzalloc_node(block_num * sizeof(uint64_t), GFP_KERNEL,
+                                    cpu_to_node((int)w->core_id));
+  timing_st = (uint64_t*)kmalloc_array(repeat, sizeof(uint64_t), GFP_KERNEL);
+  timing_ld = (uint64_t*)kmalloc_array(repeat, sizeof(uint64_t), GFP_KERNEL);
+  if (!cindex || !timing_st || !timing_ld) {
+    ret = -ENOMEM;
+  }
+  if (ret == 0) {
+    ret = pch_touch(&w->buf, 0, block_num * point->in_stride_size);
+  }
+  if (ret == 0) {
+    ret = init_chasing_index(cindex, block_num, w->args->in_access_order);
+    if (ret > 0) {
+      ret = -EFAULT;
+    }
+  }
+  if (ret != 0) {
+    atomic_set(&w->ctx->abort, 1);
+  }
+
+  /* start line: every index is built before the first access is timed */
+  atomic_dec(&w->ctx->pending);
+  while (atomic_read(&w->ctx->pending) > 0) {
+    if (kthread_should_stop()) {
+      ret = -EINTR;
+      break;
+    }
+    cond_resched();
+    cpu_relax();
+  }
+
+  if (ret == 0 && atomic_read(&w->ctx->abort)) {
+    ret = -ECANCELED;
+  }
+  if (ret == 0) {
+    ret = pointer_chasing_point(w->args, point, NULL, cindex, &w->buf,
+                                timing_st, timing_ld);
+  }
+  point->out_status = ret;
+
+  kvfree(cindex);
+  kfree(timing_st);
+  kfree(timing_ld);
+  w->ret = ret;
+  complete(&w->done);
+  return ret;
+}
+
+/*
+ * Splits the buffer into one slice per core, starts a bound kthread per
+ * core and waits for all of them. Results are copied back even when the
+ * run is interrupted.
+ */
+static long pch_ioctl_run_multi(unsigned long arg)
+{
+  pchasing_multi_t *multi;
+  pchasing_args_t *args;
+  /* outlives the workers: every created one is reaped by kthread_stop() */
+  struct pch_multi_ctx ctx;
+  struct pch_worker *workers = NULL;
+  struct pch_buffer buf = {};
+  uint64_t num_cores, test_slice;
+  uint64_t c, d, created = 0;
+  int ret = 0;
+  int wait_ret = 0;
+
+  multi = kmalloc(sizeof(*multi), GFP_KERNEL);
+  if (!multi) {
+      return -ENOMEM;
+  }
+  if (copy_from_user(multi, (void __user *)arg, sizeof(*multi))) {
+      pr_err("copy_from_user failed.\n");
+      kfree(multi);
+      return -EFAULT;
+  }
+  args = &multi->in_args;
+  num_cores = multi->in_num_cores;
+
+  pr_info("%s: cores=%llu, block_num=%llu, stride_size=%llu, repeat=%llu, node_id=%llu, flush=%llu, access_order=%llu\n",
+          __func__,
+          num_cores,
+          args->in_block_num,
+          args->in_stride_size,
+          args->in_repeat,
+          args->in_node_id,
+          args->in_use_flush,
+          args->in_access_order);
+
+  if (num_cores == 0 || num_cores > PCH_MAX_CORES) {
+      pr_err("%s: invalid number of cores %llu.\n", __func__, num_cores);
+      ret = -EINVAL;
+      goto out_free;
+  }
+  for (c = 0; c < num_cores; c++) {
+      if (multi->in_core_ids[c] >= nr_cpu_ids || !cpu_online(multi->in_core_ids[c])) {
+          pr_err("%s: CPU %llu is not online.\n", __func__, multi->in_core_ids[c]);
+          ret = -EINVAL;
+          goto out_free;
+      }
+      for (d = 0; d < c; d++) {
+          if (multi->in_core_ids[d] == multi->in_core_ids[c]) {
+              pr_err("%s: CPU %llu is listed twice.\n", __func__, multi->in_core_ids[c]);
+              ret = -EINVAL;
+              goto out_free;
+          }
       }
+  }
 
-      init_completion(&pch_comp);
+  if (args->in_repeat < 2) {
+      pr_err("repeat must be at least 2.\n");
+      ret = -EINVAL;
+      goto out_free;
+  }
+  ret = pch_buffer_get(args, &buf);
+  if (ret != 0) {
+      goto out_free;
+  }
+  test_slice = round_down(buf.size / num_cores, PAGE_SIZE);
+  if (!pch_ldst_valid(args->in_ldst_type, args->in_stride_size)) {
+      pr_err("%s: ldst_type %llu is not supported with stride %llu.\n", __func__,
+             args->in_ldst_type, args->in_stride_size);
+      ret = -EINVAL;
+      goto out_free;
+  }
+  if (args->in_block_num == 0 || args->in_stride_size < sizeof(uint64_t) ||
+      args->in_block_num > PCH_MAX_BLOCKS ||
+      args->in_block_num * args->in_stride_size > test_slice) {
+      pr_err("%s: the point does not fit in a 0x%llx byte slice per core.\n", __func__, test_slice);
+      ret = -EINVAL;
+      goto out_free;
+  }
 
-      pch_thread = kthread_create(pointer_chasing_thread, (void *)&karg, "pch_thread");
-      if (IS_ERR(pch_thread)) {
+  workers = kcalloc(num_cores, sizeof(*workers), GFP_KERNEL);
+  if (!workers) {
+      ret = -ENOMEM;
+      goto out_free;
+  }
+  atomic_set(&ctx.pending, (int)num_cores);
+  atomic_set(&ctx.abort, 0);
+
+  for (c = 0; c < num_cores; c++) {
+      struct pch_worker *w = &workers[c];
+      pchasing_point_t *point = &multi->out_points[c];
+
+      memset(point, 0, sizeof(*point));
+      point->in_block_num = args->in_block_num;
+      point->in_stride_size = args->in_stride_size;
+      point->in_ldst_type = args->in_ldst_type;
+      point->in_flush_type = args->in_flush_type;
+      point->out_status = -ECANCELED;
+
+      w->ctx = &ctx;
+      w->args = args;
+      w->point = point;
+      w->core_id = multi->in_core_ids[c];
+      w->buf = buf;
+      w->buf.base = c * test_slice;
+      init_completion(&w->done);
+      w->task = kthread_create(pointer_chasing_worker, (void *)w, "pch_thread/%llu",
+                               multi->in_core_ids[c]);
+      if (IS_ERR(w->task)) {
           pr_err("kthread_create failed.\n");
-          pch_thread = NULL;
-          return PTR_ERR(pch_thread);
+          ret = PTR_ERR(w->task);
+          goto out_stop;
       }
+      /* the worker may exit before kthread_stop(), keep its task around */
+      get_task_struct(w->task);
+      kthread_bind(w->task, (int)multi->in_core_ids[c]);
+      created++;
+  }
 
-      kthread_bind(pch_thread, (int)karg.in_core_id);
-      wake_up_process(pch_thread);
-      // wait_for_completion(&pch_comp);
-      wait_ret = wait_for_completion_interruptible(&pch_comp);
+  for (c = 0; c < num_cores; c++) {
+      wake_up_process(workers[c].task);
+  }
+  for (c = 0; c < num_cores; c++) {
+      wait_ret = wait_for_completion_interruptible(&workers[c].done);
       if (wait_ret < 0) {
-          pr_info("%s: interrupted while waiting for pointer-chasing thread.\n", __func__);
+          pr_info("%s: interrupted while waiting for pointer-chasing threads.\n", __func__);
+          ret = wait_ret;
+          break;
       }
+  }
 
-      ret = kthread_stop(pch_thread);
-      pch_thread = NULL;
-      if (wait_ret < 0) {
-          return wait_ret;
-      }
-      if (ret == -EINTR) {
-          pr_info("%s: pointer_chasing_thread stopped by request.\n", __func__);
-          return -EINTR;
+out_stop:
+  /* never-woken workers exit from kthread_stop() without running */
+  for (c = 0; c < created; c++) {
+      kthread_stop(workers[c].task);
+      put_task_struct(workers[c].task);
+      /* -ECANCELED only marks the workers that skipped for another's error */
+      if (ret == 0 && workers[c].ret != 0 && workers[c].ret != -ECANCELED) {
+          ret = workers[c].ret;
       }
-      if (ret < 0) {
-          pr_err("%s: pointer_chasing_thread failed: %d\n", __func__, ret);
-          return ret;
-      }
-      pr_info("%s: pointer_chasing_thread finished.\n", __func__);
+  }
+  if (copy_to_user((void __user *)arg, multi, sizeof(*multi))) {
+      pr_err("copy_to_user failed.\n");
+      ret = ret ? ret : -EFAULT;
+  }
 
-      if (copy_to_user((void __user *)arg, &karg, sizeof(karg))) {
-          pr_err("copy_to_user failed.\n");
-          return -EFAULT;
-      }
+out_free:
+  pch_buffer_put(&buf);
+  kfree(workers);
+  kfree(multi);
+  return ret;
+}
 
-      break;
+static long pointer_chasing_ioctl(struct file *file, unsigned int cmd, unsigned long arg)
+{
+  long ret;
+
+  if (_IOC_TYPE(cmd) != PCH_IOC_MAGIC) {
+      pr_err("Invalid magic number.\n");
+      return -EINVAL;
+  }
+
+  switch (cmd) {
+  case PCH_IOC_RUN:
+  case PCH_IOC_RUN_BATCH:
+  case PCH_IOC_RUN_MULTI:
+      if (!mutex_trylock(&pch_run_lock)) {
+          pr_info("%s: another run is in progress.\n", __func__);
+          return -EBUSY;
+      }
+      if (cmd == PCH_IOC_RUN) {
+          ret = pch_ioctl_run(arg);
+      } else if (cmd == PCH_IOC_RUN_BATCH) {
+          ret = pch_ioctl_run_batch(arg);
+      } else {
+          ret = pch_ioctl_run_multi(arg);
+      }
+      mutex_unlock(&pch_run_lock);
+      return ret;
 
   case PCH_IOC_STOP:
+      /* waits for a run in progress, which a signal to its caller ends */
+      mutex_lock(&pch_run_lock);
       if (pch_thread) {
           pr_info("%s: stopping thread.\n", __func__);
           kthread_stop(pch_thread);
+          put_task_struct(pch_thread);
           pch_thread = NULL;
       } else {
           pr_info("%s: no thread running.\n", __func__);
       }
+      mutex_unlock(&pch_run_lock);
       break;
 
   default:
@@ -629,9 +1256,19 @@ static long pointer_chasing_ioctl(struct file *file, unsigned int cmd, unsigned
   return 0;
 }
 
+/* maps the timing ring, header page first; see PCH_RING_MAP_SIZE */
+static int pointer_chasing_mmap(struct file *file, struct vm_area_struct *vma)
+{
+  if (vma->vm_pgoff != 0 || vma->vm_end - vma->vm_start > PCH_RING_MAP_SIZE) {
+      return -EINVAL;
+  }
+  return remap_vmalloc_range(vma, pch_ring, 0);
+}
+
 static struct file_operations pointer_chasing_fops = {
     .owner          = THIS_MODULE,
     .unlocked_ioctl = pointer_chasing_ioctl,
+    .mmap           = pointer_chasing_mmap,
 };
 
 static dev_t pch_dev;
@@ -644,9 +1281,18 @@ static int __init pointer_chasing_init(void)
 
   pr_info("%s: pointer_chasing module loaded.\n", __func__);
 
+  pch_ring = vmalloc_user(PCH_RING_MAP_SIZE);
+  if (!pch_ring) {
+      pr_err("vmalloc_user failed.\n");
+      return -ENOMEM;
+  }
+  pch_ring->num_records = PCH_RING_RECORDS;
+  pch_records = (pchasing_record_t *)((uint8_t *)pch_ring + PCH_RING_HEADER_SIZE);
+
   ret = alloc_chrdev_region(&pch_dev, 0, 1, DEVICE_NAME);
   if (ret < 0) {
       pr_err("alloc_chrdev_region failed.\n");
+      vfree(pch_ring);
       return ret;
   }
 
@@ -657,6 +1303,7 @@ static int __init pointer_chasing_init(void)
   if (ret < 0) {
       pr_err("cdev_add failed.\n");
       unregister_chrdev_region(pch_dev, 1);
+      vfree(pch_ring);
       return ret;
   }
 
@@ -665,6 +1312,7 @@ static int __init pointer_chasing_init(void)
       pr_err("class_create failed.\n");
       cdev_del(&pch_cdev);
       unregister_chrdev_region(pch_dev, 1);
+      vfree(pch_ring);
       return PTR_ERR(pch_class);
   }
 
@@ -678,6 +1326,7 @@ static void __exit pointer_chasing_exit(void)
   if (pch_thread) {
       pr_info("%s: stopping pointer-chasing thread...\n", __func__);
       kthread_stop(pch_thread);
+      put_task_struct(pch_thread);
       pch_thread = NULL;
   }
 
@@ -686,6 +1335,7 @@ static void __exit pointer_chasing_exit(void)
 
   cdev_del(&pch_cdev);
   unregister_chrdev_region(pch_dev, 1);
+  vfree(pch_ring);
 
   pr_info("%s: pointer_chasing module unloaded.\n", __func__);
 }
@@ -0,0 +1,169 @@
+/*
+ *
+ * MIT License
+ *
+ * Copyright (c) 2025 Jangseon Park
+ * Affiliation: University of California San Diego CSE
+ * Email: jap036@ucsd.edu
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef CXL_PERF_APP_POINTER_CHASING_IOCTL_H
+#define CXL_PERF_APP_POINTER_CHASING_IOCTL_H
+
+// Interface of /dev/pointer_chasing, shared by the kernel module and
+// main_cache so both sides always agree on the layout.
+#ifdef __KERNEL__
+#include <linux/ioctl.h>
+#include <linux/types.h>
+#else
+#include <stdint.h>
+#include <sys/ioctl.h>
+#endif
+
+// in_buf_addr/in_buf_size name a buffer of the caller that the module pins
+// and chases instead of a physical window, so any node can be tested
+// without reserving memory at boot. With in_buf_addr 0 the module uses the
+// window at in_dimm_start_addr_phys (node 0) or in_cxl_start_addr_phys (the
+// CXL node), in_test_size bytes long.
+typedef struct pchasing_args {
+  uint64_t in_block_num;
+  uint64_t in_stride_size;
+  uint64_t in_repeat;
+  uint64_t in_core_id;
+  uint64_t in_node_id;
+  uint64_t in_use_flush;
+  uint64_t in_flush_type;
+  uint64_t in_access_order;
+  uint64_t in_dimm_start_addr_phys;
+  uint64_t in_cxl_start_addr_phys;
+  uint64_t in_test_size;
+  uint64_t in_snc_mode;
+  uint64_t in_socket_num;
+  uint64_t in_test_type;
+  uint64_t in_ldst_type;
+  uint64_t in_buf_addr;
+  uint64_t in_buf_size;
+  uint64_t out_latency_cycle_ld;
+  uint64_t out_latency_cycle_st;
+  uint64_t out_total_cycle_ld;
+  uint64_t out_total_cycle_st;
+  uint64_t out_total_ns_ld;
+  uint64_t out_total_ns_st;
+} pchasing_args_t;
+
+// One (stride, block_num, ldst, flush) point of a batch and its results.
+// out_status is 0 on success or a negative errno for a point that was
+// rejected or not reached.
+typedef struct pchasing_point {
+  uint64_t in_stride_size;
+  uint64_t in_block_num;
+  uint64_t in_ldst_type;
+  uint64_t in_flush_type;
+  int64_t out_status;
+  uint64_t out_latency_cycle_ld;
+  uint64_t out_latency_cycle_st;
+  uint64_t out_total_cycle_ld;
+  uint64_t out_total_cycle_st;
+  uint64_t out_total_ns_ld;
+  uint64_t out_total_ns_st;
+} pchasing_point_t;
+
+// Runs in_num_points points back-to-back in one kthread. in_args carries
+// the settings shared by all points; its block_num, stride_size,
+// flush_type and ldst_type fields and its outputs are ignored. in_points is
+// a user pointer to the pchasing_point_t array, which is written back with
+// the results. Points with the same block_num reuse the chasing index, so
+// sorting the array by block_num saves most of the setup. Besides the
+// per-repeat records, every in_sample_interval-th access is streamed to the
+// ring (0 disables access sampling).
+typedef struct pchasing_batch {
+  pchasing_args_t in_args;
+  uint64_t in_points;
+  uint64_t in_num_points;
+  uint64_t in_sample_interval;
+  uint64_t out_num_done;
+} pchasing_batch_t;
+
+// Timing record streamed by the kthread while a batch runs. point indexes
+// the batch, flags marks records of the warm-up repeat. A repeat record
+// carries the cycles of the whole pass over block_num blocks (or of the
+// flush pass for test_type 1), an access record those of one access.
+#define PCH_RECORD_REPEAT_ST 0
+#define PCH_RECORD_REPEAT_LD 1
+#define PCH_RECORD_ACCESS_ST 2
+#define PCH_RECORD_ACCESS_LD 3
+
+#define PCH_RECORD_WARMUP 0x1
+
+typedef struct pchasing_record {
+  uint32_t point;
+  uint16_t kind;
+  uint16_t flags;
+  uint64_t cycles;
+} pchasing_record_t;
+
+// Single-producer ring shared through mmap() of PCH_RING_MAP_SIZE bytes at
+// offset 0 of the device: this header in the first page, the records right
+// after it. head counts records written by the kthread and tail records
+// consumed by the reader; both only grow and index slot % num_records.
+// Records that find the ring full are dropped and counted. The counters
+// persist across sessions, so a reader starts by setting tail to head.
+typedef struct pchasing_ring {
+  uint64_t head;
+  uint64_t dropped;
+  uint64_t num_records;
+  uint64_t reserved[5];
+  uint64_t tail; // own cache line, written by the reader
+} pchasing_ring_t;
+
+#define PCH_RING_RECORDS (1ULL << 16)
+#define PCH_RING_HEADER_SIZE 4096ULL
+#define PCH_RING_MAP_SIZE                                                      \
+  (PCH_RING_HEADER_SIZE + PCH_RING_RECORDS * sizeof(pchasing_record_t))
+
+#define PCH_MAX_BATCH_POINTS 4096
+#define PCH_MAX_CORES 64
+
+// Runs the point described by in_args on in_num_cores cores at once, one
+// kthread per core, to measure latency under load from the other cores.
+// in_args.in_core_id is ignored. The test buffer is split into
+// in_num_cores disjoint slices, so block_num * stride_size must fit in one
+// slice. All kthreads build their index first and start chasing together.
+// out_points[i] holds the results of in_core_ids[i]. The ring has a single
+// producer, so nothing is streamed.
+typedef struct pchasing_multi {
+  pchasing_args_t in_args;
+  uint64_t in_core_ids[PCH_MAX_CORES];
+  uint64_t in_num_cores;
+  pchasing_point_t out_points[PCH_MAX_CORES];
+} pchasing_multi_t;
+
+// The run ioctls are serialized across all openers of the device; one
+// issued while another runs fails with EBUSY. PCH_IOC_STOP waits for a
+// running one to return, a run is interrupted by a signal to its caller.
+#define PCH_IOC_MAGIC 'p'
+#define PCH_IOC_RUN _IOWR(PCH_IOC_MAGIC, 1, pchasing_args_t)
+#define PCH_IOC_STOP _IO(PCH_IOC_MAGIC, 2)
+#define PCH_IOC_RUN_BATCH _IOWR(PCH_IOC_MAGIC, 3, pchasing_batch_t)
+#define PCH_IOC_RUN_MULTI _IOWR(PCH_IOC_MAGIC, 4, pchasing_multi_t)
+
+#endif // CXL_PERF_APP_POINTER_CHASING_IOCTL_H
@@ -0,0 +1,142 @@
+/*
+ *
+ * MIT License
+ *
+ * Copyright (c) 2025 Jangseon Park
+ * Affiliation: University of California San Diego CSE
+ * Email: jap036@ucsd.edu
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <chrono>
+#include <machine/x86/pointer_chasing/pointer_chasing_stream.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <sys/mman.h>
+
+PointerChasingStream::~PointerChasingStream() {
+  stop();
+  if (_ring != nullptr) {
+    munmap(_ring, PCH_RING_MAP_SIZE);
+  }
+}
+
+// Modules built before the ring existed have no mmap handler; the run then
+// goes on without distributions.
+bool PointerChasingStream::map(int fd) {
+  void *addr = mmap(nullptr, PCH_RING_MAP_SIZE, PROT_READ | PROT_WRITE,
+                    MAP_SHARED, fd, 0);
+  if (addr == MAP_FAILED) {
+    perror("mmap /dev/pointer_chasing");
+    return false;
+  }
+  _ring = static_cast<pchasing_ring_t *>(addr);
+  _records = reinterpret_cast<const pchasing_record_t *>(
+      static_cast<uint8_t *>(addr) + PCH_RING_HEADER_SIZE);
+  return true;
+}
+
+void PointerChasingStream::reset(const std::vector<pchasing_point_t> &points) {
+  _block_num.clear();
+  for (const auto &point : points) {
+    _block_num.push_back(point.in_block_num);
+  }
+  _distributions.assign(points.size(), PointerChasingDistribution());
+  _dropped = 0;
+}
+
+void PointerChasingStream::start(uint64_t measured_core) {
+  if (_ring == nullptr || _running) {
+    return;
+  }
+  uint64_t head = __atomic_load_n(&_ring->head, __ATOMIC_ACQUIRE);
+  __atomic_store_n(&_ring->tail, head, __ATOMIC_RELEASE);
+  _dropped_base = __atomic_load_n(&_ring->dropped, __ATOMIC_RELAXED);
+  _running = true;
+
+  // The module does not disable preemption, so a reader scheduled on the
+  // measured core would show up in its timings.
+  cpu_set_t cpuset;
+  CPU_ZERO(&cpuset);
+  sched_getaffinity(0, sizeof(cpuset), &cpuset);
+  if (measured_core < CPU_SETSIZE) {
+    CPU_CLR(measured_core, &cpuset);
+  }
+  if (CPU_COUNT(&cpuset) == 0) {
+    return;
+  }
+  _reader = std::thread([this] {
+    while (_running.load(std::memory_order_relaxed)) {
+      drain();
+      std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+  });
+  pthread_setaffinity_np(_reader.native_handle(), sizeof(cpuset), &cpuset);
+}
+
+void PointerChasingStream::stop() {
+  if (!_running) {
+    return;
+  }
+  _running = false;
+  if (_reader.joinable()) {
+    _reader.join();
+  }
+  drain();
+  _dropped =
+      __atomic_load_n(&_ring->dropped, __ATOMIC_RELAXED) - _dropped_base;
+}
+
+void PointerChasingStream::drain() {
+  uint64_t tail = _ring->tail;
+  uint64_t head = __atomic_load_n(&_ring->head, __ATOMIC_ACQUIRE);
+  for (; tail != head; tail++) {
+    consume(_records[tail % PCH_RING_RECORDS]);
+  }
+  __atomic_store_n(&_ring->tail, tail, __ATOMIC_RELEASE);
+}
+
+void PointerChasingStream::consume(const pchasing_record_t &record) {
+  if (record.point >= _distributions.size()) {
+    return;
+  }
+  PointerChasingDistribution &dist = _distributions[record.point];
+  uint64_t block_num = _block_num[record.point];
+  switch (record.kind) {
+  case PCH_RECORD_REPEAT_ST:
+    if (!(record.flags & PCH_RECORD_WARMUP)) {
+      dist.repeat_st.record(record.cycles / block_num);
+    }
+    break;
+  case PCH_RECORD_REPEAT_LD:
+    if (!(record.flags & PCH_RECORD_WARMUP)) {
+      dist.repeat_ld.record(record.cycles / block_num);
+    }
+    break;
+  case PCH_RECORD_ACCESS_ST:
+    dist.access_st.record(record.cycles);
+    break;
+  case PCH_RECORD_ACCESS_LD:
+    dist.access_ld.record(record.cycles);
+    break;
+  }
+}
@@ -0,0 +1,84 @@
+/*
+ *
+ * MIT License
+ *
+ * Copyright (c) 2025 Jangseon Park
+ * Affiliation: University of California San Diego CSE
+ * Email: jap036@ucsd.edu
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef CXL_PERF_APP_POINTER_CHASING_STREAM_H
+#define CXL_PERF_APP_POINTER_CHASING_STREAM_H
+#include <atomic>
+#include <core/data_structure.h>
+#include <cstdint>
+#include <thread>
+#include <utils/histogram.h>
+#include <vector>
+
+// Latency distributions of one point, in cycles. repeat_* hold the
+// per-block average of every measured repeat (the warm-up repeat is
+// skipped, as in out_latency_cycle_*), access_* the sampled single
+// accesses.
+struct PointerChasingDistribution {
+  Histogram repeat_st{"cycles"};
+  Histogram repeat_ld{"cycles"};
+  Histogram access_st{"cycles"};
+  Histogram access_ld{"cycles"};
+};
+
+// Consumer of the pointer_chasing timing ring. map() maps the ring of an
+// open /dev/pointer_chasing, start() skips whatever earlier sessions left
+// in it and drains it from a reader thread until stop(). The reader never
+// runs on the measured core; when no other CPU is allowed the ring is only
+// drained by stop(). The userspace engine has no ring and hands its
+// records to consume() directly.
+class PointerChasingStream {
+public:
+  PointerChasingStream() = default;
+  ~PointerChasingStream();
+
+  bool map(int fd);
+  void reset(const std::vector<pchasing_point_t> &points);
+  void start(uint64_t measured_core);
+  void stop();
+  void consume(const pchasing_record_t &record);
+
+  const PointerChasingDistribution &distribution(size_t point) const {
+    return _distributions[point];
+  }
+  uint64_t dropped() const { return _dropped; }
+
+private:
+  pchasing_ring_t *_ring = nullptr;
+  const pchasing_record_t *_records = nullptr;
+  std::thread _reader;
+  std::atomic<bool> _running{false};
+  std::vector<uint64_t> _block_num;
+  std::vector<PointerChasingDistribution> _distributions;
+  uint64_t _dropped = 0;
+  uint64_t _dropped_base = 0;
+
+  void drain();
+};
+
+#endif // CXL_PERF_APP_POINTER_CHASING_STREAM_H
@@ -0,0 +1,436 @@
+/*
+ *
+ * MIT License
+ *
+ * Copyright (c) 2025 Jangseon Park
+ * Affiliation: University of California San Diego CSE
+ * Email: jap036@ucsd.edu
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <machine/x86/ld_st/cycle_counter_x86.h>
+#include <machine/x86/pointer_chasing/pointer_chasing_stream.h>
+#include <machine/x86/pointer_chasing/pointer_chasing_user.h>
+#include <memory/mem_allocator.h>
+#include <numaif.h>
+#include <random>
+#include <sched.h>
+#include <sstream>
+#include <unistd.h>
+#include <utils/timer.h>
+
+#define PAGEMAP_PFN_MASK ((1ULL << 55) - 1)
+#define PAGEMAP_PRESENT (1ULL << 63)
+
+static inline __attribute__((always_inline)) void pch_mfence() {
+  asm volatile("mfence" ::: "memory");
+}
+
+static inline __attribute__((always_inline)) void pch_serialization() {
+  uint32_t eax = 0, ebx, ecx, edx;
+  asm volatile("cpuid"
+               : "=a"(eax), "=b"(ebx), "=c"(ecx), "=d"(edx)
+               : "0"(eax)
+               : "memory");
+}
+
+static inline __attribute__((always_inline)) void
+pch_flush(uint64_t flush_type, void *addr) {
+  if (flush_type == 0) {
+    asm volatile("clflush (%0)" ::"r"(addr) : "memory");
+  } else if (flush_type == 1) {
+    asm volatile("clflushopt (%0)" ::"r"(addr) : "memory");
+  } else if (flush_type == 2) {
+    asm volatile("clwb (%0)" ::"r"(addr) : "memory");
+  }
+}
+
+// Same instructions as the module per ldst_type: 0 plain mov, 1
+// non-temporal (movnti / movntdqa), 2 locked read-modify-write (xchg / lock
+// xadd of 0), each with its own fenced counter pair. movntdqa only streams
+// from write-combining memory; on the write-back buffers mapped here it is
+// an ordinary load, so type 1 loads time like type 0 loads.
+static inline __attribute__((always_inline)) uint64_t
+pch_timed_store(uint64_t ldst_type, uint64_t *addr, uint64_t val) {
+  uint64_t start;
+  if (ldst_type == 1) {
+    pch_mfence();
+    start = CycleCounter::start();
+    asm volatile("movnti %[val], (%[addr])\n\t" ::[val] "r"(val),
+                 [addr] "r"(addr)
+                 : "memory");
+    pch_mfence();
+    return CycleCounter::stop() - start;
+  }
+  if (ldst_type == 2) {
+    pch_mfence();
+    start = CycleCounter::start();
+    asm volatile("xchgq %[val], (%[addr])\n\t"
+                 : [val] "+r"(val)
+                 : [addr] "r"(addr)
+                 : "memory");
+    pch_mfence();
+    return CycleCounter::stop() - start;
+  }
+  pch_mfence();
+  start = CycleCounter::start();
+  asm volatile("movq %[val], (%[addr])\n\t" ::[val] "r"(val),
+               [addr] "r"(addr)
+               : "memory");
+  pch_mfence();
+  return CycleCounter::stop() - start;
+}
+
+static inline __attribute__((always_inline)) uint64_t
+pch_timed_load(uint64_t ldst_type, uint64_t *addr, uint64_t *val) {
+  uint64_t start;
+  if (ldst_type == 1) {
+    pch_mfence();
+    start = CycleCounter::start();
+    asm volatile("movntdqa (%[addr]), %%xmm0\n\t"
+                 "movq %%xmm0, %[val]\n\t"
+                 : [val] "=r"(*val)
+                 : [addr] "r"(addr)
+                 : "xmm0", "memory");
+    pch_mfence();
+    return CycleCounter::stop() - start;
+  }
+  if (ldst_type == 2) {
+    *val = 0;
+    pch_mfence();
+    start = CycleCounter::start();
+    asm volatile("lock xaddq %[val], (%[addr])\n\t"
+                 : [val] "+r"(*val)
+                 : [addr] "r"(addr)
+                 : "memory");
+    pch_mfence();
+    return CycleCounter::stop() - start;
+  }
+  pch_mfence();
+  start = CycleCounter::start();
+  asm volatile("movq (%[addr]), %[val]\n\t"
+               : [val] "=r"(*val)
+               : [addr] "r"(addr)
+               : "memory");
+  pch_mfence();
+  return CycleCounter::stop() - start;
+}
+
+PointerChasingUser::~PointerChasingUser() { release(); }
+
+// Same sequence as pointer_chasing_thread: one store pass and one load pass
+// of `repeat` rounds each over block_num blocks spaced stride_size apart,
+// the first round treated as warm-up.
+int PointerChasingUser::run(pchasing_args_t *args, uint32_t point) {
+  // movntdqa needs 16-byte aligned blocks
+  if (args->in_block_num == 0 || args->in_stride_size < sizeof(uint64_t) ||
+      args->in_repeat < 2 || args->in_ldst_type > 2 ||
+      (args->in_ldst_type == 1 && args->in_stride_size % 16 != 0)) {
+    std::cerr << "Invalid pointer chasing arguments" << std::endl;
+    return -EINVAL;
+  }
+
+  cpu_set_t previous, target;
+  sched_getaffinity(0, sizeof(previous), &previous);
+  CPU_ZERO(&target);
+  CPU_SET(args->in_core_id, &target);
+  if (sched_setaffinity(0, sizeof(target), &target) != 0) {
+    int err = errno;
+    perror("sched_setaffinity");
+    return -err;
+  }
+
+  int ret = reserve(args->in_block_num * args->in_stride_size,
+                    static_cast<int>(args->in_node_id));
+  std::vector<uint64_t> cindex(args->in_block_num, 0);
+  std::vector<uint64_t> timing_st(args->in_repeat, 0);
+  std::vector<uint64_t> timing_ld(args->in_repeat, 0);
+  uint64_t start_cycle_st = 0, end_cycle_st = 0;
+  uint64_t start_cycle_ld = 0, end_cycle_ld = 0;
+  double total_ns_st = 0, total_ns_ld = 0;
+  Timer timer;
+
+  if (ret == 0) {
+    ret = init_chasing_index(cindex, args->in_access_order);
+  }
+  if (ret == 0) {
+    pch_mfence();
+    start_cycle_st = CycleCounter::start();
+    timer.start();
+    ret = chase(true, *args, point, cindex, timing_st);
+    pch_mfence();
+    end_cycle_st = CycleCounter::stop();
+    total_ns_st = timer.elapsed();
+  }
+  if (ret == 0) {
+    pch_mfence();
+    start_cycle_ld = CycleCounter::start();
+    timer.start();
+    ret = chase(false, *args, point, cindex, timing_ld);
+    pch_mfence();
+    end_cycle_ld = CycleCounter::stop();
+    total_ns_ld = timer.elapsed();
+  }
+  sched_setaffinity(0, sizeof(previous), &previous);
+  if (ret != 0) {
+    return ret;
+  }
+
+  uint64_t sum_st = 0, sum_ld = 0;
+  for (uint64_t i = 1; i < args->in_repeat; i++) {
+    sum_st += timing_st[i];
+    sum_ld += timing_ld[i];
+  }
+  args->out_latency_cycle_st =
+      sum_st / args->in_block_num / (args->in_repeat - 1);
+  args->out_latency_cycle_ld =
+      sum_ld / args->in_block_num / (args->in_repeat - 1);
+  args->out_total_cycle_st = end_cycle_st - start_cycle_st;
+  args->out_total_cycle_ld = end_cycle_ld - start_cycle_ld;
+  args->out_total_ns_st = static_cast<uint64_t>(total_ns_st);
+  args->out_total_ns_ld = static_cast<uint64_t>(total_ns_ld);
+  return 0;
+}
+
+// Prefers hugetlb pages (1G, then 2M) so that the buffer is physically
+// contiguous at least within a page, as the module's physical window is.
+// Without hugetlb pages, root can still get a physically contiguous 4K
+// buffer; everyone else gets a plain 4K mapping on the node.
+int PointerChasingUser::reserve(uint64_t size, int node) {
+  if (_buf != nullptr && _buf_node == node && _buf_size >= size) {
+    return 0;
+  }
+  release();
+  size_t page_size = MemAllocator::get_page_size(PageSizeType::PAGE_4K);
+  _buf_size = (size + page_size - 1) / page_size * page_size;
+  _buf_node = node;
+  PageSizeType page_size_type = PageSizeType::PAGE_1G_HUGETLB;
+  if (_buf_size <= 2 * MEMUNIT::MiB) {
+    page_size_type = PageSizeType::PAGE_2M_HUGETLB;
+  }
+  try {
+    page_size_type = MemAllocator::reserve(
+        _buf_size, 1, node, MemAllocType::NON_CONTIGUOUS_HUGE_PAGE,
+        page_size_type);
+    _alloc_type = MemAllocType::NON_CONTIGUOUS_HUGE_PAGE;
+    if (page_size_type != PageSizeType::PAGE_1G_HUGETLB &&
+        page_size_type != PageSizeType::PAGE_2M_HUGETLB && geteuid() == 0) {
+      _alloc_type = MemAllocType::CONTIGUOUS_HUGE_PAGE;
+      _buf = static_cast<uint8_t *>(
+          MemAllocator::allocate(_buf_size, node, _alloc_type));
+    }
+    if (_buf == nullptr) {
+      _alloc_type = MemAllocType::NON_CONTIGUOUS_HUGE_PAGE;
+      _buf = static_cast<uint8_t *>(MemAllocator::allocate(
+          _buf_size, node, _alloc_type, page_size_type));
+    }
+  } catch (const std::exception &e) {
+    std::cerr << "Failed to allocate the chasing buffer: " << e.what()
+              << std::endl;
+    _buf = nullptr;
+  }
+  if (_buf == nullptr) {
+    MemAllocator::release();
+    return -ENOMEM;
+  }
+  memset(_buf, 0, _buf_size);
+  locate();
+  return 0;
+}
+
+void PointerChasingUser::release() {
+  if (_buf != nullptr) {
+    MemAllocator::deallocate(_buf, _buf_size, _alloc_type);
+    _buf = nullptr;
+  }
+  MemAllocator::release();
+}
+
+void PointerChasingUser::locate() {
+  _placement = PointerChasingPlacement();
+  _placement.size = _buf_size;
+  _placement.page_size = MemAllocator::describe_page_size(_buf);
+  _placement.contiguous_alloc =
+      _alloc_type == MemAllocType::CONTIGUOUS_HUGE_PAGE;
+  int node = -1;
+  if (get_mempolicy(&node, nullptr, 0, _buf, MPOL_F_NODE | MPOL_F_ADDR) ==
+      0) {
+    _placement.node = node;
+  }
+
+  int fd = open("/proc/self/pagemap", O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return;
+  }
+  uint64_t page_size = getpagesize();
+  uint64_t first_page = reinterpret_cast<uint64_t>(_buf) / page_size;
+  uint64_t pages = _buf_size / page_size;
+  std::vector<uint64_t> entries(std::min<uint64_t>(pages, 64 * 1024));
+  uint64_t prev_pfn = 0;
+  bool known = true;
+  for (uint64_t done = 0; done < pages && known;) {
+    uint64_t count = std::min<uint64_t>(entries.size(), pages - done);
+    ssize_t bytes = pread(fd, entries.data(), count * sizeof(uint64_t),
+                          (first_page + done) * sizeof(uint64_t));
+    if (bytes != static_cast<ssize_t>(count * sizeof(uint64_t))) {
+      known = false;
+      break;
+    }
+    for (uint64_t i = 0; i < count; i++) {
+      uint64_t pfn = entries[i] & PAGEMAP_PFN_MASK;
+      if (!(entries[i] & PAGEMAP_PRESENT) || pfn == 0) {
+        known = false; // PFNs are hidden from unprivileged users
+        break;
+      }
+      if (done + i == 0) {
+        _placement.phys_start = pfn * page_size;
+      } else if (pfn != prev_pfn + 1) {
+        _placement.phys_breaks++;
+      }
+      prev_pfn = pfn;
+    }
+    done += count;
+  }
+  _placement.phys_known = known;
+  close(fd);
+}
+
+std::string
+PointerChasingUser::describe(const PointerChasingPlacement &placement) {
+  std::stringstream out;
+  out << "Node " << placement.node << ", " << placement.page_size;
+  if (placement.contiguous_alloc) {
+    out << " (physically contiguous allocation)";
+  }
+  if (placement.phys_known) {
+    out << ", physical start 0x" << std::hex << placement.phys_start
+        << std::dec << ", " << placement.phys_breaks
+        << " physical discontinuities";
+  } else {
+    out << ", physical addresses unavailable (needs root)";
+  }
+  return out.str();
+}
+
+// A random order is a single cycle through every block (Sattolo's
+// algorithm), which is what the module builds with rdrand; a sequential one
+// walks the blocks in address order.
+int PointerChasingUser::init_chasing_index(std::vector<uint64_t> &cindex,
+                                           uint64_t access_order) const {
+  uint64_t csize = cindex.size();
+  std::vector<uint64_t> order(csize);
+  for (uint64_t i = 0; i < csize; i++) {
+    order[i] = i;
+  }
+  if (access_order == 0) {
+    std::mt19937_64 rng(std::random_device{}());
+    for (uint64_t i = csize - 1; i > 0; i--) {
+      if (stop_requested(i)) {
+        return -EINTR;
+      }
+      std::uniform_int_distribution<uint64_t> dist(0, i - 1);
+      std::swap(order[i], order[dist(rng)]);
+    }
+  }
+  for (uint64_t i = 0; i < csize; i++) {
+    cindex[order[i]] = order[(i + 1) % csize];
+  }
+  return 0;
+}
+
+int PointerChasingUser::chase(bool store, const pchasing_args_t &args,
+                              uint32_t point,
+                              const std::vector<uint64_t> &cindex,
+                              std::vector<uint64_t> &timing) const {
+  uint64_t sample_interval = _stream != nullptr ? _sample_interval : 0;
+  uint64_t sample_left = sample_interval;
+  pchasing_record_t record = {};
+  record.point = point;
+  for (uint64_t i = 0; i < args.in_repeat; i++) {
+    uint64_t curr_pos = 0, next_pos = 0;
+    if (*_stop_requested) {
+      return -EINTR;
+    }
+    for (uint64_t n = 0; n < args.in_block_num; n++) {
+      if (stop_requested(n)) {
+        return -EINTR;
+      }
+      uint64_t *curr_addr =
+          reinterpret_cast<uint64_t *>(_buf + curr_pos * args.in_stride_size);
+      uint64_t cycles;
+      if (store) {
+        next_pos = cindex[curr_pos];
+        cycles = pch_timed_store(args.in_ldst_type, curr_addr, next_pos);
+      } else {
+        cycles = pch_timed_load(args.in_ldst_type, curr_addr, &next_pos);
+      }
+      timing[i] += cycles;
+      if (sample_interval && --sample_left == 0) {
+        sample_left = sample_interval;
+        record.kind = store ? PCH_RECORD_ACCESS_ST : PCH_RECORD_ACCESS_LD;
+        record.flags = i == 0 ? PCH_RECORD_WARMUP : 0;
+        record.cycles = cycles;
+        _stream->consume(record);
+      }
+      curr_pos = next_pos;
+    }
+    if (args.in_use_flush) {
+      uint64_t flush_cycles = 0;
+      int ret = flush(args, cindex, &flush_cycles);
+      if (ret != 0) {
+        return ret;
+      }
+      if (args.in_test_type == 1) {
+        timing[i] = flush_cycles;
+      }
+    }
+    if (_stream != nullptr) {
+      record.kind = store ? PCH_RECORD_REPEAT_ST : PCH_RECORD_REPEAT_LD;
+      record.flags = i == 0 ? PCH_RECORD_WARMUP : 0;
+      record.cycles = timing[i];
+      _stream->consume(record);
+    }
+  }
+  return 0;
+}
+
+int PointerChasingUser::flush(const pchasing_args_t &args,
+                              const std::vector<uint64_t> &cindex,
+                              uint64_t *flush_cycles) const {
+  uint64_t curr_pos = 0;
+  pch_serialization();
+  uint64_t start = CycleCounter::start();
+  for (uint64_t n = 0; n < args.in_block_num; n++) {
+    if (stop_requested(n)) {
+      return -EINTR;
+    }
+    pch_flush(args.in_flush_type, _buf + curr_pos * args.in_stride_size);
+    curr_pos = cindex[curr_pos];
+  }
+  pch_serialization();
+  *flush_cycles = CycleCounter::stop() - start;
+  return 0;
+}
@@ -0,0 +1,101 @@
+/*
+ *
+ * MIT License
+ *
+ * Copyright (c) 2025 Jangseon Park
+ * Affiliation: University of California San Diego CSE
+ * Email: jap036@ucsd.edu
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef CXL_PERF_APP_POINTER_CHASING_USER_H
+#define CXL_PERF_APP_POINTER_CHASING_USER_H
+#include <core/data_structure.h>
+#include <csignal>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class PointerChasingStream;
+
+// Where the chased buffer ended up, as reported by /proc/self/pagemap.
+// Physical addresses are only visible to root; without them phys_known
+// stays false and only the NUMA node and page size are reported.
+struct PointerChasingPlacement {
+  uint64_t size = 0;
+  int node = -1;
+  std::string page_size;
+  bool contiguous_alloc = false;
+  bool phys_known = false;
+  uint64_t phys_start = 0;
+  uint64_t phys_breaks = 0;
+};
+
+// Userspace port of the pointer_chasing kernel module's heatmap run. Takes
+// the same pchasing_args_t and fills the same outputs, but chases a buffer
+// from MemAllocator on in_node_id instead of a raw physical window, so it
+// runs on any node and on hosts where the module cannot be loaded. The
+// calling thread is pinned to in_core_id for the run. The buffer is kept
+// between runs, so reserve() it for the largest point of a session once.
+// The kernel module engine borrows the same buffer through buffer().
+// With a stream set, run() emits the module's timing records for `point`.
+class PointerChasingUser {
+public:
+  explicit PointerChasingUser(const volatile sig_atomic_t *stop_requested)
+      : _stop_requested(stop_requested) {}
+  ~PointerChasingUser();
+
+  int reserve(uint64_t size, int node);
+  int run(pchasing_args_t *args, uint32_t point = 0);
+  void set_stream(PointerChasingStream *stream, uint64_t sample_interval) {
+    _stream = stream;
+    _sample_interval = sample_interval;
+  }
+  const PointerChasingPlacement &placement() const { return _placement; }
+  uint8_t *buffer() const { return _buf; }
+  uint64_t buffer_size() const { return _buf_size; }
+  static std::string describe(const PointerChasingPlacement &placement);
+
+private:
+  const volatile sig_atomic_t *_stop_requested;
+  uint8_t *_buf = nullptr;
+  uint64_t _buf_size = 0;
+  int _buf_node = -1;
+  MemAllocType _alloc_type = MemAllocType::NON_CONTIGUOUS_HUGE_PAGE;
+  PointerChasingPlacement _placement;
+  PointerChasingStream *_stream = nullptr;
+  uint64_t _sample_interval = 0;
+
+  bool stop_requested(uint64_t iter) const {
+    return (iter & 0x3ffULL) == 0 && *_stop_requested;
+  }
+  void release();
+  void locate();
+  int init_chasing_index(std::vector<uint64_t> &cindex,
+                         uint64_t access_order) const;
+  int chase(bool store, const pchasing_args_t &args, uint32_t point,
+            const std::vector<uint64_t> &cindex,
+            std::vector<uint64_t> &timing) const;
+  int flush(const pchasing_args_t &args, const std::vector<uint64_t> &cindex,
+            uint64_t *flush_cycles) const;
+};
+
+#endif // CXL_PERF_APP_POINTER_CHASING_USER_H
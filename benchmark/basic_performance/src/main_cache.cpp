@@ -26,7 +26,12 @@
 *
 */
 
+#include <algorithm>
 #include <fcntl.h>
+#include <fstream>
+#include <machine/x86/pointer_chasing/pointer_chasing_ioctl.h>
+#include <machine/x86/pointer_chasing/pointer_chasing_stream.h>
+#include <machine/x86/pointer_chasing/pointer_chasing_user.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <string.h>
@@ -35,14 +40,19 @@
 #include <unistd.h>
 #include <utils/input_parser.h>
 #include <utils/logger.h>
+#include <utils/result_writer.h>
 #include <signal.h>
 
-#define PCH_IOC_MAGIC 'p'
-#define PCH_IOC_RUN     _IOWR(PCH_IOC_MAGIC, 1, pchasing_args_t)
-#define PCH_IOC_STOP    _IO(PCH_IOC_MAGIC, 2)
-
 static int fd = -1;
 static volatile sig_atomic_t stop_requested = 0;
+static std::string start_time;
+static CacheEngine engine = CacheEngine::AUTO;
+static PointerChasingPlacement placement;
+static bool buffer_allocated = false;
+static PointerChasingStream stream;
+static std::vector<uint64_t> concurrent_cores;
+// Per-core results of a concurrent run, indexed [point][core]
+static std::vector<std::vector<pchasing_point_t>> concurrent_results;
 
 void signal_handler(int sig) {
   if (sig == SIGINT || sig == SIGTERM) {
@@ -59,17 +69,87 @@ void install_signal_handlers() {
   sigaction(SIGTERM, &sa, nullptr);
 }
 
-int prepare(pchasing_args_t &args, int argc, char *argv[]) {
+std::string get_engine_name() {
+  return engine == CacheEngine::USER_SPACE ? "userspace" : "kernel module";
+}
+
+// The module rejects a RUN_MULTI whose core list has offline or repeated
+// CPUs with EINVAL, which run_concurrent() could not tell apart from a
+// rejected point, so the list is checked once before any point runs.
+bool validate_cores(const std::vector<uint64_t> &cores) {
+  long num_cpus = sysconf(_SC_NPROCESSORS_CONF);
+  for (size_t i = 0; i < cores.size(); i++) {
+    if (cores[i] >= static_cast<uint64_t>(num_cpus)) {
+      std::cerr << "CPU " << cores[i] << " does not exist\n";
+      return false;
+    }
+    // cpu0 usually has no online file and cannot go offline
+    std::ifstream online("/sys/devices/system/cpu/cpu" +
+                         std::to_string(cores[i]) + "/online");
+    int state = 1;
+    if (online && online >> state && state == 0) {
+      std::cerr << "CPU " << cores[i] << " is offline\n";
+      return false;
+    }
+    if (std::find(cores.begin(), cores.begin() + i, cores[i]) !=
+        cores.begin() + i) {
+      std::cerr << "CPU " << cores[i] << " is listed twice\n";
+      return false;
+    }
+  }
+  return true;
+}
+
+int prepare(CacheTestInfo &info, int argc, char *argv[]) {
   InputParserForCache parser;
   std::tuple<std::string, std::string> files = parser.parse(argc, argv);
-  parser.parse(std::get<0>(files), &args);
+  parser.parse(std::get<0>(files), &info);
+  engine = info.engine;
+  if (!validate_cores(info.core_ids)) {
+    return -1;
+  }
+  if (info.core_ids.size() > 1) {
+    concurrent_cores = info.core_ids;
+  }
   Logger::get_instance().open(std::get<1>(files));
-  int fd = open("/dev/pointer_chasing", O_RDWR);
-  if (fd < 0) {
-    perror("open");
+  start_time = ResultWriter::get_timestamp();
+  if (engine == CacheEngine::USER_SPACE && !concurrent_cores.empty()) {
+    std::cerr << "Concurrent cores need the kernel module\n";
     return -1;
   }
+  if (engine != CacheEngine::USER_SPACE) {
+    fd = open("/dev/pointer_chasing", O_RDWR);
+    if (fd < 0) {
+      perror("open /dev/pointer_chasing");
+      if (engine == CacheEngine::KERNEL_MODULE) {
+        return -1;
+      }
+      if (!concurrent_cores.empty()) {
+        std::cerr << "Concurrent cores need the kernel module\n";
+        return -1;
+      }
+      std::cerr << "Falling back to the userspace pointer chasing engine\n";
+      engine = CacheEngine::USER_SPACE;
+    } else {
+      engine = CacheEngine::KERNEL_MODULE;
+      if (!stream.map(fd)) {
+        std::cerr << "Latency distributions are unavailable with this "
+                     "pointer_chasing module\n";
+      }
+    }
+  }
+  return 0;
+}
+
+std::string describe_cores(const std::vector<uint64_t> &cores) {
+  std::string out;
+  for (uint64_t core : cores) {
+    out += (out.empty() ? "" : ", ") + std::to_string(core);
+  }
+  return out;
+}
 
+void log_test_info(pchasing_args_t &args) {
   std::string access_order = (args.in_access_order == 0) ? "random" : "sequential";
   std::string test_type = (args.in_test_type == 0) ? "access latency" : "flush latency";
   std::string flush_type = "unkown";
@@ -85,7 +165,8 @@ int prepare(pchasing_args_t &args, int argc, char *argv[]) {
   if (args.in_ldst_type == 0) {
     ldst_type = "regular";
   } else if (args.in_ldst_type == 1) {
-    ldst_type = "non-temporal";
+    // movntdqa is a plain load on the write-back test buffer
+    ldst_type = "non-temporal store";
   } else if (args.in_ldst_type == 2) {
     ldst_type = "atomic";
   }
@@ -96,6 +177,7 @@ int prepare(pchasing_args_t &args, int argc, char *argv[]) {
 
   std::string test_info =
       "=============== Test Information ===============\n"
+      "Engine: " + get_engine_name() + "\n" +
       "Test Type: " + test_type + "\n" +
       "Number of Block: " +
       std::to_string(args.in_block_num) + "\n" +
@@ -108,16 +190,243 @@ int prepare(pchasing_args_t &args, int argc, char *argv[]) {
       "Test Size: " + std::to_string(args.in_test_size) + "\n" +
       "Repeat: " + std::to_string(args.in_repeat) + "\n" +
       "Core ID: " + std::to_string(args.in_core_id) + "\n" +
+      (concurrent_cores.empty()
+           ? ""
+           : "Concurrent Cores: " + describe_cores(concurrent_cores) + "\n") +
       "Node ID: " + std::to_string(args.in_node_id) + "\n" +
       "Use Flush: " + std::to_string(args.in_use_flush) + "\n" +
       "Flush Type: " + flush_type + "\n" +
       "Access Order: " + access_order + "\n" +
       "Load/Store Type: " + ldst_type + "\n" + "\n";
   Logger::get_instance().append(test_info);
-  return fd;
 }
 
-void wrap_up(int fd, pchasing_args_t &args) {
+// The module chases the physical window configured for node 0 (DIMM) or
+// the CXL node; any other node, or one without a window, gets a buffer
+// allocated here.
+bool uses_phys_window(const pchasing_args_t &args) {
+  if (args.in_node_id == 0) {
+    return args.in_dimm_start_addr_phys != 0;
+  }
+  if (args.in_node_id == args.in_snc_mode * args.in_socket_num) {
+    return args.in_cxl_start_addr_phys != 0;
+  }
+  return false;
+}
+
+// Allocates the buffer on node_id like the userspace engine does and hands
+// it to the module, which pins it for each ioctl.
+int reserve_buffer(PointerChasingUser &chaser, pchasing_args_t &args,
+                   uint64_t size) {
+  int ret = chaser.reserve(size, static_cast<int>(args.in_node_id));
+  if (ret != 0) {
+    return ret;
+  }
+  args.in_buf_addr = reinterpret_cast<uint64_t>(chaser.buffer());
+  args.in_buf_size = chaser.buffer_size();
+  placement = chaser.placement();
+  buffer_allocated = true;
+  return 0;
+}
+
+// Runs each point on all concurrent cores with one PCH_IOC_RUN_MULTI. A
+// point that does not fit in a per-core slice fails alone; any other error
+// ends the session.
+int run_concurrent(CacheTestInfo &info) {
+  std::vector<pchasing_point_t> &points = info.points;
+  pchasing_multi_t multi = {};
+  multi.in_num_cores = concurrent_cores.size();
+  std::copy(concurrent_cores.begin(), concurrent_cores.end(),
+            multi.in_core_ids);
+  for (auto &point : points) {
+    point.out_status = -ECANCELED;
+  }
+  for (size_t i = 0; i < points.size(); i++) {
+    multi.in_args = info.args;
+    multi.in_args.in_stride_size = points[i].in_stride_size;
+    multi.in_args.in_block_num = points[i].in_block_num;
+    multi.in_args.in_flush_type = points[i].in_flush_type;
+    multi.in_args.in_ldst_type = points[i].in_ldst_type;
+    for (auto &result : multi.out_points) {
+      result = {};
+      result.out_status = -ECANCELED;
+    }
+    int ret = ioctl(fd, PCH_IOC_RUN_MULTI, &multi);
+    int err = errno;
+    points[i].out_status = ret < 0 ? -err : 0;
+    if (ret == 0 || err != EINVAL) {
+      concurrent_results[i].assign(multi.out_points,
+                                   multi.out_points + multi.in_num_cores);
+    }
+    if (ret < 0 && err != EINVAL) {
+      errno = err;
+      return -1;
+    }
+  }
+  return 0;
+}
+
+// Runs all points in one session on the selected engine: one
+// PCH_IOC_RUN_BATCH for the kernel module, one buffer for the userspace
+// engine. The timing records of the session are collected into the
+// per-point distributions of `stream`. Points that finished carry
+// out_status 0 even when the session is interrupted. Like ioctl, returns
+// -1 and sets errno on failure.
+int run(CacheTestInfo &info) {
+  pchasing_args_t &args = info.args;
+  std::vector<pchasing_point_t> &points = info.points;
+  uint64_t max_size = 0;
+  for (auto &point : points) {
+    point.out_status = -ECANCELED;
+    max_size = std::max(max_size, point.in_block_num * point.in_stride_size);
+  }
+  PointerChasingUser chaser(&stop_requested);
+  stream.reset(points);
+  // sized before any early return, main() reports from it either way
+  concurrent_results.assign(points.size(), {});
+  if (engine == CacheEngine::KERNEL_MODULE) {
+    if (!uses_phys_window(args)) {
+      // One page-aligned slice per concurrent core
+      uint64_t page_size = getpagesize();
+      uint64_t slice = (max_size + page_size - 1) / page_size * page_size;
+      uint64_t slices = std::max<uint64_t>(concurrent_cores.size(), 1);
+      int ret = reserve_buffer(chaser, args, slice * slices);
+      if (ret != 0) {
+        errno = -ret;
+        return -1;
+      }
+    }
+    if (!concurrent_cores.empty()) {
+      return run_concurrent(info);
+    }
+    pchasing_batch_t batch = {};
+    batch.in_args = args;
+    batch.in_points = reinterpret_cast<uint64_t>(points.data());
+    batch.in_num_points = points.size();
+    batch.in_sample_interval = info.sample_interval;
+    stream.start(args.in_core_id);
+    int ret = ioctl(fd, PCH_IOC_RUN_BATCH, &batch);
+    int err = errno;
+    stream.stop();
+    errno = err;
+    return ret;
+  }
+
+  chaser.set_stream(&stream, info.sample_interval);
+  int ret = chaser.reserve(max_size, static_cast<int>(args.in_node_id));
+  for (size_t i = 0; ret == 0 && i < points.size(); i++) {
+    pchasing_args_t point_args = args;
+    point_args.in_stride_size = points[i].in_stride_size;
+    point_args.in_block_num = points[i].in_block_num;
+    point_args.in_flush_type = points[i].in_flush_type;
+    point_args.in_ldst_type = points[i].in_ldst_type;
+    ret = chaser.run(&point_args, static_cast<uint32_t>(i));
+    points[i].out_status = ret;
+    if (ret == -EINVAL) {
+      ret = 0; // rejected point, as the module skips it
+      continue;
+    }
+    points[i].out_latency_cycle_ld = point_args.out_latency_cycle_ld;
+    points[i].out_latency_cycle_st = point_args.out_latency_cycle_st;
+    points[i].out_total_cycle_ld = point_args.out_total_cycle_ld;
+    points[i].out_total_cycle_st = point_args.out_total_cycle_st;
+    points[i].out_total_ns_ld = point_args.out_total_ns_ld;
+    points[i].out_total_ns_st = point_args.out_total_ns_st;
+  }
+  placement = chaser.placement();
+  buffer_allocated = true;
+  if (ret != 0) {
+    errno = -ret;
+    return -1;
+  }
+  return 0;
+}
+
+void write_result(pchasing_args_t &args, double latency_ns_st,
+                  double latency_ns_ld,
+                  const PointerChasingDistribution &dist) {
+  JsonObject config;
+  config.add("engine", get_engine_name())
+      .add("test_type", args.in_test_type)
+      .add("block_num", args.in_block_num)
+      .add("stride_size", args.in_stride_size)
+      .add("repeat", args.in_repeat)
+      .add("core_id", args.in_core_id)
+      .add("node_id", args.in_node_id)
+      .add("use_flush", args.in_use_flush)
+      .add("flush_type", args.in_flush_type)
+      .add("access_order", args.in_access_order)
+      .add("dimm_start_addr_phys", args.in_dimm_start_addr_phys)
+      .add("cxl_start_addr_phys", args.in_cxl_start_addr_phys)
+      .add("test_size", args.in_test_size)
+      .add("snc_mode", args.in_snc_mode)
+      .add("socket_num", args.in_socket_num)
+      .add("ldst_type", args.in_ldst_type);
+  if (!concurrent_cores.empty()) {
+    config.add("concurrent_cores", concurrent_cores);
+  }
+
+  // test_type 0 reports store/load latency, 1 dirty/clean flush latency
+  JsonObject summary;
+  summary.add("latency_cycle_st", args.out_latency_cycle_st)
+      .add("latency_cycle_ld", args.out_latency_cycle_ld)
+      .add("latency_ns_st", latency_ns_st)
+      .add("latency_ns_ld", latency_ns_ld)
+      .add("total_cycle_st", args.out_total_cycle_st)
+      .add("total_cycle_ld", args.out_total_cycle_ld)
+      .add("total_ns_st", args.out_total_ns_st)
+      .add("total_ns_ld", args.out_total_ns_ld);
+
+  JsonObject record;
+  record.add("start_time", start_time)
+      .add("end_time", ResultWriter::get_timestamp())
+      .add("config", config)
+      .add("summary", summary);
+  JsonObject distributions;
+  bool has_distribution = false;
+  for (const auto &[name, hist] :
+       {std::pair{"repeat_st", &dist.repeat_st},
+        std::pair{"repeat_ld", &dist.repeat_ld},
+        std::pair{"access_st", &dist.access_st},
+        std::pair{"access_ld", &dist.access_ld}}) {
+    if (hist->count() != 0) {
+      distributions.add(name, hist->to_json());
+      has_distribution = true;
+    }
+  }
+  if (has_distribution) {
+    record.add("distributions", distributions);
+  }
+  if (buffer_allocated) {
+    JsonObject buffer;
+    buffer.add("size", placement.size)
+        .add("node", placement.node)
+        .add("page_size", placement.page_size)
+        .add("contiguous_alloc", placement.contiguous_alloc);
+    if (placement.phys_known) {
+      buffer.add("phys_start", placement.phys_start)
+          .add("phys_breaks", placement.phys_breaks);
+    }
+    record.add("placement", buffer);
+  }
+  ResultWriter writer(Logger::get_instance().get_directory());
+  writer.write("cache_analysis", record);
+}
+
+std::string describe_distribution(const std::string &label,
+                                  const Histogram &hist,
+                                  const std::string &what) {
+  if (hist.count() == 0) {
+    return "";
+  }
+  return label + ": p50 " + std::to_string(hist.percentile(50)) + ", p90 " +
+         std::to_string(hist.percentile(90)) + ", p99 " +
+         std::to_string(hist.percentile(99)) + ", max " +
+         std::to_string(hist.max()) + " cycles (" +
+         std::to_string(hist.count()) + " " + what + ")\n";
+}
+
+void report(pchasing_args_t &args, const PointerChasingDistribution &dist) {
   double ns_per_cycle_st =
       (double)args.out_total_ns_st / args.out_total_cycle_st;
   double ns_per_cycle_ld =
@@ -146,42 +455,117 @@ void wrap_up(int fd, pchasing_args_t &args) {
   }
   
   Logger::get_instance().append(log);
+
+  std::string st = args.in_test_type == 0 ? "Store" : "Dirty Flush";
+  std::string ld = args.in_test_type == 0 ? "Load" : "Clean Flush";
+  std::string distribution =
+      describe_distribution(st + " Latency per Repeat", dist.repeat_st,
+                            "repeats") +
+      describe_distribution(ld + " Latency per Repeat", dist.repeat_ld,
+                            "repeats") +
+      describe_distribution("Sampled Store Access", dist.access_st,
+                            "samples") +
+      describe_distribution("Sampled Load Access", dist.access_ld, "samples");
+  if (!distribution.empty()) {
+    Logger::get_instance().append(
+        "=============== Latency Distribution ===============\n" +
+        distribution + "\n");
+  }
+  write_result(args, out_latency_ns_st, out_latency_ns_ld, dist);
+}
+
+// Logs and records one finished point; failed points are only reported on
+// stderr.
+void report_point(pchasing_args_t args, const pchasing_point_t &point,
+                  const PointerChasingDistribution &dist) {
+  if (point.out_status != 0) {
+    if (point.out_status != -ECANCELED) {
+      std::cerr << "Point stride " << point.in_stride_size << " block "
+                << point.in_block_num << " failed: "
+                << strerror(static_cast<int>(-point.out_status))
+                << std::endl;
+    }
+    return;
+  }
+  args.in_stride_size = point.in_stride_size;
+  args.in_block_num = point.in_block_num;
+  args.in_flush_type = point.in_flush_type;
+  args.in_ldst_type = point.in_ldst_type;
+  args.out_latency_cycle_ld = point.out_latency_cycle_ld;
+  args.out_latency_cycle_st = point.out_latency_cycle_st;
+  args.out_total_cycle_ld = point.out_total_cycle_ld;
+  args.out_total_cycle_st = point.out_total_cycle_st;
+  args.out_total_ns_ld = point.out_total_ns_ld;
+  args.out_total_ns_st = point.out_total_ns_st;
+  log_test_info(args);
+  report(args, dist);
+}
+
+void wrap_up() {
   Logger::get_instance().close();
-  close(fd);
+  if (fd >= 0) {
+    close(fd);
+  }
+  fd = -1;
 }
 
 int main(int argc, char *argv[]) {
   install_signal_handlers();
 
-  pchasing_args_t args;
-  memset(&args, 0, sizeof(args));
-  fd = prepare(args, argc, argv);
-  if (fd < 0) {
+  CacheTestInfo info;
+  if (prepare(info, argc, argv) < 0) {
     return 1;
   }
-
-  uint64_t region_skip = args.in_block_num * args.in_stride_size;
-  if (region_skip >= args.in_test_size) {
-    close(fd);
-    fd = -1;
+  pchasing_args_t &args = info.args;
+  const std::vector<pchasing_point_t> &points = info.points;
+  if (points.empty()) {
+    std::cerr << "No point fits in the test size" << std::endl;
+    wrap_up();
     return -1;
   }
 
-  int ret = ioctl(fd, PCH_IOC_RUN, &args);
+  int ret = run(info);
+  int err = errno;
+  if (buffer_allocated) {
+    Logger::get_instance().append("Buffer Placement: " +
+                                  PointerChasingUser::describe(placement) +
+                                  "\n");
+  }
+  if (stream.dropped() != 0) {
+    Logger::get_instance().append(
+        "Timing Records Dropped: " + std::to_string(stream.dropped()) +
+        " (the reader fell behind, raise sample_interval)\n");
+  }
+  for (size_t i = 0; i < points.size(); i++) {
+    if (concurrent_cores.empty()) {
+      report_point(args, points[i], stream.distribution(i));
+      continue;
+    }
+    if (concurrent_results[i].empty()) {
+      report_point(args, points[i], PointerChasingDistribution());
+      continue;
+    }
+    for (size_t c = 0; c < concurrent_results[i].size(); c++) {
+      args.in_core_id = concurrent_cores[c];
+      report_point(args, concurrent_results[i][c],
+                   PointerChasingDistribution());
+    }
+  }
+  wrap_up();
+
   if (ret < 0) {
-    if (stop_requested && errno == EINTR) {
+    if (stop_requested && err == EINTR) {
       fprintf(stderr, "Interrupted, stopping the current cache run.\n");
-      close(fd);
-      fd = -1;
       return 130;
     }
-    perror("ioctl PCH_IOC_RUN");
-    close(fd);
-    fd = -1;
+    errno = err;
+    if (!concurrent_cores.empty()) {
+      perror("ioctl PCH_IOC_RUN_MULTI");
+    } else {
+      perror(engine == CacheEngine::KERNEL_MODULE ? "ioctl PCH_IOC_RUN_BATCH"
+                                                  : "pointer chasing");
+    }
     return 1;
   }
-  wrap_up(fd, args);
-  fd = -1;
-
   return 0;
 }
@@ -0,0 +1,116 @@
+/*
+ *
+ * MIT License
+ *
+ * Copyright (c) 2025 Jangseon Park
+ * Affiliation: University of California San Diego CSE
+ * Email: jap036@ucsd.edu
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <iostream>
+#include <memory/huge_page_arena.h>
+#include <memory/huge_page_handler.h>
+#include <numa.h>
+#include <numaif.h>
+#include <stdexcept>
+#include <sys/mman.h>
+
+HugePageArena::HugePageArena(size_t page_size, int numa_id)
+    : _page_size(page_size), _numa_id(numa_id), _base(nullptr), _size(0),
+      _added_pages(0), _offset(0) {}
+
+HugePageArena::~HugePageArena() { release(); }
+
+size_t HugePageArena::align_up(size_t size) const {
+  return (size + _page_size - 1) & ~(_page_size - 1);
+}
+
+bool HugePageArena::reserve(size_t slice_size, uint32_t num_slices) {
+  size_t size = align_up(slice_size) * num_slices;
+  size_t num_pages = size / _page_size;
+  if (!HugePageHandler::reserve_numa_hugepages(_page_size, num_pages, _numa_id,
+                                               &_added_pages)) {
+    HugePageHandler::release_numa_hugepages(_page_size, _added_pages,
+                                            _numa_id);
+    _added_pages = 0;
+    return false;
+  }
+
+  int lg = __builtin_ctzl(_page_size);
+  void *addr =
+      mmap(nullptr, size, PROT_READ | PROT_WRITE,
+           MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | (lg << MAP_HUGE_SHIFT),
+           -1, 0);
+  if (addr == MAP_FAILED) {
+    perror("Failed to map hugepage arena");
+    HugePageHandler::release_numa_hugepages(_page_size, _added_pages,
+                                            _numa_id);
+    _added_pages = 0;
+    return false;
+  }
+
+  // Pages are not touched here: each worker faults in its own slice from
+  // its own core, so the pages are zeroed in parallel.
+  unsigned long nodemask = (1UL << _numa_id);
+  if (mbind(addr, size, MPOL_BIND, &nodemask, sizeof(nodemask) * 8, 0) != 0) {
+    perror("Failed to bind hugepage arena to NUMA node");
+    munmap(addr, size);
+    HugePageHandler::release_numa_hugepages(_page_size, _added_pages,
+                                            _numa_id);
+    _added_pages = 0;
+    return false;
+  }
+
+  _base = static_cast<uint8_t *>(addr);
+  _size = size;
+  _offset = 0;
+  std::cout << "Reserved " << num_pages << " HugePages of "
+            << _page_size / 1024 << "kB on NUMA node " << _numa_id
+            << " for " << num_slices << " workers" << std::endl;
+  return true;
+}
+
+void *HugePageArena::acquire(size_t size) {
+  size = align_up(size);
+  size_t offset = _offset.fetch_add(size);
+  if (_base == nullptr || offset + size > _size) {
+    return nullptr;
+  }
+  return _base + offset;
+}
+
+void HugePageArena::release() {
+  if (_base != nullptr) {
+    if (munmap(_base, _size) != 0) {
+      perror("Failed to unmap hugepage arena");
+    }
+    _base = nullptr;
+    _size = 0;
+  }
+  HugePageHandler::release_numa_hugepages(_page_size, _added_pages, _numa_id);
+  _added_pages = 0;
+}
+
+bool HugePageArena::owns(const void *addr) const {
+  auto *ptr = static_cast<const uint8_t *>(addr);
+  return _base != nullptr && ptr >= _base && ptr < _base + _size;
+}
@@ -0,0 +1,62 @@
+/*
+ *
+ * MIT License
+ *
+ * Copyright (c) 2025 Jangseon Park
+ * Affiliation: University of California San Diego CSE
+ * Email: jap036@ucsd.edu
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef CXL_PERF_APP_DT_HUGE_PAGE_ARENA_H
+#define CXL_PERF_APP_DT_HUGE_PAGE_ARENA_H
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// One hugetlb mapping per NUMA node and page size, reserved and mapped once
+// per run and handed out to the workers as page-aligned slices.
+class HugePageArena {
+public:
+  HugePageArena(size_t page_size, int numa_id);
+  ~HugePageArena();
+  HugePageArena(const HugePageArena &) = delete;
+  HugePageArena &operator=(const HugePageArena &) = delete;
+
+  bool reserve(size_t slice_size, uint32_t num_slices);
+  void *acquire(size_t size);
+  void release();
+  bool owns(const void *addr) const;
+  size_t get_page_size() const { return _page_size; }
+  int get_numa_id() const { return _numa_id; }
+
+private:
+  size_t _page_size;
+  int _numa_id;
+  uint8_t *_base;
+  size_t _size;
+  size_t _added_pages;
+  std::atomic<size_t> _offset;
+
+  size_t align_up(size_t size) const;
+};
+
+#endif // CXL_PERF_APP_DT_HUGE_PAGE_ARENA_H
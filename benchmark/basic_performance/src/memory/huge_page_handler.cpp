@@ -26,164 +26,100 @@
  *
  */
 
-#include <cmath>
-#include <cstring>
-#include <fcntl.h>
 #include <fstream>
 #include <iostream>
 #include <memory/huge_page_handler.h>
-#include <numa.h>
-#include <numaif.h>
 #include <stdexcept>
 #include <string>
-#include <sys/mman.h>
-#include <sys/mount.h>
 #include <sys/stat.h>
-#include <unistd.h>
 
-size_t HugePageHandler::get_hugepage_size() {
-  std::ifstream meminfo("/proc/meminfo");
-  std::string line;
+std::string
+HugePageHandler::get_numa_hugepages_path(size_t page_size, int numa_node,
+                                         const std::string &entry) {
+  return "/sys/devices/system/node/node" + std::to_string(numa_node) +
+         "/hugepages/hugepages-" + std::to_string(page_size / 1024) + "kB/" +
+         entry;
+}
 
-  while (std::getline(meminfo, line)) {
-    if (line.find("Hugepagesize") != std::string::npos) {
-      size_t size_kb;
-      sscanf(line.c_str(), "Hugepagesize: %zu kB", &size_kb);
-      return size_kb * 1024; // KiB to Bytes
-    }
+size_t HugePageHandler::read_numa_hugepages(size_t page_size, int numa_node,
+                                            const std::string &entry) {
+  std::ifstream file(get_numa_hugepages_path(page_size, numa_node, entry));
+  size_t value = 0;
+  if (!(file >> value)) {
+    return 0;
   }
-  throw std::runtime_error(
-      "Failed to determine HugePage size from /proc/meminfo");
+  return value;
 }
 
-void HugePageHandler::setup_numa_hugepages(size_t num_pages, int numa_node) {
-  std::string numa_hugepages_path = "/sys/devices/system/node/node" +
-                                    std::to_string(numa_node) +
-                                    "/hugepages/hugepages-2048kB/nr_hugepages";
-  std::ofstream numa_hugepages_file(numa_hugepages_path);
-  if (!numa_hugepages_file.is_open()) {
-    throw std::runtime_error("Failed to open NUMA hugepages file for node: " +
-                             std::to_string(numa_node));
-  }
-  numa_hugepages_file << num_pages;
-  std::cout << "Set " << num_pages << " HugePages for NUMA node " << numa_node
-            << "." << std::endl;
+bool HugePageHandler::is_hugepage_size_supported(size_t page_size) {
+  return directory_exists("/sys/kernel/mm/hugepages/hugepages-" +
+                          std::to_string(page_size / 1024) + "kB");
 }
 
-bool HugePageHandler::directory_exists(const std::string &path) {
-  struct stat info;
-  return (stat(path.c_str(), &info) == 0 && S_ISDIR(info.st_mode));
+size_t HugePageHandler::get_free_numa_hugepages(size_t page_size,
+                                                int numa_node) {
+  return read_numa_hugepages(page_size, numa_node, "free_hugepages");
 }
 
-void HugePageHandler::mount_hugetlbfs(const std::string &mount_path) {
-  if (directory_exists(mount_path)) {
-    std::cout << "Directory already exists: " << mount_path << std::endl;
-  } else {
-    if (mkdir(mount_path.c_str(), 0755) != 0) {
-      perror("Failed to create mount directory");
-      throw std::runtime_error("Failed to create mount directory: " +
-                               mount_path);
-    }
-    std::cout << "Created mount directory: " << mount_path << std::endl;
+// Grows the node's pool by the missing pages only, so pages already reserved
+// by the administrator or by other jobs are left untouched.
+bool HugePageHandler::reserve_numa_hugepages(size_t page_size,
+                                             size_t num_pages, int numa_node,
+                                             size_t *added_pages) {
+  if (added_pages != nullptr) {
+    *added_pages = 0;
   }
-
-  if (mount("none", mount_path.c_str(), "hugetlbfs", 0, nullptr) != 0) {
-    perror("Failed to mount hugetlbfs");
-    throw std::runtime_error("Failed to mount hugetlbfs at: " + mount_path);
+  size_t free_pages = get_free_numa_hugepages(page_size, numa_node);
+  if (free_pages >= num_pages) {
+    return true;
   }
-
-  std::cout << "Mounted hugetlbfs at: " << mount_path << std::endl;
-}
-
-void HugePageHandler::bind_to_numa_node(void *addr, size_t size, int numa_id) {
-  if (numa_available() == -1) {
-    throw std::runtime_error("NUMA is not available on this system");
+  size_t nr_pages = read_numa_hugepages(page_size, numa_node, "nr_hugepages");
+  try {
+    setup_numa_hugepages(page_size, nr_pages + num_pages - free_pages,
+                         numa_node);
+  } catch (const std::exception &e) {
+    std::cerr << e.what() << std::endl;
+    return false;
   }
-
-  unsigned long nodemask = (1UL << numa_id);
-  int mode = MPOL_BIND;
-
-  if (mbind(addr, size, mode, &nodemask, sizeof(nodemask) * 8, 0) != 0) {
-    perror("Failed to bind memory to NUMA node");
-    throw std::runtime_error("NUMA binding failed");
+  // The kernel may only manage part of the increase; report what it gave.
+  size_t new_nr_pages =
+      read_numa_hugepages(page_size, numa_node, "nr_hugepages");
+  if (added_pages != nullptr && new_nr_pages > nr_pages) {
+    *added_pages = new_nr_pages - nr_pages;
   }
-
-  std::cout << "Memory successfully bound to NUMA node: " << numa_id
-            << std::endl;
+  return get_free_numa_hugepages(page_size, numa_node) >= num_pages;
 }
 
-void *HugePageHandler::allocate_huge_page(size_t size, int numa_node) {
-  const char *mount_path = "/mnt/huge";
-  size_t hugepage_size = get_hugepage_size();
-
-  size_t num_pages = std::ceil(static_cast<double>(size) / hugepage_size);
-  std::cout << "Calculated HugePages needed: " << num_pages << " pages"
-            << std::endl;
-
-  setup_numa_hugepages(num_pages, numa_node);
-  mount_hugetlbfs(mount_path);
-
-  const char *template_path = "/mnt/huge/hugepagefileXXXXXX";
-  char unique_path[256];
-  strcpy(unique_path, template_path);
-
-  int fd = mkstemp(unique_path);
-  if (fd < 0) {
-    perror("Failed to create temporary hugepage file");
-    return nullptr;
+void HugePageHandler::release_numa_hugepages(size_t page_size,
+                                             size_t num_pages, int numa_node) {
+  if (num_pages == 0) {
+    return;
   }
-
-  if (ftruncate(fd, size) < 0) {
-    perror("Failed to set file size");
-    close(fd);
-    return nullptr;
+  size_t nr_pages = read_numa_hugepages(page_size, numa_node, "nr_hugepages");
+  try {
+    setup_numa_hugepages(page_size,
+                         nr_pages > num_pages ? nr_pages - num_pages : 0,
+                         numa_node);
+  } catch (const std::exception &e) {
+    std::cerr << e.what() << std::endl;
   }
-
-  void *addr = mmap(nullptr, size, PROT_READ | PROT_WRITE,
-                    MAP_SHARED | MAP_HUGETLB, fd, 0);
-  if (addr == MAP_FAILED) {
-    perror("Failed to map hugepages");
-    std::cerr << "Requested size: " << size << " bytes" << std::endl;
-    std::cerr << "HugePage size: " << hugepage_size << " bytes" << std::endl;
-    std::cerr << "Requested pages: " << num_pages << std::endl;
-    return nullptr;
-  }
-
-  bind_to_numa_node(addr, size, numa_node);
-
-  std::cout << "HugePages allocated at address: " << addr << ", size: " << size
-            << " bytes" << std::endl;
-
-  close(fd);
-  unlink(unique_path);
-
-  return addr;
 }
 
-void HugePageHandler::deallocate_huge_page(void *addr, size_t size) {
-  if (munmap(addr, size) < 0) {
-    perror("Failed to unmap hugepages");
-  } else {
-    std::cout << "HugePages unmapped from address: " << addr
-              << ", size: " << size << " bytes" << std::endl;
+void HugePageHandler::setup_numa_hugepages(size_t page_size, size_t num_pages,
+                                           int numa_node) {
+  std::string numa_hugepages_path =
+      get_numa_hugepages_path(page_size, numa_node, "nr_hugepages");
+  std::ofstream numa_hugepages_file(numa_hugepages_path);
+  if (!numa_hugepages_file.is_open()) {
+    throw std::runtime_error("Failed to open NUMA hugepages file for node: " +
+                             std::to_string(numa_node));
   }
-  cleanup_hugepage_resources();
+  numa_hugepages_file << num_pages;
+  std::cout << "Set " << num_pages << " HugePages of " << page_size / 1024
+            << "kB for NUMA node " << numa_node << "." << std::endl;
 }
 
-void HugePageHandler::cleanup_hugepage_resources() {
-  std::string mount_path = "/mnt/huge";
+bool HugePageHandler::directory_exists(const std::string &path) {
   struct stat info;
-  if (stat(mount_path.c_str(), &info) == 0 && S_ISDIR(info.st_mode)) {
-    if (umount(mount_path.c_str()) == 0) {
-      std::cout << "Successfully unmounted hugetlbfs from: " << mount_path
-                << std::endl;
-      if (rmdir(mount_path.c_str()) == 0) {
-        std::cout << "Removed directory: " << mount_path << std::endl;
-      } else {
-        perror("Failed to remove directory");
-      }
-    } else {
-      perror("Failed to unmount hugetlbfs");
-    }
-  }
+  return (stat(path.c_str(), &info) == 0 && S_ISDIR(info.st_mode));
 }
@@ -34,18 +34,25 @@
 #include <iostream>
 #include <string>
 
+// Manages the per-node hugetlb pools exposed under /sys/devices/system/node.
 class HugePageHandler {
 public:
-  static void *allocate_huge_page(size_t size, int numa_id);
-  static void deallocate_huge_page(void *addr, size_t size);
+  static bool is_hugepage_size_supported(size_t page_size);
+  static size_t get_free_numa_hugepages(size_t page_size, int numa_node);
+  static bool reserve_numa_hugepages(size_t page_size, size_t num_pages,
+                                     int numa_node,
+                                     size_t *added_pages = nullptr);
+  static void release_numa_hugepages(size_t page_size, size_t num_pages,
+                                     int numa_node);
 
 private:
-  static void setup_numa_hugepages(size_t num_pages, int numa_node);
-  static void mount_hugetlbfs(const std::string &mount_path);
-  static size_t get_hugepage_size();
-  static void bind_to_numa_node(void *addr, size_t size, int numa_id);
+  static std::string get_numa_hugepages_path(size_t page_size, int numa_node,
+                                             const std::string &entry);
+  static size_t read_numa_hugepages(size_t page_size, int numa_node,
+                                    const std::string &entry);
+  static void setup_numa_hugepages(size_t page_size, size_t num_pages,
+                                   int numa_node);
   static bool directory_exists(const std::string &path);
-  static void cleanup_hugepage_resources();
 };
 
 #endif // CXL_PERF_APP_DT_HUGE_PAGE_HANDLER_H
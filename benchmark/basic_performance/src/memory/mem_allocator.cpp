@@ -27,41 +27,230 @@
  */
 
 #include <iostream>
+#include <memory/huge_page_arena.h>
 #include <memory/huge_page_handler.h>
 #include <memory/mem_allocator.h>
 #include <memory/mmap_alloc.h>
 #include <memory/phys_cont_mem.h>
+#include <mutex>
+#include <stdexcept>
 #include <sys/mman.h>
+#include <unordered_map>
 
 PhysContMem *memory_manager = nullptr;
 MmapAlloc *mmap_manager = nullptr;
+HugePageArena *hugepage_arena = nullptr;
 
-void *MemAllocator::allocate(size_t size, int numa_id,
-                             MemAllocType alloc_type) {
+// Pages a buffer mapped outside the arena added to its node's hugetlb pool,
+// handed back when the buffer is freed so runs do not grow the pool.
+struct HugePageGrant {
+  size_t page_size;
+  int numa_id;
+  size_t added_pages;
+};
+std::unordered_map<void *, HugePageGrant> hugepage_grants;
+// Serializes the per-node hugepage check with the mapping that consumes the
+// pages, so concurrent workers do not count the same free pages.
+std::mutex select_mutex;
+
+size_t MemAllocator::get_page_size(PageSizeType page_size_type) {
+  switch (page_size_type) {
+  case PageSizeType::PAGE_THP:
+  case PageSizeType::PAGE_2M_HUGETLB:
+    return 2 * MEMUNIT::MiB;
+  case PageSizeType::PAGE_1G_HUGETLB:
+    return MEMUNIT::GiB;
+  default:
+    return 4 * MEMUNIT::KiB;
+  }
+}
+
+std::string MemAllocator::get_page_size_name(PageSizeType page_size_type) {
+  switch (page_size_type) {
+  case PageSizeType::PAGE_THP:
+    return "PAGE_THP";
+  case PageSizeType::PAGE_2M_HUGETLB:
+    return "PAGE_2M_HUGETLB";
+  case PageSizeType::PAGE_1G_HUGETLB:
+    return "PAGE_1G_HUGETLB";
+  default:
+    return "PAGE_4K";
+  }
+}
+
+std::string MemAllocator::format_size(size_t size) {
+  if (size >= MEMUNIT::GiB && size % MEMUNIT::GiB == 0) {
+    return std::to_string(size / MEMUNIT::GiB) + "GiB";
+  } else if (size >= MEMUNIT::MiB && size % MEMUNIT::MiB == 0) {
+    return std::to_string(size / MEMUNIT::MiB) + "MiB";
+  }
+  return std::to_string(size / MEMUNIT::KiB) + "KiB";
+}
+
+// Walks 1G hugetlb -> 2M hugetlb -> THP -> 4K starting at the requested page
+// size and returns the first one the NUMA node can provide for this buffer.
+// added_pages receives the hugetlb pages grown into the pool for it.
+PageSizeType MemAllocator::select_page_size(size_t size, int numa_id,
+                                            PageSizeType page_size_type,
+                                            size_t *added_pages) {
+  *added_pages = 0;
+  while (page_size_type != PageSizeType::PAGE_4K) {
+    bool available = false;
+    if (page_size_type == PageSizeType::PAGE_THP) {
+      available = MmapAlloc::is_thp_available();
+    } else {
+      size_t page_size = get_page_size(page_size_type);
+      size_t num_pages = (size + page_size - 1) / page_size;
+      available = HugePageHandler::is_hugepage_size_supported(page_size) &&
+                  HugePageHandler::reserve_numa_hugepages(
+                      page_size, num_pages, numa_id, added_pages);
+      if (!available) {
+        HugePageHandler::release_numa_hugepages(page_size, *added_pages,
+                                                numa_id);
+        *added_pages = 0;
+      }
+    }
+    if (available) {
+      break;
+    }
+    auto fallback = static_cast<PageSizeType>(
+        static_cast<uint32_t>(page_size_type) - 1);
+    std::cerr << "Warning: " << get_page_size_name(page_size_type)
+              << " is not available on NUMA node " << numa_id
+              << ", falling back to " << get_page_size_name(fallback)
+              << std::endl;
+    page_size_type = fallback;
+  }
+  return page_size_type;
+}
+
+// Size of the pages the kernel actually backs ptr with, which differs from
+// the requested one after a fallback or with physically contiguous buffers.
+size_t MemAllocator::get_backing_page_size(void *ptr) {
+  PageBacking backing = MmapAlloc::get_page_backing(ptr);
+  if (backing.kernel_page_size > 4 * MEMUNIT::KiB) {
+    return backing.kernel_page_size;
+  } else if (backing.anon_huge_pages > 0) {
+    return get_page_size(PageSizeType::PAGE_THP);
+  }
+  return 4 * MEMUNIT::KiB;
+}
+
+std::string MemAllocator::describe_page_size(void *ptr) {
+  PageBacking backing = MmapAlloc::get_page_backing(ptr);
+  if (backing.kernel_page_size > 4 * MEMUNIT::KiB) {
+    return format_size(backing.kernel_page_size) + " hugetlb";
+  } else if (backing.anon_huge_pages > 0) {
+    return "2MiB THP (" + format_size(backing.anon_huge_pages) + " of " +
+           format_size(backing.rss) + " resident)";
+  }
+  return "4KiB";
+}
+
+// Reserves and maps the hugetlb pages for `count` buffers of `size` bytes in
+// one go, so the workers only carve slices out of the arena in allocate().
+// Returns the page size the buffers will actually be backed by.
+PageSizeType MemAllocator::reserve(size_t size, uint32_t count, int numa_id,
+                                   MemAllocType alloc_type,
+                                   PageSizeType page_size_type) {
+  if (alloc_type != MemAllocType::NON_CONTIGUOUS_HUGE_PAGE) {
+    return PageSizeType::PAGE_4K; // physically contiguous base pages
+  }
+  size_t added_pages = 0;
+  if (page_size_type == PageSizeType::PAGE_THP ||
+      page_size_type == PageSizeType::PAGE_4K) {
+    return select_page_size(size, numa_id, page_size_type, &added_pages);
+  }
+  release();
+  // The arena tracks the pages it adds to the pool and gives them back in
+  // release(), so the hugetlb sizes are tried here rather than through
+  // select_page_size().
+  while (page_size_type == PageSizeType::PAGE_1G_HUGETLB ||
+         page_size_type == PageSizeType::PAGE_2M_HUGETLB) {
+    size_t page_size = get_page_size(page_size_type);
+    if (HugePageHandler::is_hugepage_size_supported(page_size)) {
+      hugepage_arena = new HugePageArena(page_size, numa_id);
+      if (hugepage_arena->reserve(size, count)) {
+        return page_size_type;
+      }
+      release();
+    }
+    auto fallback = static_cast<PageSizeType>(
+        static_cast<uint32_t>(page_size_type) - 1);
+    std::cerr << "Warning: " << get_page_size_name(page_size_type)
+              << " is not available on NUMA node " << numa_id
+              << ", falling back to " << get_page_size_name(fallback)
+              << std::endl;
+    page_size_type = fallback;
+  }
+  return select_page_size(size, numa_id, page_size_type, &added_pages);
+}
+
+void MemAllocator::release() {
+  delete hugepage_arena;
+  hugepage_arena = nullptr;
+}
+
+void *MemAllocator::allocate(size_t size, int numa_id, MemAllocType alloc_type,
+                             PageSizeType page_size_type) {
+  if (alloc_type == MemAllocType::NON_CONTIGUOUS_HUGE_PAGE &&
+      hugepage_arena != nullptr && hugepage_arena->get_numa_id() == numa_id &&
+      hugepage_arena->get_page_size() == get_page_size(page_size_type)) {
+    void *addr = hugepage_arena->acquire(size);
+    if (addr != nullptr) {
+      return addr;
+    }
+  }
   if (alloc_type == MemAllocType::NON_CONTIGUOUS_HUGE_PAGE) {
+    std::lock_guard<std::mutex> lock(select_mutex);
     if (mmap_manager == nullptr) {
       mmap_manager = new MmapAlloc();
     }
-    return mmap_manager->alloc_mmap(mmap_manager->get_native_page_size(), size,
-                                    numa_id);
+    void *addr = nullptr;
+    size_t added_pages = 0;
+    page_size_type =
+        select_page_size(size, numa_id, page_size_type, &added_pages);
+    if (page_size_type == PageSizeType::PAGE_4K) {
+      addr = mmap_manager->alloc_mmap(mmap_manager->get_native_page_size(),
+                                      size, numa_id);
+    } else if (page_size_type == PageSizeType::PAGE_THP) {
+      addr = mmap_manager->alloc_thp(size, numa_id);
+    } else {
+      addr = mmap_manager->alloc_mmap(get_page_size(page_size_type), size,
+                                      numa_id);
+    }
+    if (addr == nullptr) {
+      HugePageHandler::release_numa_hugepages(get_page_size(page_size_type),
+                                              added_pages, numa_id);
+      throw std::runtime_error("Failed to allocate " +
+                               get_page_size_name(page_size_type) +
+                               " buffer on NUMA node " +
+                               std::to_string(numa_id));
+    }
+    if (added_pages != 0) {
+      hugepage_grants[addr] = {get_page_size(page_size_type), numa_id,
+                               added_pages};
+    }
+    return addr;
   } else if (alloc_type == MemAllocType::CONTIGUOUS_HUGE_PAGE) {
     if (!memory_manager) {
       memory_manager = new PhysContMem();
     }
 
-    size_t amplification = 10;
-
+    // Candidates are kept across retries, so the searched range grows by
+    // size * amplification per retry until a run is found or the node has
+    // no room left.
+    size_t amplification = 2;
     if (size < 1024 * 1024 * 1024UL) {
-      amplification = 56; // Try to allocate upto 56 GiB
+      amplification = 8;
     } else if (size <= 4 * 1024 * 1024 * 1024UL) {
-      amplification = 20; // Try to allocate upto 80-ish GiB
-    } else {
-      amplification = 10;
+      amplification = 4;
     }
 
     memory_manager->verbose = true;
-    memory_manager->max_allocation_retries = 10;
+    memory_manager->max_allocation_retries = 16;
     memory_manager->allocation_amplification_factor = amplification;
+    memory_manager->numa_id = numa_id;
 
     return memory_manager->alloc(size);
   } else {
@@ -71,11 +260,22 @@ void *MemAllocator::allocate(size_t size, int numa_id,
 }
 
 void MemAllocator::deallocate(void *ptr, size_t size, MemAllocType alloc_type) {
+  if (hugepage_arena != nullptr && hugepage_arena->owns(ptr)) {
+    return; // Unmapped as a whole by release()
+  }
   if (alloc_type == MemAllocType::NON_CONTIGUOUS_HUGE_PAGE) {
     if (mmap_manager == nullptr) {
       mmap_manager = new MmapAlloc();
     }
     mmap_manager->dealloc_mmap(ptr, size);
+    std::lock_guard<std::mutex> lock(select_mutex);
+    auto grant = hugepage_grants.find(ptr);
+    if (grant != hugepage_grants.end()) {
+      HugePageHandler::release_numa_hugepages(grant->second.page_size,
+                                              grant->second.added_pages,
+                                              grant->second.numa_id);
+      hugepage_grants.erase(grant);
+    }
   } else if (alloc_type == MemAllocType::CONTIGUOUS_HUGE_PAGE) {
     if (!memory_manager) {
       memory_manager = new PhysContMem();
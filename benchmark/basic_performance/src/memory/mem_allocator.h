@@ -30,14 +30,31 @@
 #define CXL_PERF_APP_DT_MEM_ALLOCATOR_H
 #include <core/data_structure.h>
 #include <cstddef>
+#include <cstdint>
+#include <string>
 
 class MemAllocator {
 public:
   MemAllocator() = default;
   ~MemAllocator() = default;
 
-  static void *allocate(size_t size, int numa_id, MemAllocType alloc_type);
+  static void *allocate(size_t size, int numa_id, MemAllocType alloc_type,
+                        PageSizeType page_size_type = PageSizeType::PAGE_4K);
   static void deallocate(void *ptr, size_t size, MemAllocType alloc_type);
+  static PageSizeType reserve(size_t size, uint32_t count, int numa_id,
+                              MemAllocType alloc_type,
+                              PageSizeType page_size_type);
+  static void release();
+  static std::string describe_page_size(void *ptr);
+  static size_t get_backing_page_size(void *ptr);
+  static size_t get_page_size(PageSizeType page_size_type);
+  static std::string get_page_size_name(PageSizeType page_size_type);
+
+private:
+  static PageSizeType select_page_size(size_t size, int numa_id,
+                                       PageSizeType page_size_type,
+                                       size_t *added_pages);
+  static std::string format_size(size_t size);
 };
 
 #endif // CXL_PERF_APP_DT_MEM_ALLOCATOR_H
@@ -0,0 +1,117 @@
+/*
+ *
+ * MIT License
+ *
+ * Copyright (c) 2025 Jangseon Park
+ * Affiliation: University of California San Diego CSE
+ * Email: jap036@ucsd.edu
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <memory/mem_preparer.h>
+#include <numa.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <thread>
+#include <unistd.h>
+
+#ifndef MADV_POPULATE_WRITE
+#define MADV_POPULATE_WRITE 23
+#endif
+
+// Smallest range worth handing to a separate helper thread
+static constexpr size_t MIN_HELPER_CHUNK = 64 * 1024 * 1024;
+
+std::vector<int> MemPreparer::get_node_cpus(int numa_id) {
+  std::vector<int> cpus;
+  if (numa_available() >= 0 && numa_id >= 0) {
+    struct bitmask *mask = numa_allocate_cpumask();
+    if (numa_node_to_cpus(numa_id, mask) == 0) {
+      for (unsigned int i = 0; i < mask->size; i++) {
+        if (numa_bitmask_isbitset(mask, i)) {
+          cpus.push_back(static_cast<int>(i));
+        }
+      }
+    }
+    numa_free_cpumask(mask);
+  }
+  // CPU-less (e.g. CXL) nodes are populated from any CPU; the memory policy
+  // of the mapping decides where the pages land.
+  if (cpus.empty()) {
+    long num_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    for (long i = 0; i < num_cpus; i++) {
+      cpus.push_back(static_cast<int>(i));
+    }
+  }
+  return cpus;
+}
+
+void MemPreparer::populate_range(uint8_t *addr, size_t size, uint8_t value) {
+  // Fault the range in with one call where the kernel supports it; the
+  // memset below then only writes already-mapped pages.
+  if (madvise(addr, size, MADV_POPULATE_WRITE) != 0) {
+    long page_size = sysconf(_SC_PAGESIZE);
+    for (size_t i = 0; i < size; i += page_size) {
+      *(volatile uint8_t *)(addr + i) = value;
+    }
+  }
+  std::memset(addr, value, size);
+}
+
+void MemPreparer::populate(uint8_t *addr, size_t size,
+                           const std::vector<int> &helper_cpus,
+                           uint8_t value) {
+  size_t max_helpers = std::max<size_t>(1, size / MIN_HELPER_CHUNK);
+  size_t num_helpers = std::min(helper_cpus.size(), max_helpers);
+  if (num_helpers == 0) {
+    populate_range(addr, size, value);
+    return;
+  }
+
+  long page_size = sysconf(_SC_PAGESIZE);
+  size_t chunk = (size / num_helpers + page_size - 1) & ~(page_size - 1);
+  std::vector<std::thread> helpers;
+  for (size_t i = 0; i < num_helpers; i++) {
+    size_t offset = chunk * i;
+    if (offset >= size) {
+      break;
+    }
+    size_t len = std::min(chunk, size - offset);
+    int cpu = helper_cpus[i];
+    helpers.emplace_back([addr, offset, len, value, cpu]() {
+      // Helpers inherit the worker's real-time policy; drop it so they never
+      // starve a measured thread.
+      sched_param param = {};
+      pthread_setschedparam(pthread_self(), SCHED_OTHER, &param);
+      cpu_set_t cpuset;
+      CPU_ZERO(&cpuset);
+      CPU_SET(cpu, &cpuset);
+      pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuset);
+      populate_range(addr + offset, len, value);
+    });
+  }
+  for (auto &helper : helpers) {
+    helper.join();
+  }
+}
@@ -0,0 +1,49 @@
+/*
+ *
+ * MIT License
+ *
+ * Copyright (c) 2025 Jangseon Park
+ * Affiliation: University of California San Diego CSE
+ * Email: jap036@ucsd.edu
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef CXL_PERF_APP_DT_MEM_PREPARER_H
+#define CXL_PERF_APP_DT_MEM_PREPARER_H
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Faults in and fills worker buffers with helper threads pinned to the CPUs
+// of the buffer's NUMA node, instead of a single-threaded memset.
+class MemPreparer {
+public:
+  static std::vector<int> get_node_cpus(int numa_id);
+  // One helper per CPU of helper_cpus, which must not hold measured cores;
+  // without helper CPUs the calling thread fills the buffer itself.
+  static void populate(uint8_t *addr, size_t size,
+                       const std::vector<int> &helper_cpus, uint8_t value);
+
+private:
+  static void populate_range(uint8_t *addr, size_t size, uint8_t value);
+};
+
+#endif // CXL_PERF_APP_DT_MEM_PREPARER_H
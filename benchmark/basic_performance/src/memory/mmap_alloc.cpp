@@ -86,7 +86,7 @@ void *MmapAlloc::alloc_mmap(size_t page_size, size_t size, int numa_id) {
   addr = mmap(0, size, PROT_READ | PROT_WRITE, flags, -1, 0);
   if (addr == MAP_FAILED) {
     perror("mmap");
-    exit(1);
+    return nullptr;
   }
 
   bind_to_numa_node(addr, size, numa_id);
@@ -95,18 +95,113 @@ void *MmapAlloc::alloc_mmap(size_t page_size, size_t size, int numa_id) {
     if (madvise(addr, size, MADV_NOHUGEPAGE)) {
       perror("madvise");
     }
+  } else {
+    // Take the huge pages from the bound node now, while the caller still
+    // holds the node's reservation, instead of at the first memset.
+    fault_in(addr, size, page_size);
+  }
+
+  std::lock_guard<std::mutex> lock(_mutex);
+  _mapped_size[addr] = size;
+  return addr;
+}
+
+void *MmapAlloc::alloc_thp(size_t size, int numa_id) {
+  const size_t thp_size = 2 * 1024 * 1024UL;
+  size_t pagemask = thp_size - 1;
+  size = (size + pagemask) & ~pagemask;
+
+  // Over-map by one huge page so the buffer can start on a 2 MiB boundary.
+  auto *raw = static_cast<uint8_t *>(mmap(0, size + thp_size,
+                                          PROT_READ | PROT_WRITE,
+                                          MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+  if (raw == MAP_FAILED) {
+    perror("mmap");
+    return nullptr;
+  }
+  auto *addr = reinterpret_cast<uint8_t *>(
+      (reinterpret_cast<uintptr_t>(raw) + pagemask) & ~pagemask);
+  if (addr > raw) {
+    munmap(raw, addr - raw);
+  }
+  if (addr + size < raw + size + thp_size) {
+    munmap(addr + size, raw + size + thp_size - (addr + size));
+  }
+
+  bind_to_numa_node(addr, size, numa_id);
+  if (madvise(addr, size, MADV_HUGEPAGE)) {
+    perror("madvise");
   }
 
+  std::lock_guard<std::mutex> lock(_mutex);
+  _mapped_size[addr] = size;
   return addr;
 }
 
 void MmapAlloc::dealloc_mmap(void *addr, size_t size) {
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto it = _mapped_size.find(addr);
+    if (it != _mapped_size.end()) {
+      size = it->second;
+      _mapped_size.erase(it);
+    }
+  }
   if (munmap(addr, size)) {
     perror("munmap");
     exit(1);
   }
 }
 
+void MmapAlloc::fault_in(void *addr, size_t size, size_t page_size) {
+  auto *ptr = static_cast<volatile uint8_t *>(addr);
+  for (size_t offset = 0; offset < size; offset += page_size) {
+    ptr[offset] = 0;
+  }
+}
+
+bool MmapAlloc::is_thp_available() {
+  FILE *file = fopen("/sys/kernel/mm/transparent_hugepage/enabled", "r");
+  if (file == nullptr) {
+    return false;
+  }
+  char mode[128] = {0};
+  bool available = fgets(mode, sizeof(mode), file) != nullptr &&
+                   strstr(mode, "[never]") == nullptr;
+  fclose(file);
+  return available;
+}
+
+PageBacking MmapAlloc::get_page_backing(void *addr) {
+  PageBacking backing = {0, 0, 0};
+  FILE *file = fopen("/proc/self/smaps", "r");
+  if (file == nullptr) {
+    perror("fopen /proc/self/smaps");
+    return backing;
+  }
+
+  char line[512];
+  bool in_vma = false;
+  auto target = reinterpret_cast<uintptr_t>(addr);
+  while (fgets(line, sizeof(line), file) != nullptr) {
+    uintptr_t start, end;
+    size_t value;
+    if (sscanf(line, "%lx-%lx ", &start, &end) == 2) {
+      in_vma = start <= target && target < end;
+    } else if (!in_vma) {
+      continue;
+    } else if (sscanf(line, "Rss: %zu kB", &value) == 1) {
+      backing.rss = value * 1024;
+    } else if (sscanf(line, "AnonHugePages: %zu kB", &value) == 1) {
+      backing.anon_huge_pages = value * 1024;
+    } else if (sscanf(line, "KernelPageSize: %zu kB", &value) == 1) {
+      backing.kernel_page_size = value * 1024;
+    }
+  }
+  fclose(file);
+  return backing;
+}
+
 void MmapAlloc::bind_to_numa_node(void *addr, size_t size, int numa_id) {
   if (numa_available() == -1) {
     throw std::runtime_error("NUMA is not available on this system");
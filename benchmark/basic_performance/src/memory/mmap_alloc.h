@@ -29,24 +29,39 @@
 #ifndef CXL_PERF_APP_DT_MMAP_ALLOC_H
 #define CXL_PERF_APP_DT_MMAP_ALLOC_H
 
+#include <mutex>
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
+#include <unordered_map>
 
 #define MAX_MEM_NODES (8 * sizeof(uint64_t))
 
+// Page backing of a mapping as reported by /proc/self/smaps.
+struct PageBacking {
+  size_t kernel_page_size;
+  size_t rss;
+  size_t anon_huge_pages;
+};
+
 class MmapAlloc {
 public:
   MmapAlloc() = default;
   ~MmapAlloc() = default;
   void *alloc_mmap(size_t page_size, size_t size, int numa_id);
+  void *alloc_thp(size_t size, int numa_id);
   void dealloc_mmap(void *addr, size_t size);
   size_t get_native_page_size();
+  static bool is_thp_available();
+  static PageBacking get_page_backing(void *addr);
 
 private:
+  std::mutex _mutex;
+  std::unordered_map<void *, size_t> _mapped_size;
   int get_page_size_flags(size_t page_size);
   bool page_size_is_huge(size_t page_size);
   void bind_to_numa_node(void *addr, size_t size, int numa_id);
+  void fault_in(void *addr, size_t size, size_t page_size);
 };
 
 #endif // CXL_PERF_APP_DT_MMAP_ALLOC_H
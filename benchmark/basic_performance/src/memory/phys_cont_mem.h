@@ -29,10 +29,16 @@
 #pragma once
 
 #include <algorithm>
+#include <cerrno>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <fcntl.h>
 #include <iostream>
+#include <mutex>
+#include <numa.h>
+#include <numaif.h>
+#include <stdexcept>
 #include <sys/mman.h>
 #include <unistd.h>
 #include <unordered_map>
@@ -42,6 +48,10 @@
 #define PAGEMAP_LENGTH 8
 #endif
 
+#ifndef MADV_POPULATE_WRITE
+#define MADV_POPULATE_WRITE 23
+#endif
+
 class PhysContMem {
 public:
   PhysContMem() : page_size(getpagesize()) {
@@ -51,33 +61,67 @@ public:
     } else {
       std::cerr << "Page size: " << page_size << " bytes.\n";
     }
+    pagemap_fd = open("/proc/self/pagemap", O_RDONLY);
+    if (pagemap_fd < 0) {
+      throw std::runtime_error("Failed to open /proc/self/pagemap. open: " +
+                               std::string(strerror(errno)));
+    }
   }
 
+  ~PhysContMem() {
+    for (auto &allocation : allocation_map) {
+      munmap(allocation.first, allocation.second);
+    }
+    close(pagemap_fd);
+  }
+
+  PhysContMem(const PhysContMem &) = delete;
+  PhysContMem &operator=(const PhysContMem &) = delete;
+
   bool verbose = false;
 
-  // Number of additional pages to allocate at for each page requested
-  // Extra pages are released after the call to alloc()
-  size_t allocation_amplification_factor = 10;
+  // Number of pages mapped per retry for each page requested. Pages that are
+  // not part of the best run are kept as candidates for the next retry, so
+  // the search space grows by this factor on every retry. Leftover pages are
+  // released before alloc() returns.
+  size_t allocation_amplification_factor = 2;
 
   // Maximum number of allocation retries
   size_t max_allocation_retries = 10;
 
+  // NUMA node the candidate pages are bound to, or -1 for the default policy
+  int numa_id = -1;
+
   // Main function to allocate and remap memory
   // Returns non-null pointer to a physically contiguous memory region, or
   // nullptr on failure Sets errorno on failure
   void *alloc(size_t bytes, void *hint = (void *)0x100000000) {
-    for (size_t i = 0; i < max_allocation_retries; i++) {
-      void *result = _alloc(bytes, hint);
-      if (result != nullptr) {
-        allocation_map[result] = bytes;
-        return result;
+    std::lock_guard<std::mutex> lock(alloc_mutex);
+    const size_t N = bytes / page_size;
+    if (N == 0) {
+      errno = EINVAL;
+      return nullptr;
+    }
+
+    void *result = nullptr;
+    for (size_t i = 0; i < max_allocation_retries && result == nullptr; i++) {
+      if (!add_candidates(allocation_amplification_factor * N, N)) {
+        break;
       }
+      result = take_run(N, hint);
     }
+    release_candidates();
 
-    return nullptr;
+    if (result != nullptr) {
+      allocation_map[result] = N * page_size;
+    } else if (verbose) {
+      std::cerr << "Could not find " << N << " consecutive physical pages.\n";
+    }
+    return result;
   }
 
   void dealloc(void *ptr) {
+    std::lock_guard<std::mutex> lock(alloc_mutex);
     if (allocation_map.find(ptr) != allocation_map.end()) {
       munmap(ptr, allocation_map[ptr]);
       allocation_map.erase(ptr);
@@ -91,23 +135,17 @@ public:
         (size + page_size - 1) / page_size; // Round up to cover partial pages
 
     std::vector<size_t> pfns(numPages);
+    read_pfns(start_addr, numPages, pfns.data());
 
-    // Get the PFN for each page in the region
     for (size_t i = 0; i < numPages; i++) {
-      void *pageAddr = (unsigned char *)start_addr + (i * page_size);
-      const size_t pfn = get_pfn_of_addr(pageAddr);
-      if (pfn == 0) {
+      if (pfns[i] == 0) {
         if (verbose)
-          std::cerr << "Failed to get PFN for address " << pageAddr << "\n";
-
+          std::cerr << "Failed to get PFN for address "
+                    << (void *)((unsigned char *)start_addr + i * page_size)
+                    << "\n";
         return false;
       }
-      pfns[i] = pfn;
-    }
-
-    // Check if the PFNs are consecutive
-    for (size_t i = 1; i < numPages; i++) {
-      if (pfns[i] != pfns[i - 1] + 1) {
+      if (i > 0 && pfns[i] != pfns[i - 1] + 1) {
         return false; // Not contiguous
       }
     }
@@ -116,180 +154,199 @@ public:
   }
 
 private:
+  // Entries read from pagemap per pread (512 KiB, 256 MiB of 4 KiB pages)
+  static constexpr size_t PAGEMAP_BATCH = 64 * 1024;
+
   size_t page_size = -1UL;
+  int pagemap_fd = -1;
+  std::mutex alloc_mutex;
   std::unordered_map<void *, size_t> allocation_map;
 
-  template <typename T> size_t get_pfn_of_addr(T addr_raw) {
-    const auto addr = (void *)addr_raw;
-    FILE *pagemap = fopen("/proc/self/pagemap", "rb");
-    if (!pagemap) {
-      throw std::runtime_error("Failed to open /proc/self/pagemap. fopen: " +
-                               std::string(strerror(errno)));
-    }
-
-    const size_t offset = (size_t)addr / page_size * PAGEMAP_LENGTH;
-    if (fseek(pagemap, (long)offset, SEEK_SET) != 0) {
-      throw std::runtime_error(
-          "Failed to seek pagemap to proper location. fseek: " +
-          std::string(strerror(errno)));
+  // (PFN, VA) of every candidate page, sorted by PFN
+  std::vector<std::pair<size_t, void *>> candidates;
+
+  // Fills pfns with the PFN of each page, or 0 for pages that are not present
+  void read_pfns(void *start_addr, size_t num_pages, size_t *pfns) {
+    std::vector<uint64_t> entries(std::min(num_pages, PAGEMAP_BATCH));
+    size_t first_page = (size_t)start_addr / page_size;
+    for (size_t done = 0; done < num_pages;) {
+      const size_t count = std::min(num_pages - done, PAGEMAP_BATCH);
+      const off_t offset = (off_t)((first_page + done) * PAGEMAP_LENGTH);
+      const ssize_t bytes_read =
+          pread(pagemap_fd, entries.data(), count * PAGEMAP_LENGTH, offset);
+      if (bytes_read != (ssize_t)(count * PAGEMAP_LENGTH)) {
+        throw std::runtime_error("Failed to read pagemap. pread: " +
+                                 std::string(strerror(errno)));
+      }
+      for (size_t i = 0; i < count; i++) {
+        // Bit 63 is the present bit, the lower 55 bits hold the PFN
+        pfns[done + i] =
+            (entries[i] >> 63) ? (entries[i] & 0x7FFFFFFFFFFFFF) : 0;
+      }
+      done += count;
     }
+  }
 
-    size_t page_frame_number = 0;
-    // Read 7 bytes (lower 55 bits hold the PFN)
-    const auto bytes_read =
-        fread(&page_frame_number, 1, PAGEMAP_LENGTH - 1, pagemap);
-
-    if (bytes_read != PAGEMAP_LENGTH - 1) {
-      throw std::runtime_error("Failed to read pagemap. fread: " +
-                               std::string(strerror(errno)));
+  size_t get_free_bytes() {
+    if (numa_id >= 0) {
+      long long free_bytes = 0;
+      numa_node_size64(numa_id, &free_bytes);
+      return free_bytes > 0 ? (size_t)free_bytes : 0;
     }
-
-    page_frame_number &= 0x7FFFFFFFFFFFFF;
-
-    fclose(pagemap);
-    return page_frame_number;
+    long pages = sysconf(_SC_AVPHYS_PAGES);
+    return pages > 0 ? (size_t)pages * page_size : 0;
   }
 
-  void *_alloc(size_t bytes, void *hint) {
-    int N = bytes / page_size;
-    if (N <= 0) {
-      return nullptr; // Invalid size
+  // Maps and faults in up to num_pages more pages and merges them into the
+  // sorted candidate list. Returns false once the node has no room left for
+  // at least min_pages of them.
+  bool add_candidates(size_t num_pages, size_t min_pages) {
+    // Leave some headroom so the search never pushes the node into reclaim
+    const size_t free_bytes = get_free_bytes();
+    num_pages = std::min(num_pages, free_bytes / 8 * 7 / page_size);
+    if (num_pages < min_pages) {
+      if (verbose)
+        std::cerr << "Not enough free memory for more candidate pages ("
+                  << free_bytes / 1024 / 1024 << " MiB free).\n";
+      return false;
     }
+    const size_t allocSize = num_pages * page_size;
 
-    // We will allocate allocation_amplification_factor * N pages
-    const int totalPages = allocation_amplification_factor * N;
-    size_t allocSize = (size_t)totalPages * page_size;
-
-    // Create one large allocation
     void *base = mmap(nullptr, allocSize, PROT_READ | PROT_WRITE,
                       MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
     if (base == MAP_FAILED) {
-      return nullptr; // Allocation failed
+      return false;
+    }
+    if (numa_id >= 0) {
+      unsigned long nodemask = (1UL << numa_id);
+      if (mbind(base, allocSize, MPOL_BIND, &nodemask, sizeof(nodemask) * 8,
+                0) != 0) {
+        perror("Failed to bind candidate pages to NUMA node");
+      }
+    }
+    // Force a real mapping for every page
+    if (madvise(base, allocSize, MADV_POPULATE_WRITE) != 0) {
+      for (size_t i = 0; i < num_pages; i++) {
+        *((volatile char *)base + i * page_size) = 0;
+      }
     }
 
-    // Store (PFN, VA) for each allocated page
-    std::vector<std::pair<size_t, void *>> pfnVaPairs(totalPages);
-
-    // Touch each page to ensure it is backed by real memory, then find its PFN
-    for (int i = 0; i < totalPages; i++) {
-      void *addr = (unsigned char *)base + (i * page_size);
-      // Force a real mapping
-      *(volatile char *)addr = 0;
-
-      size_t pfn = get_pfn_of_addr(addr);
-      pfnVaPairs[i] = std::make_pair(pfn, addr);
+    std::vector<size_t> pfns(num_pages);
+    try {
+      read_pfns(base, num_pages, pfns.data());
+    } catch (...) {
+      munmap(base, allocSize);
+      throw;
     }
 
-    // Sort pages by their PFN
-    std::sort(pfnVaPairs.begin(), pfnVaPairs.end(),
+    const size_t old_size = candidates.size();
+    candidates.reserve(old_size + num_pages);
+    for (size_t i = 0; i < num_pages; i++) {
+      candidates.emplace_back(pfns[i], (unsigned char *)base + i * page_size);
+    }
+    auto middle = candidates.begin() + old_size;
+    std::sort(middle, candidates.end(),
               [](auto &a, auto &b) { return a.first < b.first; });
+    std::inplace_merge(candidates.begin(), middle, candidates.end(),
+                       [](auto &a, auto &b) { return a.first < b.first; });
+    return true;
+  }
 
-    // Find the largest run of consecutive PFNs
-    int bestLen = 1;
-    int bestStart = 0;
-
-    int currentLen = 1;
-    int currentStart = 0;
-
-    for (int i = 1; i < totalPages; i++) {
-      if (pfnVaPairs[i].first == pfnVaPairs[i - 1].first + 1) {
+  // Finds the longest run of consecutive PFNs in the candidate list and, if
+  // it is at least N pages, moves its first N pages to a virtually
+  // contiguous region.
+  void *take_run(size_t N, void *hint) {
+    size_t bestLen = 0;
+    size_t bestStart = 0;
+    size_t currentLen = 0;
+    for (size_t i = 0; i < candidates.size(); i++) {
+      if (candidates[i].first == 0) {
+        currentLen = 0;
+        continue;
+      }
+      if (currentLen > 0 &&
+          candidates[i].first == candidates[i - 1].first + 1) {
         currentLen++;
       } else {
-        if (currentLen > bestLen) {
-          bestLen = currentLen;
-          bestStart = currentStart;
-        }
         currentLen = 1;
-        currentStart = i;
       }
-    }
-    // Check at the end
-    if (currentLen > bestLen) {
-      bestLen = currentLen;
-      bestStart = currentStart;
+      if (currentLen > bestLen) {
+        bestLen = currentLen;
+        bestStart = i + 1 - currentLen;
+      }
     }
 
     if (verbose)
-      std::cerr << "Largest consecutive PFN run: " << bestLen << " pages.\n";
+      std::cerr << "Largest consecutive PFN run: " << bestLen << " of "
+                << candidates.size() << " candidate pages.\n";
 
     if (bestLen < N) {
-      if (verbose)
-        std::cerr << "Could not find " << N << " consecutive physical pages.\n";
-      // Clean up
-      munmap(base, allocSize);
       return nullptr;
     }
 
-    if (verbose)
-      std::cerr << "Success: Found at least " << N
-                << " consecutive physical pages.\n";
-
-    // Reserve a new region at 0x100000000 for these N pages
-    // This region must be unmapped before calling MAP_FIXED, or we can do
-    // an anonymous mmap to reserve that space.
-    void *newBase = hint;
-    size_t newSize = (size_t)N * page_size;
-
-    // Map the new address range (just to reserve it)
-    void *fixedMapping = mmap(newBase, newSize, PROT_READ | PROT_WRITE,
-                              MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED, -1, 0);
-    if (fixedMapping == MAP_FAILED) {
+    // Reserve the destination range; the hint is only honored if it is free
+    const size_t newSize = N * page_size;
+    void *newBase = mmap(hint, newSize, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (newBase == MAP_FAILED) {
       if (verbose)
-        std::cerr << "Failed to mmap the new region at 0x100000000.\n";
-      munmap(base, allocSize);
+        std::cerr << "Failed to reserve the contiguous region.\n";
       errno = ENOMEM;
       return nullptr;
     }
 
     if (verbose)
-      std::cerr << "Remapping pages to " << hint << "...\n";
-
-    // Move each page in the found run to the new region
-    // We'll do it one page at a time.
-    for (int i = bestStart; i < bestStart + N; i++) {
-      void *oldAddr = pfnVaPairs[i].second;
-      void *newAddr =
-          (void *)((unsigned char *)newBase + (i - bestStart) * page_size);
+      std::cerr << "Remapping pages to " << newBase << "...\n";
 
-      // Perform the remap
+    for (size_t i = 0; i < N; i++) {
+      void *oldAddr = candidates[bestStart + i].second;
+      void *newAddr = (unsigned char *)newBase + i * page_size;
       void *result = mremap(oldAddr, page_size, page_size,
                             MREMAP_MAYMOVE | MREMAP_FIXED, newAddr);
-      const auto mremap_errno = errno;
       if (result == MAP_FAILED) {
+        const auto mremap_errno = errno;
         if (verbose)
           std::cerr << "mremap failed at index " << i << "\n";
-
-        // Clean up
-        munmap(fixedMapping, newSize);
-        munmap(base, allocSize);
-
+        // Pages already moved are lost as candidates; the rest are kept
+        munmap(newBase, newSize);
+        candidates.erase(candidates.begin() + bestStart,
+                         candidates.begin() + bestStart + i);
         errno = mremap_errno;
-
         return nullptr;
       }
     }
+    candidates.erase(candidates.begin() + bestStart,
+                     candidates.begin() + bestStart + N);
 
-    // Unmap any leftover pages in the original allocation
-    // The pages we moved should no longer reside there, but let's clean up
-    // whatever remains in that original area.
-    munmap(base, allocSize);
+    if (!is_physically_contiguous(newBase, newSize)) {
+      munmap(newBase, newSize);
+      return nullptr;
+    }
 
     if (verbose)
-      std::cerr << "Remap completed. The pages are now virtually contiguous at "
-                   "0x100000000.\n";
-
-    // At this point, the memory for the N pages is at 0x100000000 to
-    // 0x100000000 + (N*page_size - 1)
+      std::cerr << "Remap completed. " << newSize / 1024 / 1024
+                << " MiB are now physically contiguous at " << newBase
+                << ".\n";
+    return newBase;
+  }
 
-    if (verbose) {
-      std::cerr << "Is the new region physically contiguous? " << std::boolalpha
-                << is_physically_contiguous(newBase, newSize) << "\n";
-      std::cerr << "Region size: " << newSize / 1024 / 1024 << " MiB.\n";
+  // Unmaps the leftover candidate pages. Only ranges of pages we still own
+  // are unmapped, as the holes left by mremap may have been reused.
+  void release_candidates() {
+    std::sort(candidates.begin(), candidates.end(),
+              [](auto &a, auto &b) { return a.second < b.second; });
+    size_t i = 0;
+    while (i < candidates.size()) {
+      auto *start = (unsigned char *)candidates[i].second;
+      size_t len = 1;
+      while (i + len < candidates.size() &&
+             candidates[i + len].second == start + len * page_size) {
+        len++;
+      }
+      munmap(start, len * page_size);
+      i += len;
     }
-
-    // Normally, you might do some work here, then eventually unmap:
-    // munmap(newBase, newSize);
-
-    return is_physically_contiguous(newBase, newSize) ? newBase : nullptr;
+    candidates.clear();
+    candidates.shrink_to_fit();
   }
 };
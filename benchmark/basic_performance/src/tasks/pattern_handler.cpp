@@ -27,11 +27,65 @@
  */
 
 #include <tasks/pattern_handler.h>
+#include <utils/timer.h>
 
 void PatternHandler::prepare(const std::shared_ptr<WorkerContext> &ctx) {
+  Timer timer;
+  timer.start();
   _mem_utils.flush_cache(ctx->addr, ctx->size);
+  ctx->log.flush_time += static_cast<uint64_t>(timer.elapsed());
 };
 
+// Waits for every worker of the job to finish preparing before the first
+// timed access.
+void PatternHandler::begin_measurement(
+    const std::shared_ptr<WorkerContext> &ctx) {
+  if (ctx->start_barrier && !ctx->start_arrived) {
+    ctx->start_arrived = true;
+    ctx->start_barrier->arrive_and_wait();
+  }
+  if (ctx->noise_monitor) {
+    ctx->noise_monitor->begin();
+  }
+  ctx->convergence.start();
+  if (ctx->perf_counter) {
+    ctx->perf_counter->enable();
+  }
+}
+
+void PatternHandler::leave_start_barrier(
+    const std::shared_ptr<WorkerContext> &ctx) {
+  if (ctx->start_barrier && !ctx->start_arrived) {
+    ctx->start_arrived = true;
+    ctx->start_barrier->arrive_and_drop();
+  }
+}
+
+void PatternHandler::end_measurement(
+    const std::shared_ptr<WorkerContext> &ctx) {
+  if (ctx->perf_counter) {
+    ctx->perf_counter->disable();
+    ctx->perf_counts = ctx->perf_counter->read();
+  }
+  if (ctx->noise_monitor) {
+    ctx->noise_monitor->end();
+    ctx->noise = ctx->noise_monitor->report();
+  }
+}
+
+// Adds one batch result to the histogram and the convergence controller.
+// Returns true once the controller wants the measurement to stop.
+bool PatternHandler::record_sample(const std::shared_ptr<WorkerContext> &ctx,
+                                   double sample) {
+  ctx->samples.record(static_cast<uint64_t>(sample));
+  ctx->convergence.add(sample);
+  if (ctx->convergence.done()) {
+    ctx->converged = true;
+    return true;
+  }
+  return false;
+}
+
 bool PatternHandler::check_stop_condition(
     const std::shared_ptr<WorkerContext> &ctx) {
   bool return_flag = false;
@@ -70,11 +124,17 @@ void StrideBandwidthPatternHandler::handle(std::shared_ptr<WorkerContext> ctx) {
               << static_cast<int>(ctx->ldst_type) << std::endl;
     return;
   }
+  ctx->samples.set_unit("MiB/s");
+  begin_measurement(ctx);
   while (true) {
     func(addr, access_size, stride_size, latency, access_count, block_size,
          &latency_buf);
     log.latency += latency_buf;
     log.size += access_size * access_count;
+    if (latency_buf != 0) {
+      record_sample(ctx, access_size * access_count * 1e9 / latency_buf /
+                             MEMUNIT::MiB);
+    }
     addr += stride_size * access_count;
     if (addr + access_size * access_count >= end_addr) {
       addr = ctx->addr;
@@ -83,6 +143,7 @@ void StrideBandwidthPatternHandler::handle(std::shared_ptr<WorkerContext> ctx) {
       break;
     }
   };
+  end_measurement(ctx);
 }
 
 void StrideLatencyPatternHandler::handle(std::shared_ptr<WorkerContext> ctx) {
@@ -116,17 +177,28 @@ void StrideLatencyPatternHandler::handle(std::shared_ptr<WorkerContext> ctx) {
               << static_cast<int>(ctx->ldst_type) << std::endl;
     return;
   }
-  while (iteration++ < pattern_iter) {
+  ctx->samples.set_unit("ns");
+  begin_measurement(ctx);
+  // Runs pattern_iteration batches, or until the CI converges if a
+  // convergence target is set
+  bool converged = false;
+  while (ctx->convergence.enabled() ? !converged : iteration < pattern_iter) {
+    iteration++;
     func(addr, access_size, stride_size, delay, access_count, block_size,
          &latency_buf);
-    latency += latency_buf / ((access_size / 0x40) * access_count);
+    uint64_t sample = latency_buf / ((access_size / 0x40) * access_count);
+    latency += sample;
+    converged = record_sample(ctx, sample);
     log.size += access_size * access_count;
     addr += stride_size * access_count;
     if (addr + access_size * access_count >= end_addr) {
       addr = ctx->addr;
     }
   }
-  log.latency += latency / (iteration - 1);
+  end_measurement(ctx);
+  log.latency += ctx->convergence.enabled()
+                     ? static_cast<uint64_t>(ctx->convergence.estimate())
+                     : latency / iteration;
   {
     std::lock_guard<std::mutex> lock(ctx->mutex);
     ctx->complete.notify_all();
@@ -152,14 +224,20 @@ void SimpleLdStBandwidthPatternHandler::handle(
     return;
   }
 
+  ctx->samples.set_unit("MiB/s");
+  begin_measurement(ctx);
   while (true) {
     func(addr, size, &latency_buf, bw_pattern_size);
     log.latency += latency_buf;
     log.size += size;
+    if (latency_buf != 0) {
+      record_sample(ctx, size * 1e9 / latency_buf / MEMUNIT::MiB);
+    }
     if (check_stop_condition(ctx)) {
       break;
     }
   };
+  end_measurement(ctx);
 }
 
 void PointerChaseLatencyPatternHandler::handle(
@@ -170,7 +248,7 @@ void PointerChaseLatencyPatternHandler::handle(
   uint64_t block_size = ctx->lt_pattern_block_size;
   auto *addr = reinterpret_cast<uint64_t *>(ctx->addr);
   auto *end_addr = reinterpret_cast<uint64_t *>(ctx->end_addr);
-  uint64_t latency = 0;
+  double latency = 0.0;
   WorkerTestLog &log = ctx->log;
   LoadStoreType ldst_type = ctx->ldst_type;
   uint32_t repeat_time = ctx->pattern_iteration;
@@ -194,21 +272,51 @@ void PointerChaseLatencyPatternHandler::handle(
   auto *timing_load =
       static_cast<uint64_t *>(malloc(repeat_time * sizeof(uint64_t)));
   std::cout << "init chasing index" << std::endl;
-  _pointer_chase_patterns.init_chasing_index(cindex, csize, thread_id);
-  if (ctx->ldst_type == LoadStoreType::LOAD) {
+  _pointer_chase_patterns.init_chasing_index(
+      cindex, csize, thread_id, ctx->chasing_type, stride_size, ctx->page_size);
+  if (ldst_type == LoadStoreType::LOAD ||
+      ldst_type == LoadStoreType::LOAD_WITH_FLUSH) {
     std::cout << "prepare pointer chaser" << std::endl;
-    _pointer_chase_patterns.prepare_pointer_chaser(addr, end_addr, stride_size,
-                                                   cindex, csize);
+    _pointer_chase_patterns.prepare_pointer_chaser(
+        addr, end_addr, stride_size, cindex, csize,
+        ldst_type == LoadStoreType::LOAD);
+  }
+  auto func = _pointer_chase_patterns.get(ldst_type);
+  if (func == nullptr) {
+    std::cerr << "Error: Invalid PcLdSTFunc for LoadStoreType: "
+              << static_cast<int>(ldst_type) << std::endl;
+    free(cindex);
+    free(timing_load);
+    {
+      std::lock_guard<std::mutex> lock(ctx->mutex);
+      ctx->complete.notify_all();
+    }
+    return;
   }
+  uint64_t access_count_per_repeat = _pointer_chase_patterns.get_access_count(
+      ldst_type, thread_buffer_size, block_size);
+  ctx->samples.set_unit("ns");
   std::cout << "start pointer chaser" << std::endl;
-  auto func = _pointer_chase_patterns.get(ctx->ldst_type);
-  func(addr, thread_buffer_size, stride_size, 0, block_size, repeat_time,
-       cindex, timing_load);
+  begin_measurement(ctx);
+  // One batch of pattern_iteration repeats, or batches until the CI
+  // converges if a convergence target is set
+  bool converged = false;
+  do {
+    func(addr, thread_buffer_size, stride_size, 0, block_size, repeat_time,
+         cindex, timing_load);
+    for (unsigned long i = 0; i < repeat_time; i++) {
+      // ns per hop, kept fractional for L1 and L2 latencies
+      double sample = static_cast<double>(timing_load[i]) /
+                      static_cast<double>(access_count_per_repeat);
+      latency += sample;
+      converged = record_sample(ctx, sample) || converged;
+    }
+  } while (ctx->convergence.enabled() && !converged);
+  end_measurement(ctx);
   std::cout << "end pointer chaser" << std::endl;
-  for (unsigned long i = 0; i < repeat_time; i++) {
-    latency += timing_load[i] / (thread_buffer_size / block_size);
-  }
-  log.latency = latency / (repeat_time);
+  log.latency = ctx->convergence.enabled() ? ctx->convergence.estimate()
+                                            : latency / repeat_time;
+  free(cindex);
   free(timing_load);
   {
     std::lock_guard<std::mutex> lock(ctx->mutex);
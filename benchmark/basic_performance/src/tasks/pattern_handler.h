@@ -40,6 +40,12 @@ public:
   virtual void handle(std::shared_ptr<WorkerContext> ctx) = 0;
 
   void prepare(const std::shared_ptr<WorkerContext> &ctx);
+  static void begin_measurement(const std::shared_ptr<WorkerContext> &ctx);
+  // Lets the other workers start measuring when this one never will
+  static void leave_start_barrier(const std::shared_ptr<WorkerContext> &ctx);
+  static void end_measurement(const std::shared_ptr<WorkerContext> &ctx);
+  static bool record_sample(const std::shared_ptr<WorkerContext> &ctx,
+                            double sample);
   void wrapup();
   static bool check_stop_condition(const std::shared_ptr<WorkerContext> &ctx);
 
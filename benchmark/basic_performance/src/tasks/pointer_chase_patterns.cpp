@@ -26,72 +26,120 @@
  *
  */
 
+#include <algorithm>
 #include <cstring>
 #include <fstream>
 #include <iostream>
 #include <machine/machine_dependency.h>
+#include <numeric>
 #include <random>
+#include <stdexcept>
 #include <tasks/pointer_chase_patterns.h>
 #include <thread>
 #include <utils/timer.h>
 
-PointerChasePatternsAbstract::PointerChasePatternsAbstract()
-    : _chasing_type(CHASING_TYPE::CHASING_TYPE_RANDOM) {
+PointerChasePatternsAbstract::PointerChasePatternsAbstract() {
   _func_map[LoadStoreType::LOAD] =
       [this](uint64_t *base_addr, uint64_t region_size, uint64_t stride_size,
              uint64_t region_skip, uint64_t block_size, uint64_t repeat,
              uint64_t *cindex, uint64_t *timing_load) {
-        this->load(base_addr, region_size, stride_size, region_skip, block_size,
-                   repeat, cindex, timing_load);
+        this->dependent_load<Timer>(base_addr, region_size, stride_size,
+                                    region_skip, block_size, repeat, cindex,
+                                    timing_load);
       };
-  _func_map[LoadStoreType::STORE] =
+  _func_map[LoadStoreType::LOAD_WITH_FLUSH] =
       [this](uint64_t *base_addr, uint64_t region_size, uint64_t stride_size,
              uint64_t region_skip, uint64_t block_size, uint64_t repeat,
-             uint64_t *cindex, uint64_t *timing_store) {
-        this->store(base_addr, region_size, stride_size, region_skip,
-                    block_size, repeat, cindex, timing_store);
+             uint64_t *cindex, uint64_t *timing_load) {
+        this->load_with_flush<CycleTimer>(base_addr, region_size, stride_size,
+                                          region_skip, block_size, repeat,
+                                          cindex, timing_load);
       };
+  auto store_func = [this](uint64_t *base_addr, uint64_t region_size,
+                           uint64_t stride_size, uint64_t region_skip,
+                           uint64_t block_size, uint64_t repeat,
+                           uint64_t *cindex, uint64_t *timing_store) {
+    this->store_with_flush<CycleTimer>(base_addr, region_size, stride_size,
+                                       region_skip, block_size, repeat, cindex,
+                                       timing_store);
+  };
+  _func_map[LoadStoreType::STORE] = store_func;
+  _func_map[LoadStoreType::STORE_WITH_FLUSH] = store_func;
+}
+
+uint64_t PointerChasePatternsAbstract::get_access_count(LoadStoreType ldst_type,
+                                                        uint64_t region_size,
+                                                        uint64_t block_size) {
+  uint64_t access_count = region_size / block_size;
+  if (ldst_type == LoadStoreType::LOAD) {
+    access_count = std::max(access_count, MIN_DEPENDENT_CHASE_HOPS);
+  }
+  return access_count;
+}
+
+template <typename TimerT>
+void PointerChasePatternsAbstract::dependent_load(
+    uint64_t *base_addr, uint64_t region_size, uint64_t stride_size,
+    uint64_t region_skip, uint64_t block_size, uint64_t repeat,
+    uint64_t *cindex, uint64_t *timing_load) {
+  TimerT timer;
+  uint64_t hops =
+      get_access_count(LoadStoreType::LOAD, region_size, block_size);
+  // One untimed lap brings the cache to the steady state dictated by the
+  // working-set size before the timed laps start.
+  uint64_t *curr = PointerChaseLdStPattern::chase_64B(
+      base_addr, region_size / stride_size);
+  for (uint64_t i = 0; i < repeat; i++) {
+    timer.start();
+    curr = PointerChaseLdStPattern::chase_64B(curr, hops);
+    timing_load[i] = static_cast<uint64_t>(timer.elapsed());
+  }
 }
 
-void PointerChasePatternsAbstract::load(
+template <typename TimerT>
+void PointerChasePatternsAbstract::load_with_flush(
     uint64_t *base_addr, uint64_t region_size, uint64_t stride_size,
     uint64_t region_skip, uint64_t block_size, uint64_t repeat,
     uint64_t *cindex, uint64_t *timing_load) {
   int i = 0;
-  Timer timer;
-  MemUtils util;
+  TimerT timer;
   for (i = 0; i < repeat; i++) {
-    PointerChaseLdStPattern::load_64B(base_addr, region_size, stride_size,
-                                      block_size, &timing_load[i], timer);
+    PointerChaseLdStPattern::load_64B_with_flush(
+        base_addr, region_size, stride_size, block_size, &timing_load[i],
+        timer);
   }
 }
 #pragma GCC push_options
 #pragma GCC optimize("O0")
-void PointerChasePatternsAbstract::store(
+template <typename TimerT>
+void PointerChasePatternsAbstract::store_with_flush(
     uint64_t *base_addr, uint64_t region_size, uint64_t stride_size,
     uint64_t region_skip, uint64_t block_size, uint64_t repeat,
     uint64_t *cindex, uint64_t *timing_store) {
   int i = 0;
-  Timer timer;
-  MemUtils util;
+  TimerT timer;
   for (i = 0; i < repeat; i++) {
-    PointerChaseLdStPattern::store_64B(base_addr, region_size, stride_size,
-                                       block_size, cindex, &timing_store[i],
-                                       timer);
+    PointerChaseLdStPattern::store_64B_with_flush(
+        base_addr, region_size, stride_size, block_size, cindex,
+        &timing_store[i], timer);
   }
 }
 #pragma GCC pop_options
 
-std::string PointerChasePatternsAbstract::get_filename(uint64_t csize,
-                                                       uint32_t thread_id) {
+std::string PointerChasePatternsAbstract::get_filename(
+    uint64_t csize, uint32_t thread_id, CHASING_TYPE chasing_type,
+    uint64_t stride_size, uint64_t page_size) {
   return "pointer_chase_" + std::to_string(thread_id) + "_" +
-         std::to_string(csize) + ".txt";
+         std::to_string(csize) + "_" +
+         std::to_string(static_cast<uint32_t>(chasing_type)) + "_" +
+         std::to_string(stride_size) + "_" + std::to_string(page_size) +
+         ".txt";
 }
 
 bool PointerChasePatternsAbstract::load_from_file(uint64_t *cindex,
                                                   uint64_t csize,
-                                                  uint32_t thread_id) {
-  std::ifstream infile(get_filename(csize, thread_id));
+                                                  const std::string &filename) {
+  std::ifstream infile(filename);
   if (!infile)
     return false;
 
@@ -107,59 +155,128 @@ bool PointerChasePatternsAbstract::load_from_file(uint64_t *cindex,
 
 void PointerChasePatternsAbstract::save_to_file(const uint64_t *cindex,
                                                 uint64_t csize,
-                                                uint32_t thread_id) {
-  std::ofstream outfile(get_filename(csize, thread_id));
+                                                const std::string &filename) {
+  std::ofstream outfile(filename);
   for (uint64_t i = 0; i < csize; ++i) {
     outfile << cindex[i] << "\n";
   }
   std::cout << "Saved pointer chase index to file.\n";
 }
 
+// Returns the visiting order of the chase elements (each stride_size bytes
+// apart). The order always starts at element 0, where every walk begins.
+// The page-granular topologies group the elements by page_size.
+std::vector<uint64_t> PointerChasePatternsAbstract::generate_chasing_order(
+    uint64_t csize, CHASING_TYPE chasing_type, uint64_t stride_size,
+    uint64_t page_size) {
+  static thread_local std::mt19937_64 gen(std::random_device{}());
+  std::vector<uint64_t> order;
+  order.reserve(csize);
+
+  auto shuffled_groups = [&](uint64_t group_size) {
+    for (uint64_t begin = 0; begin < csize; begin += group_size) {
+      uint64_t end = std::min(begin + group_size, csize);
+      size_t first = order.size();
+      for (uint64_t i = begin; i < end; i++) {
+        order.push_back(i);
+      }
+      std::shuffle(order.begin() + first + (begin == 0 ? 1 : 0), order.end(),
+                   gen);
+    }
+  };
+
+  uint64_t lines_per_page =
+      std::max<uint64_t>(page_size / stride_size, 1);
+  uint64_t pages = (csize + lines_per_page - 1) / lines_per_page;
+
+  switch (chasing_type) {
+  case CHASING_TYPE::CHASING_TYPE_LINEAR:
+    for (uint64_t i = 0; i < csize; i++) {
+      order.push_back(i);
+    }
+    break;
+  case CHASING_TYPE::CHASING_TYPE_RANDOM:
+    shuffled_groups(csize);
+    break;
+  case CHASING_TYPE::CHASING_TYPE_PAGE_LOCAL_RANDOM:
+    shuffled_groups(lines_per_page);
+    break;
+  case CHASING_TYPE::CHASING_TYPE_REGION_2M_RANDOM:
+    shuffled_groups(std::max<uint64_t>(CHASE_REGION_SIZE / stride_size, 1));
+    break;
+  case CHASING_TYPE::CHASING_TYPE_PAGE_STRIDE:
+    for (uint64_t line = 0; line < lines_per_page; line++) {
+      for (uint64_t page = 0; page < pages; page++) {
+        uint64_t pos = page * lines_per_page + line;
+        if (pos < csize) {
+          order.push_back(pos);
+        }
+      }
+    }
+    break;
+  case CHASING_TYPE::CHASING_TYPE_LINE_PER_PAGE: {
+    // A random line inside each page keeps the accesses spread over all
+    // cache sets, so the extra latency comes from the TLB and page walks.
+    std::vector<uint64_t> page_order(pages);
+    std::iota(page_order.begin(), page_order.end(), 0);
+    std::shuffle(page_order.begin() + 1, page_order.end(), gen);
+    for (uint64_t page : page_order) {
+      uint64_t lines = std::min(lines_per_page, csize - page * lines_per_page);
+      uint64_t line =
+          page == 0
+              ? 0
+              : std::uniform_int_distribution<uint64_t>(0, lines - 1)(gen);
+      order.push_back(page * lines_per_page + line);
+    }
+    break;
+  }
+  default:
+    throw std::invalid_argument("Invalid chasing type");
+  }
+  return order;
+}
+
 int PointerChasePatternsAbstract::init_chasing_index(uint64_t *cindex,
                                                      uint64_t csize,
-                                                     uint32_t thread_id) {
+                                                     uint32_t thread_id,
+                                                     CHASING_TYPE chasing_type,
+                                                     uint64_t stride_size,
+                                                     uint64_t page_size) {
   memset(cindex, 0, sizeof(uint64_t) * csize);
 
-  if (load_from_file(cindex, csize, thread_id)) {
+  std::string filename =
+      get_filename(csize, thread_id, chasing_type, stride_size, page_size);
+  if (load_from_file(cindex, csize, filename)) {
     return 0;
   }
 
-  uint64_t curr_pos = 0;
-  uint64_t next_pos = 0;
-  std::vector<bool> used(csize, false);
-
-  static thread_local std::mt19937_64 gen(std::random_device{}());
-
-  for (uint64_t i = 0; i < csize - 1; i++) {
-    if (_chasing_type == CHASING_TYPE::CHASING_TYPE_RANDOM) {
-      do {
-        next_pos = std::uniform_int_distribution<uint64_t>(0, csize - 1)(gen);
-      } while (used[next_pos] || next_pos == curr_pos);
-
-      used[next_pos] = true;
-    } else {
-      next_pos = curr_pos + 1; // Sequential chasing
-    }
-
-    cindex[curr_pos] = next_pos;
-    curr_pos = next_pos;
+  // Elements outside the order (e.g. other lines of a page in the one line
+  // per page topology) keep pointing at element 0 and are never visited.
+  std::vector<uint64_t> order =
+      generate_chasing_order(csize, chasing_type, stride_size, page_size);
+  for (uint64_t i = 0; i + 1 < order.size(); i++) {
+    cindex[order[i]] = order[i + 1];
   }
+  cindex[order.back()] = order.front();
 
-  save_to_file(cindex, csize, thread_id);
+  save_to_file(cindex, csize, filename);
   return 0;
 }
 
-void PointerChasePatternsAbstract::prepare_pointer_chaser(uint64_t *base_addr,
-                                                          uint64_t *end_add,
-                                                          uint64_t stride_size,
-                                                          uint64_t *cindex,
-                                                          uint64_t csize) {
+// Writes the chain described by cindex into the buffer. With store_address
+// every element holds the absolute address of its successor (dependent-load
+// chase); otherwise it holds the successor's index. The walk follows the
+// cycle from element 0 until it closes, which is shorter than csize when
+// the topology leaves elements out, so every link is written once.
+void PointerChasePatternsAbstract::prepare_pointer_chaser(
+    uint64_t *base_addr, uint64_t *end_add, uint64_t stride_size,
+    uint64_t *cindex, uint64_t csize, bool store_address) {
   uint64_t curr_pos = 0;
   uint64_t next_pos = 0;
   const auto start_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
                             std::chrono::system_clock::now().time_since_epoch())
                             .count();
-  for (auto i = 0; i < csize - 1; i++) {
+  for (uint64_t i = 0; i < csize; i++) {
     if (curr_pos >= csize) [[unlikely]] {
       std::cerr << "Error: curr_pos >= csize" << std::endl;
       return;
@@ -174,8 +291,16 @@ void PointerChasePatternsAbstract::prepare_pointer_chaser(uint64_t *base_addr,
       return;
     }
     next_pos = cindex[curr_pos];
-    *curr_addr = next_pos;
+    if (store_address) {
+      *curr_addr = reinterpret_cast<uint64_t>(
+          base_addr + next_pos * stride_size / sizeof(uint64_t));
+    } else {
+      *curr_addr = next_pos;
+    }
     curr_pos = next_pos;
+    if (curr_pos == 0) {
+      break;
+    }
 
     // Check for timeout
     if (rand() % 10000 == 0) [[unlikely]] {
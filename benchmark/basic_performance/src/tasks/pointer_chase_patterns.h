@@ -31,6 +31,9 @@
 #include <core/system_define.h>
 #include <cstdint>
 #include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 using PcLdSTFunc = std::function<void(
     uint64_t *base_addr, uint64_t region_size, uint64_t stride_size,
@@ -42,25 +45,53 @@ public:
   PointerChasePatternsAbstract();
   ~PointerChasePatternsAbstract() = default;
 
+  // Lower bound on the hops timed per repeat by the dependent-load chase so
+  // that the two clock reads around it are negligible.
+  static constexpr uint64_t MIN_DEPENDENT_CHASE_HOPS = 1ULL << 22;
+
   PcLdSTFunc get(LoadStoreType ldst_type);
+  uint64_t get_access_count(LoadStoreType ldst_type, uint64_t region_size,
+                            uint64_t block_size);
 
-  int init_chasing_index(uint64_t *cindex, uint64_t csize, uint32_t thread_id);
+  // page_size is the size of the pages backing the chased buffer, which the
+  // page-granular topologies walk.
+  int init_chasing_index(uint64_t *cindex, uint64_t csize, uint32_t thread_id,
+                         CHASING_TYPE chasing_type, uint64_t stride_size,
+                         uint64_t page_size);
   void prepare_pointer_chaser(uint64_t *base_addr, uint64_t *end_addr,
                               uint64_t stride_size, uint64_t *cindex,
-                              uint64_t csize);
+                              uint64_t csize, bool store_address);
 
 private:
+  static constexpr uint64_t CHASE_REGION_SIZE = 2 * MEMUNIT::MiB;
+
   std::unordered_map<LoadStoreType, PcLdSTFunc> _func_map;
-  CHASING_TYPE _chasing_type;
-  void load(uint64_t *base_addr, uint64_t region_size, uint64_t stride_size,
-            uint64_t region_skip, uint64_t block_size, uint64_t repeat,
-            uint64_t *cindex, uint64_t *timing_load);
-  void store(uint64_t *base_addr, uint64_t region_size, uint64_t stride_size,
-             uint64_t region_skip, uint64_t block_size, uint64_t repeat,
-             uint64_t *cindex, uint64_t *timing_store);
-  std::string get_filename(uint64_t csize, uint32_t thread_id);
-  bool load_from_file(uint64_t *cindex, uint64_t csize, uint32_t thread_id);
-  void save_to_file(const uint64_t *cindex, uint64_t csize, uint32_t thread_id);
+  template <typename TimerT>
+  void dependent_load(uint64_t *base_addr, uint64_t region_size,
+                      uint64_t stride_size, uint64_t region_skip,
+                      uint64_t block_size, uint64_t repeat, uint64_t *cindex,
+                      uint64_t *timing_load);
+  template <typename TimerT>
+  void load_with_flush(uint64_t *base_addr, uint64_t region_size,
+                       uint64_t stride_size, uint64_t region_skip,
+                       uint64_t block_size, uint64_t repeat, uint64_t *cindex,
+                       uint64_t *timing_load);
+  template <typename TimerT>
+  void store_with_flush(uint64_t *base_addr, uint64_t region_size,
+                        uint64_t stride_size, uint64_t region_skip,
+                        uint64_t block_size, uint64_t repeat, uint64_t *cindex,
+                        uint64_t *timing_store);
+  std::vector<uint64_t> generate_chasing_order(uint64_t csize,
+                                               CHASING_TYPE chasing_type,
+                                               uint64_t stride_size,
+                                               uint64_t page_size);
+  std::string get_filename(uint64_t csize, uint32_t thread_id,
+                           CHASING_TYPE chasing_type, uint64_t stride_size,
+                           uint64_t page_size);
+  bool load_from_file(uint64_t *cindex, uint64_t csize,
+                      const std::string &filename);
+  void save_to_file(const uint64_t *cindex, uint64_t csize,
+                    const std::string &filename);
 };
 
 #endif // CXL_PERF_APP_DT_POINTER_CHASE_PATTERNS_H
@@ -34,26 +34,26 @@ StridePattern::StridePattern() {
   _func_map[LoadStoreType::LOAD] =
       [this](uint8_t *start_addr, uint64_t size, uint64_t skip, uint64_t delay,
              uint64_t count, uint64_t block_size, uint64_t *time_log) {
-        this->stride_load(start_addr, size, skip, delay, count, block_size,
-                          time_log);
+        this->stride_load<Timer>(start_addr, size, skip, delay, count,
+                                 block_size, time_log);
       };
   _func_map[LoadStoreType::LOAD_WITH_FLUSH] =
       [this](uint8_t *start_addr, uint64_t size, uint64_t skip, uint64_t delay,
              uint64_t count, uint64_t block_size, uint64_t *time_log) {
-        this->stride_load_with_flush(start_addr, size, skip, delay, count,
-                                     block_size, time_log);
+        this->stride_load_with_flush<CycleTimer>(
+            start_addr, size, skip, delay, count, block_size, time_log);
       };
   _func_map[LoadStoreType::STORE] =
       [this](uint8_t *start_addr, uint64_t size, uint64_t skip, uint64_t delay,
              uint64_t count, uint64_t block_size, uint64_t *time_log) {
-        this->stride_store(start_addr, size, skip, delay, count, block_size,
-                           time_log);
+        this->stride_store<Timer>(start_addr, size, skip, delay, count,
+                                  block_size, time_log);
       };
   _func_map[LoadStoreType::STORE_WITH_FLUSH] =
       [this](uint8_t *start_addr, uint64_t size, uint64_t skip, uint64_t delay,
              uint64_t count, uint64_t block_size, uint64_t *time_log) {
-        this->stride_store_with_flush(start_addr, size, skip, delay, count,
-                                      block_size, time_log);
+        this->stride_store_with_flush<CycleTimer>(
+            start_addr, size, skip, delay, count, block_size, time_log);
       };
 }
 
@@ -65,10 +65,11 @@ StrideFunc StridePattern::get(LoadStoreType type) {
   return it->second;
 }
 
+template <typename TimerT>
 void StridePattern::stride_load(uint8_t *start_addr, uint64_t size,
                                 uint64_t skip, uint64_t delay, uint64_t count,
                                 uint64_t block_size, uint64_t *time_log) {
-  Timer timer;
+  TimerT timer;
   long i = 0, offset = 0;
   _func = get_load_func(block_size);
   *time_log = 0;
@@ -82,12 +83,13 @@ void StridePattern::stride_load(uint8_t *start_addr, uint64_t size,
   *time_log = timer.elapsed();
 }
 
+template <typename TimerT>
 void StridePattern::stride_load_with_flush(uint8_t *start_addr, uint64_t size,
                                            uint64_t skip, uint64_t delay,
                                            uint64_t count, uint64_t block_size,
                                            uint64_t *time_log) {
   long i = 0, offset = 0;
-  Timer timer;
+  TimerT timer;
   *time_log = 0;
   while (i < count) {
     uint8_t *test_addr = start_addr + offset;
@@ -97,10 +99,11 @@ void StridePattern::stride_load_with_flush(uint8_t *start_addr, uint64_t size,
   }
 }
 
+template <typename TimerT>
 void StridePattern::stride_store(uint8_t *start_addr, uint64_t size,
                                  uint64_t skip, uint64_t delay, uint64_t count,
                                  uint64_t block_size, uint64_t *time_log) {
-  Timer timer;
+  TimerT timer;
   long i = 0, offset = 0;
   _func = get_store_func(block_size);
   *time_log = 0;
@@ -114,12 +117,13 @@ void StridePattern::stride_store(uint8_t *start_addr, uint64_t size,
   *time_log = timer.elapsed();
 }
 
+template <typename TimerT>
 void StridePattern::stride_store_with_flush(uint8_t *start_addr, uint64_t size,
                                             uint64_t skip, uint64_t delay,
                                             uint64_t count, uint64_t block_size,
                                             uint64_t *time_log) {
   long i = 0, offset = 0;
-  Timer timer;
+  TimerT timer;
   *time_log = 0;
   while (i < count) {
     uint8_t *test_addr = start_addr + offset;
@@ -43,15 +43,19 @@ public:
 
 private:
   std::unordered_map<LoadStoreType, StrideFunc> _func_map;
+  template <typename TimerT>
   void stride_load(uint8_t *start_addr, uint64_t size, uint64_t skip,
                    uint64_t delay, uint64_t count, uint64_t block_size,
                    uint64_t *time_log);
+  template <typename TimerT>
   void stride_load_with_flush(uint8_t *start_addr, uint64_t size, uint64_t skip,
                               uint64_t delay, uint64_t count,
                               uint64_t block_size, uint64_t *time_log);
+  template <typename TimerT>
   void stride_store(uint8_t *start_addr, uint64_t size, uint64_t skip,
                     uint64_t delay, uint64_t count, uint64_t block_size,
                     uint64_t *time_log);
+  template <typename TimerT>
   void stride_store_with_flush(uint8_t *start_addr, uint64_t size,
                                uint64_t skip, uint64_t delay, uint64_t count,
                                uint64_t block_size, uint64_t *time_log);
@@ -0,0 +1,194 @@
+/*
+ *
+ * MIT License
+ *
+ * Copyright (c) 2025 Jangseon Park
+ * Affiliation: University of California San Diego CSE
+ * Email: jap036@ucsd.edu
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <utils/convergence.h>
+
+void ConvergenceController::configure(double target, double time_cap_sec,
+                                      uint32_t min_batches,
+                                      ConvergenceStatistic statistic) {
+  _target = target;
+  _time_cap = std::chrono::nanoseconds(
+      static_cast<int64_t>(time_cap_sec * 1e9));
+  _min_batches = std::max<uint32_t>(min_batches, 2);
+  _statistic = statistic;
+}
+
+ConvergenceStatistic ConvergenceController::statistic() const {
+  return enabled() ? _statistic : ConvergenceStatistic::MEAN;
+}
+
+void ConvergenceController::start() {
+  _start_time = std::chrono::steady_clock::now();
+  _samples.clear();
+  if (statistic() == ConvergenceStatistic::MEDIAN) {
+    _samples.reserve(MAX_SAMPLES);
+  }
+  _sample_stride = 1;
+  _count = 0;
+  _mean = 0;
+  _m2 = 0;
+  _converged = false;
+  _time_capped = false;
+  _next_check = 0;
+}
+
+void ConvergenceController::add(double sample) {
+  _count++;
+  // Welford's running mean and variance
+  double delta = sample - _mean;
+  _mean += delta / _count;
+  _m2 += delta * (sample - _mean);
+  if (statistic() != ConvergenceStatistic::MEDIAN ||
+      (_count - 1) % _sample_stride != 0) {
+    return;
+  }
+  if (_samples.size() == MAX_SAMPLES) {
+    for (size_t i = 0; i < MAX_SAMPLES / 2; i++) {
+      _samples[i] = _samples[2 * i];
+    }
+    _samples.resize(MAX_SAMPLES / 2);
+    _sample_stride *= 2;
+    if ((_count - 1) % _sample_stride != 0) {
+      return;
+    }
+  }
+  _samples.push_back(sample);
+}
+
+// Two-sided 95% critical values of Student's t for 1..30 degrees of freedom
+double ConvergenceController::t_critical(uint64_t dof) {
+  static const double table[] = {
+      12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+      2.201,  2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+      2.080,  2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042};
+  if (dof == 0) {
+    return INFINITY;
+  } else if (dof <= 30) {
+    return table[dof - 1];
+  }
+  return 1.96 + 2.4 / dof;
+}
+
+std::pair<double, double> ConvergenceController::interval() const {
+  uint64_t n = _count;
+  if (n < 2) {
+    return {_mean, _mean};
+  }
+  if (statistic() == ConvergenceStatistic::MEAN) {
+    double half =
+        t_critical(n - 1) * std::sqrt(_m2 / (n - 1)) / std::sqrt(double(n));
+    return {_mean - half, _mean + half};
+  }
+  // Distribution-free interval: the order statistics around the median
+  // whose ranks are n/2 -/+ 1.96 * sqrt(n) / 2, over the kept samples
+  n = _samples.size();
+  std::vector<double> sorted(_samples);
+  std::sort(sorted.begin(), sorted.end());
+  double spread = 1.96 * std::sqrt(double(n)) / 2;
+  auto low = static_cast<int64_t>(std::floor(n / 2.0 - spread));
+  auto high = static_cast<int64_t>(std::ceil(n / 2.0 + spread));
+  return {sorted[std::clamp<int64_t>(low, 0, n - 1)],
+          sorted[std::clamp<int64_t>(high, 0, n - 1)]};
+}
+
+bool ConvergenceController::done() {
+  if (!enabled() || _converged || _time_capped) {
+    return _converged || _time_capped;
+  }
+  if (std::chrono::steady_clock::now() - _start_time >= _time_cap) {
+    _time_capped = true;
+    return true;
+  }
+  // Recomputing the interval is O(n log n) for the median, so it is only
+  // checked after the sample count grew by ~10%.
+  uint64_t n = _count;
+  if (n < _min_batches || n < _next_check) {
+    return false;
+  }
+  _next_check = std::max<uint64_t>(n + 1, n + n / 10);
+  _converged = relative_half_width() <= _target;
+  return _converged;
+}
+
+double ConvergenceController::estimate() const {
+  if (statistic() == ConvergenceStatistic::MEAN || _samples.empty()) {
+    return _mean;
+  }
+  std::vector<double> sorted(_samples);
+  auto mid = sorted.begin() + sorted.size() / 2;
+  std::nth_element(sorted.begin(), mid, sorted.end());
+  return *mid;
+}
+
+double ConvergenceController::relative_half_width() const {
+  double center = estimate();
+  if (center == 0) {
+    return INFINITY;
+  }
+  auto [low, high] = interval();
+  return (high - low) / 2 / std::fabs(center);
+}
+
+// e.g. "mean 163.20 ns, 95% CI [162.10, 164.30] (+/-0.67%), 12 batches,
+// converged"
+std::string ConvergenceController::describe(const std::string &unit) const {
+  auto [low, high] = interval();
+  char buf[256];
+  snprintf(buf, sizeof(buf),
+           "%s %.2f %s, 95%% CI [%.2f, %.2f] (+/-%.2f%%), %zu batches",
+           statistic() == ConvergenceStatistic::MEAN ? "mean" : "median",
+           estimate(), unit.c_str(), low, high,
+           relative_half_width() * 100, _count);
+  std::string msg = buf;
+  if (enabled()) {
+    msg += _converged     ? ", converged"
+           : _time_capped ? ", time cap reached"
+                          : ", stopped";
+  }
+  return msg;
+}
+
+JsonObject ConvergenceController::to_json() const {
+  auto [low, high] = interval();
+  JsonObject json;
+  json.add("statistic",
+           statistic() == ConvergenceStatistic::MEAN ? "mean" : "median")
+      .add("estimate", estimate())
+      .add("ci_low", low)
+      .add("ci_high", high)
+      .add("confidence", 0.95)
+      .add("relative_half_width", relative_half_width())
+      .add("batches", count())
+      .add("target", _target)
+      .add("converged", _converged)
+      .add("time_capped", _time_capped);
+  return json;
+}
@@ -0,0 +1,92 @@
+/*
+ *
+ * MIT License
+ *
+ * Copyright (c) 2025 Jangseon Park
+ * Affiliation: University of California San Diego CSE
+ * Email: jap036@ucsd.edu
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef CXL_PERF_APP_CONVERGENCE_H
+#define CXL_PERF_APP_CONVERGENCE_H
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <utils/json_object.h>
+#include <vector>
+
+enum class ConvergenceStatistic : uint32_t { MEAN = 0, MEDIAN = 1 };
+
+// Collects one sample per batch and computes a 95% confidence interval on
+// the mean (Student's t) or the median (order statistics). With a target
+// set, done() tells the caller to stop once the relative half-width of the
+// interval is below the target, or once the time cap is hit.
+//
+// The mean only keeps Welford's running state. The median keeps the raw
+// samples in a buffer reserved by start(); once it is full every other
+// sample is dropped and only every second one is kept from then on, so the
+// buffer stays a uniform subsample of the batches. Without a target the
+// median is not tracked and the mean is reported.
+class ConvergenceController {
+public:
+  ConvergenceController() = default;
+
+  void configure(double target, double time_cap_sec, uint32_t min_batches,
+                 ConvergenceStatistic statistic);
+  void start();
+  void add(double sample);
+  bool done();
+
+  bool enabled() const { return _target > 0; }
+  std::chrono::nanoseconds time_cap() const { return _time_cap; }
+  bool converged() const { return _converged; }
+  uint64_t count() const { return _count; }
+  double estimate() const;
+  std::pair<double, double> interval() const;
+  double relative_half_width() const;
+  std::string describe(const std::string &unit) const;
+  JsonObject to_json() const;
+
+private:
+  double _target = 0;
+  std::chrono::nanoseconds _time_cap{0};
+  uint32_t _min_batches = 5;
+  ConvergenceStatistic _statistic = ConvergenceStatistic::MEAN;
+
+  static constexpr size_t MAX_SAMPLES = 1 << 16;
+
+  std::chrono::steady_clock::time_point _start_time;
+  std::vector<double> _samples; // median only
+  uint64_t _sample_stride = 1;
+  uint64_t _count = 0;
+  double _mean = 0;
+  double _m2 = 0;
+  bool _converged = false;
+  bool _time_capped = false;
+  uint64_t _next_check = 0;
+
+  ConvergenceStatistic statistic() const;
+  static double t_critical(uint64_t dof);
+};
+
+#endif // CXL_PERF_APP_CONVERGENCE_H
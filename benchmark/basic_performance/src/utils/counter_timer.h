@@ -0,0 +1,105 @@
+/*
+ *
+ * MIT License
+ *
+ * Copyright (c) 2025 Jangseon Park
+ * Affiliation: University of California San Diego CSE
+ * Email: jap036@ucsd.edu
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef CXL_PERF_APP_COUNTER_TIMER_H
+#define CXL_PERF_APP_COUNTER_TIMER_H
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <utils/timer.h>
+
+// Timer backed by a machine cycle counter. Counter provides always-inline
+// `static uint64_t start()`, `static uint64_t stop()` and `static const char
+// *name()`. Conversion to nanoseconds and the counter's own read-to-read
+// overhead are measured once against CLOCK_MONOTONIC, so start()/elapsed()
+// compile down to two counter reads and a multiply. start() and
+// elapsed_cycles() are forced inline so the O0 measurement loops time the
+// same code the overhead is calibrated on.
+template <typename Counter> class CounterTimer {
+public:
+  CounterTimer() : _start(0) { calibrate(); }
+  ~CounterTimer() = default;
+
+  inline __attribute__((always_inline)) void start() {
+    _start = Counter::start();
+  }
+
+  inline __attribute__((always_inline)) uint64_t elapsed_cycles() {
+    uint64_t cycles = raw_cycles();
+    return cycles > _overhead_cycles ? cycles - _overhead_cycles : 0;
+  }
+
+  inline __attribute__((always_inline)) double elapsed() {
+    return elapsed_cycles() * _ns_per_cycle;
+  }
+
+  static void calibrate() {
+    static std::once_flag calibrated;
+    std::call_once(calibrated, []() {
+      Timer wall;
+      uint64_t begin = Counter::start();
+      wall.start();
+      double wall_ns = 0;
+      while (wall_ns < CALIBRATION_NS) {
+        wall_ns = wall.elapsed();
+      }
+      uint64_t end = Counter::stop();
+      _ns_per_cycle = wall_ns / static_cast<double>(end - begin);
+
+      // through the member path of the measurement loops, _start
+      // included
+      CounterTimer timer(0);
+      uint64_t overhead = std::numeric_limits<uint64_t>::max();
+      for (int i = 0; i < OVERHEAD_SAMPLES; i++) {
+        timer.start();
+        overhead = std::min(overhead, timer.raw_cycles());
+      }
+      _overhead_cycles = overhead;
+    });
+  }
+
+  static const char *name() { return Counter::name(); }
+  static double ns_per_cycle() { return _ns_per_cycle; }
+  static uint64_t overhead_cycles() { return _overhead_cycles; }
+
+private:
+  // calibrating instance
+  explicit CounterTimer(uint64_t start) : _start(start) {}
+
+  inline __attribute__((always_inline)) uint64_t raw_cycles() {
+    return Counter::stop() - _start;
+  }
+
+  static constexpr double CALIBRATION_NS = 50e6;
+  static constexpr int OVERHEAD_SAMPLES = 10000;
+  static inline double _ns_per_cycle = 1.0;
+  static inline uint64_t _overhead_cycles = 0;
+  uint64_t _start;
+};
+#endif // CXL_PERF_APP_COUNTER_TIMER_H
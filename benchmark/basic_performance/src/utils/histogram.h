@@ -0,0 +1,153 @@
+/*
+ *
+ * MIT License
+ *
+ * Copyright (c) 2025 Jangseon Park
+ * Affiliation: University of California San Diego CSE
+ * Email: jap036@ucsd.edu
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef CXL_PERF_APP_HISTOGRAM_H
+#define CXL_PERF_APP_HISTOGRAM_H
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <utils/json_object.h>
+#include <vector>
+
+// Log-linear histogram: every power of two is split into 2^SUB_BITS equal
+// buckets, so values are kept with a relative error below 1/2^SUB_BITS at a
+// fixed 4 KiB footprint and O(1) record().
+class Histogram {
+public:
+  static constexpr uint32_t SUB_BITS = 3;
+  static constexpr uint32_t SUB_BUCKETS = 1 << SUB_BITS;
+  static constexpr uint32_t NUM_BUCKETS = 64 * SUB_BUCKETS;
+
+  explicit Histogram(std::string unit = "") : _unit(std::move(unit)) {
+    reset();
+  }
+
+  void reset() {
+    _buckets.fill(0);
+    _count = 0;
+    _sum = 0;
+    _min = std::numeric_limits<uint64_t>::max();
+    _max = 0;
+  }
+
+  void set_unit(const std::string &unit) { _unit = unit; }
+  const std::string &unit() const { return _unit; }
+
+  inline void record(uint64_t value) {
+    _buckets[bucket_of(value)]++;
+    _count++;
+    _sum += value;
+    _min = std::min(_min, value);
+    _max = std::max(_max, value);
+  }
+
+  uint64_t count() const { return _count; }
+  uint64_t min() const { return _count ? _min : 0; }
+  uint64_t max() const { return _max; }
+  double mean() const {
+    return _count ? static_cast<double>(_sum) / _count : 0;
+  }
+
+  // Upper bound of the bucket holding the p-th percentile (0 < p <= 100),
+  // clamped to the largest recorded value.
+  uint64_t percentile(double p) const {
+    if (_count == 0) {
+      return 0;
+    }
+    uint64_t rank = static_cast<uint64_t>(p / 100.0 * _count + 0.5);
+    rank = std::clamp<uint64_t>(rank, 1, _count);
+    uint64_t seen = 0;
+    for (uint32_t i = 0; i < NUM_BUCKETS; i++) {
+      seen += _buckets[i];
+      if (seen >= rank) {
+        return std::clamp(bucket_upper(i), min(), _max);
+      }
+    }
+    return _max;
+  }
+
+  JsonObject to_json() const {
+    JsonObject json;
+    json.add("unit", _unit)
+        .add("count", _count)
+        .add("min", min())
+        .add("max", _max)
+        .add("mean", mean())
+        .add("p50", percentile(50))
+        .add("p90", percentile(90))
+        .add("p99", percentile(99))
+        .add("p999", percentile(99.9));
+    // Non-empty buckets as [lower, upper, count]
+    std::vector<std::vector<uint64_t>> buckets;
+    for (uint32_t i = 0; i < NUM_BUCKETS; i++) {
+      if (_buckets[i] != 0) {
+        buckets.push_back({bucket_lower(i), bucket_upper(i), _buckets[i]});
+      }
+    }
+    json.add("buckets", buckets);
+    return json;
+  }
+
+private:
+  std::string _unit;
+  std::array<uint64_t, NUM_BUCKETS> _buckets;
+  uint64_t _count;
+  uint64_t _sum;
+  uint64_t _min;
+  uint64_t _max;
+
+  static inline uint32_t bucket_of(uint64_t value) {
+    if (value < SUB_BUCKETS) {
+      return static_cast<uint32_t>(value);
+    }
+    uint32_t msb = 63 - __builtin_clzll(value);
+    uint32_t sub = (value >> (msb - SUB_BITS)) & (SUB_BUCKETS - 1);
+    return (msb - SUB_BITS + 1) * SUB_BUCKETS + sub;
+  }
+
+  static uint64_t bucket_lower(uint32_t bucket) {
+    if (bucket < SUB_BUCKETS) {
+      return bucket;
+    }
+    uint32_t msb = bucket / SUB_BUCKETS + SUB_BITS - 1;
+    uint64_t sub = bucket % SUB_BUCKETS;
+    return (1ULL << msb) | (sub << (msb - SUB_BITS));
+  }
+
+  static uint64_t bucket_upper(uint32_t bucket) {
+    if (bucket < SUB_BUCKETS) {
+      return bucket;
+    }
+    uint32_t msb = bucket / SUB_BUCKETS + SUB_BITS - 1;
+    return bucket_lower(bucket) + (1ULL << (msb - SUB_BITS)) - 1;
+  }
+};
+
+#endif // CXL_PERF_APP_HISTOGRAM_H
@@ -27,6 +27,7 @@
  */
 
 #include <iostream>
+#include <stdexcept>
 #include <utils/input_parser.h>
 #include <yaml-cpp/yaml.h>
 
@@ -84,6 +85,40 @@ std::shared_ptr<JobInfo> InputParserForBW::parse(const fs::path &input_file) {
   job_info->pattern_iteration = yaml_file["pattern_iteration"].as<uint32_t>();
   job_info->thread_buffer_size =
       yaml_file["thread_buffer_size"].as<uint64_t>() * MEMUNIT::MiB;
+  job_info->chasing_type =
+      yaml_file["chasing_type"]
+          ? static_cast<CHASING_TYPE>(yaml_file["chasing_type"].as<uint32_t>())
+          : CHASING_TYPE::CHASING_TYPE_RANDOM;
+  if (job_info->chasing_type >= CHASING_TYPE::CHASING_TYPE_MAX) {
+    throw std::runtime_error(
+        "chasing_type needs to be below " +
+        std::to_string(static_cast<uint32_t>(CHASING_TYPE::CHASING_TYPE_MAX)));
+  }
+  job_info->page_size_type =
+      yaml_file["page_size_type"]
+          ? static_cast<PageSizeType>(
+                yaml_file["page_size_type"].as<uint32_t>())
+          : PageSizeType::PAGE_4K;
+  job_info->perf_events = yaml_file["perf_events"]
+                              ? yaml_file["perf_events"].as<std::string>()
+                              : "";
+  job_info->convergence_target =
+      yaml_file["convergence_target_ci"]
+          ? yaml_file["convergence_target_ci"].as<double>()
+          : 0;
+  job_info->convergence_time_cap =
+      yaml_file["convergence_time_cap"]
+          ? yaml_file["convergence_time_cap"].as<double>()
+          : 10;
+  job_info->convergence_min_batches =
+      yaml_file["convergence_min_batches"]
+          ? yaml_file["convergence_min_batches"].as<uint32_t>()
+          : 5;
+  job_info->convergence_statistic =
+      yaml_file["convergence_statistic"]
+          ? static_cast<ConvergenceStatistic>(
+                yaml_file["convergence_statistic"].as<uint32_t>())
+          : ConvergenceStatistic::MEAN;
   std::cout << "Job ID: " << static_cast<uint32_t>(job_info->job_id) << "\n";
   return job_info;
 }
@@ -110,25 +145,73 @@ std::tuple<std::string, std::string> InputParserForCache::parse(int argc,
   return std::tuple<std::string, std::string>(script_path, output_path);
 }
 
+// Accepts either a single value or a list for a sweep parameter.
+static std::vector<uint64_t> as_list(const YAML::Node &node) {
+  if (node.IsSequence()) {
+    return node.as<std::vector<uint64_t>>();
+  }
+  return {node.as<uint64_t>()};
+}
+
+// stride_size/block_num (or the stride_size_array/block_num_array lists of
+// a whole heatmap), flush_type and ldst_type are expanded into points that
+// run in one session. Points are ordered by block_num so consecutive points
+// share the chasing index, and points that do not fit in test_size are
+// dropped.
 void InputParserForCache::parse(const fs::path &input_file,
-  pchasing_args_t *args) {
+                                CacheTestInfo *info) {
+  pchasing_args_t *args = &info->args;
+  std::vector<pchasing_point_t> *points = &info->points;
   YAML::Node yaml_file = YAML::LoadFile(input_file.string());
   std::cout << "Parsing the input file: " << input_file << "\n";
   args->in_repeat = yaml_file["repeat"].as<uint64_t>();
-  args->in_core_id = yaml_file["core_id"].as<uint64_t>();
+  info->core_ids = as_list(yaml_file["core_id"]);
+  if (info->core_ids.empty() || info->core_ids.size() > PCH_MAX_CORES) {
+    throw std::runtime_error("core_id needs 1 to " +
+                             std::to_string(PCH_MAX_CORES) + " cores");
+  }
+  args->in_core_id = info->core_ids.front();
   args->in_node_id = yaml_file["node_id"].as<uint64_t>();
   args->in_use_flush = yaml_file["use_flush"].as<uint64_t>();
   args->in_access_order = yaml_file["access_order"].as<uint64_t>();
   args->in_dimm_start_addr_phys = yaml_file["dimm_start_addr_phys"].as<uint64_t>();
   args->in_cxl_start_addr_phys = yaml_file["cxl_start_addr_phys"].as<uint64_t>();
   args->in_test_size = yaml_file["test_size"].as<uint64_t>();
-  args->in_stride_size = yaml_file["stride_size"].as<uint64_t>();
-  args->in_block_num = yaml_file["block_num"].as<uint64_t>();
   args->in_test_size = yaml_file["test_size"].as<uint64_t>();
   args->in_socket_num = yaml_file["socket_num"].as<uint64_t>();
   args->in_snc_mode = yaml_file["snc_mode"].as<uint64_t>();
-  args->in_flush_type = yaml_file["flush_type"].as<uint64_t>();
-  args->in_ldst_type = yaml_file["ldst_type"].as<uint64_t>();
   args->in_test_type = yaml_file["test_type"].as<uint64_t>();
+  info->engine = static_cast<CacheEngine>(
+      yaml_file["engine"] ? yaml_file["engine"].as<uint32_t>() : 0);
+  info->sample_interval = yaml_file["sample_interval"]
+                              ? yaml_file["sample_interval"].as<uint64_t>()
+                              : 0;
+
+  auto strides = as_list(yaml_file["stride_size_array"]
+                             ? yaml_file["stride_size_array"]
+                             : yaml_file["stride_size"]);
+  auto blocks = as_list(yaml_file["block_num_array"]
+                            ? yaml_file["block_num_array"]
+                            : yaml_file["block_num"]);
+  auto flush_types = as_list(yaml_file["flush_type"]);
+  auto ldst_types = as_list(yaml_file["ldst_type"]);
+  points->clear();
+  for (uint64_t block_num : blocks) {
+    for (uint64_t stride_size : strides) {
+      if (block_num * stride_size >= args->in_test_size) {
+        continue;
+      }
+      for (uint64_t flush_type : flush_types) {
+        for (uint64_t ldst_type : ldst_types) {
+          pchasing_point_t point = {};
+          point.in_stride_size = stride_size;
+          point.in_block_num = block_num;
+          point.in_flush_type = flush_type;
+          point.in_ldst_type = ldst_type;
+          points->push_back(point);
+        }
+      }
+    }
+  }
   std::cout << "Input file parsed successfully\n";
 }
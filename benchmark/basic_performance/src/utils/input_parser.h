@@ -58,7 +58,7 @@ public:
   ~InputParserForCache() = default;
 
   std::tuple<std::string, std::string> parse(int argc, char *argv[]) override;
-  void parse(const fs::path &input_file, pchasing_args_t *args);
+  void parse(const fs::path &input_file, CacheTestInfo *info);
 };
 
 #endif // CXL_PERF_APP_DT_INPUT_PARSER_H
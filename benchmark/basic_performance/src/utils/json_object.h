@@ -0,0 +1,116 @@
+/*
+ *
+ * MIT License
+ *
+ * Copyright (c) 2025 Jangseon Park
+ * Affiliation: University of California San Diego CSE
+ * Email: jap036@ucsd.edu
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef CXL_PERF_APP_JSON_OBJECT_H
+#define CXL_PERF_APP_JSON_OBJECT_H
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// Builds a single JSON object in insertion order. Only what the result files
+// need: strings, numbers, booleans, nested objects and arrays of them.
+class JsonObject {
+public:
+  template <typename T>
+  JsonObject &add(const std::string &key, const T &value) {
+    append_key(key);
+    _body += to_json(value);
+    return *this;
+  }
+
+  bool empty() const { return _body.empty(); }
+  std::string str() const { return "{" + _body + "}"; }
+
+  static std::string escape(const std::string &value) {
+    std::string out = "\"";
+    for (char c : value) {
+      switch (c) {
+      case '"':
+        out += "\\\"";
+        break;
+      case '\\':
+        out += "\\\\";
+        break;
+      case '\n':
+        out += "\\n";
+        break;
+      case '\t':
+        out += "\\t";
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          char buf[8];
+          snprintf(buf, sizeof(buf), "\\u%04x", c);
+          out += buf;
+        } else {
+          out += c;
+        }
+      }
+    }
+    return out + "\"";
+  }
+
+private:
+  std::string _body;
+
+  void append_key(const std::string &key) {
+    if (!_body.empty()) {
+      _body += ",";
+    }
+    _body += escape(key) + ":";
+  }
+
+  template <typename T> static std::string to_json(const T &value) {
+    if constexpr (std::is_same_v<T, bool>) {
+      return value ? "true" : "false";
+    } else if constexpr (std::is_floating_point_v<T>) {
+      if (!std::isfinite(value)) {
+        return "null";
+      }
+      char buf[32];
+      snprintf(buf, sizeof(buf), "%.17g", static_cast<double>(value));
+      return buf;
+    } else if constexpr (std::is_arithmetic_v<T>) {
+      return std::to_string(value);
+    } else if constexpr (std::is_same_v<T, JsonObject>) {
+      return value.str();
+    } else if constexpr (std::is_convertible_v<T, std::string>) {
+      return escape(value);
+    } else {
+      std::string out = "[";
+      for (const auto &item : value) {
+        out += (out.size() > 1 ? "," : "") + to_json(item);
+      }
+      return out + "]";
+    }
+  }
+};
+
+#endif // CXL_PERF_APP_JSON_OBJECT_H
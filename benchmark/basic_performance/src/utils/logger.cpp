@@ -26,8 +26,61 @@
  *
  */
 
+#include <algorithm>
+#include <cstring>
 #include <iostream>
 #include <utils/logger.h>
+#include <utils/timer.h>
+
+static thread_local LogBuffer *thread_buffer = nullptr;
+
+LogBuffer::LogBuffer(size_t capacity) : _data(capacity), _head(0), _tail(0) {}
+
+void LogBuffer::copy_in(uint64_t pos, const void *src, size_t len) {
+  size_t offset = pos & (_data.size() - 1);
+  size_t first = std::min(len, _data.size() - offset);
+  std::memcpy(_data.data() + offset, src, first);
+  std::memcpy(_data.data(), static_cast<const char *>(src) + first,
+              len - first);
+}
+
+void LogBuffer::copy_out(uint64_t pos, void *dst, size_t len) const {
+  size_t offset = pos & (_data.size() - 1);
+  size_t first = std::min(len, _data.size() - offset);
+  std::memcpy(dst, _data.data() + offset, first);
+  std::memcpy(static_cast<char *>(dst) + first, _data.data(), len - first);
+}
+
+bool LogBuffer::try_push(double timestamp, std::string_view message) {
+  uint64_t head = _head.load(std::memory_order_relaxed);
+  uint64_t tail = _tail.load(std::memory_order_acquire);
+  size_t need = sizeof(LogRecordHeader) + message.size();
+  if (_data.size() - (head - tail) < need) {
+    return false;
+  }
+  LogRecordHeader header{timestamp, message.size()};
+  copy_in(head, &header, sizeof(header));
+  copy_in(head + sizeof(header), message.data(), message.size());
+  _head.store(head + need, std::memory_order_release);
+  return true;
+}
+
+// Formats every pending record as "[elapsed]message\n" into out
+void LogBuffer::drain(std::string &out) {
+  uint64_t tail = _tail.load(std::memory_order_relaxed);
+  uint64_t head = _head.load(std::memory_order_acquire);
+  while (tail < head) {
+    LogRecordHeader header;
+    copy_out(tail, &header, sizeof(header));
+    out += "[" + std::to_string(header.timestamp) + "]";
+    size_t pos = out.size();
+    out.resize(pos + header.length);
+    copy_out(tail + sizeof(header), out.data() + pos, header.length);
+    out += "\n";
+    tail += sizeof(header) + header.length;
+  }
+  _tail.store(tail, std::memory_order_release);
+}
 
 Logger &Logger::get_instance() {
   static Logger logger;
@@ -42,17 +95,107 @@ void Logger::open(const fs::path &file_path) {
   _file_path += "/result.log";
   std::cout << "Log file path: " << _file_path << std::endl;
   _file.open(_file_path, std::ios::out);
-  _timer.start();
+  _start_time = std::chrono::steady_clock::now();
+  if (!_running.exchange(true)) {
+    _writer = std::thread(&Logger::run_writer, this);
+  }
+}
+
+LogBuffer *Logger::get_thread_buffer() {
+  if (thread_buffer == nullptr) {
+    std::lock_guard<std::mutex> lock(_buffers_mutex);
+    _buffers.push_back(std::make_unique<LogBuffer>(BUFFER_SIZE));
+    thread_buffer = _buffers.back().get();
+  }
+  return thread_buffer;
+}
+
+void Logger::append(std::string_view message) {
+  double timestamp = std::chrono::duration<double, std::nano>(
+                         std::chrono::steady_clock::now() - _start_time)
+                         .count();
+  LogBuffer *buffer = get_thread_buffer();
+  if (!_running ||
+      sizeof(double) + sizeof(uint64_t) + message.size() >
+          buffer->capacity()) {
+    // No writer yet, or a record that can never fit: keep the order of
+    // what is already queued and write it synchronously.
+    flush();
+    write_direct("[" + std::to_string(timestamp) + "]" +
+                 std::string(message) + "\n");
+    return;
+  }
+  while (!buffer->try_push(timestamp, message)) {
+    _writer_cv.notify_one();
+    std::this_thread::yield();
+  }
+  _pending.fetch_add(1, std::memory_order_release);
+}
+
+void Logger::write_direct(std::string_view message) {
+  std::lock_guard<std::mutex> lock(_mutex);
+  std::cout << message << std::flush;
+  if (_file.is_open()) {
+    _file << message;
+  }
+}
+
+bool Logger::drain_buffers() {
+  std::vector<LogBuffer *> buffers;
+  {
+    std::lock_guard<std::mutex> lock(_buffers_mutex);
+    for (auto &buffer : _buffers) {
+      buffers.push_back(buffer.get());
+    }
+  }
+  // Read the count first so it never runs ahead of what was drained
+  uint64_t pending = _pending.load(std::memory_order_acquire);
+  std::string batch;
+  for (auto *buffer : buffers) {
+    buffer->drain(batch);
+  }
+  if (!batch.empty()) {
+    write_direct(batch);
+  }
+  uint64_t drained = _drained.load(std::memory_order_relaxed);
+  if (pending > drained) {
+    _drained.store(pending, std::memory_order_release);
+  }
+  return !batch.empty();
 }
 
-void Logger::append(const std::string &message) {
-  std::string msg =
-      "[" + std::to_string(_timer.elapsed()) + "]" + message + "\n";
-  std::cout << msg;
-  _file << msg;
+void Logger::run_writer() {
+  while (_running) {
+    {
+      std::unique_lock<std::mutex> lock(_writer_mutex);
+      _writer_cv.wait_for(lock, std::chrono::milliseconds(10));
+    }
+    drain_buffers();
+  }
+  drain_buffers();
 }
 
+// Waits until everything appended so far has been written
+void Logger::flush() {
+  uint64_t target = _pending.load(std::memory_order_acquire);
+  if (!_running) {
+    drain_buffers();
+    return;
+  }
+  while (_drained.load(std::memory_order_acquire) < target) {
+    _writer_cv.notify_one();
+    std::this_thread::sleep_for(std::chrono::microseconds(100));
+  }
+}
+
+fs::path Logger::get_directory() const { return _file_path.parent_path(); }
+
 void Logger::close() {
+  if (_running.exchange(false)) {
+    _writer_cv.notify_one();
+    _writer.join();
+  }
+  std::lock_guard<std::mutex> lock(_mutex);
   if (_file.is_open())
     _file.close();
 }
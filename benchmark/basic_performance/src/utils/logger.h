@@ -28,32 +28,84 @@
 
 #ifndef CXL_PERF_APP_LOGGER_H
 #define CXL_PERF_APP_LOGGER_H
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
 #include <filesystem>
 #include <fstream>
+#include <memory>
 #include <mutex>
 #include <string>
-#include <utils/timer.h>
+#include <string_view>
+#include <thread>
+#include <vector>
 
 namespace fs = std::filesystem;
 
+// Single-producer/single-consumer byte ring owned by one logging thread.
+// Each record is a LogRecordHeader followed by the message bytes.
+class LogBuffer {
+public:
+  explicit LogBuffer(size_t capacity);
+
+  bool try_push(double timestamp, std::string_view message);
+  void drain(std::string &out);
+  size_t capacity() const { return _data.size(); }
+
+private:
+  struct LogRecordHeader {
+    double timestamp;
+    uint64_t length;
+  };
+
+  std::vector<char> _data;
+  alignas(64) std::atomic<uint64_t> _head;
+  alignas(64) std::atomic<uint64_t> _tail;
+
+  void copy_in(uint64_t pos, const void *src, size_t len);
+  void copy_out(uint64_t pos, void *dst, size_t len) const;
+};
+
+// append() only copies the message into a buffer owned by the calling
+// thread; a background writer formats the records and writes them to the
+// file and stdout in batches. close() drains every buffer before returning.
 class Logger {
 public:
+  static constexpr size_t BUFFER_SIZE = 1 << 20;
+
   static Logger &get_instance();
   void open(const fs::path &file_path);
-  void append(const std::string &message);
+  void append(std::string_view message);
+  void flush();
   void close();
+  fs::path get_directory() const;
 
   Logger(Logger const &) = delete;
   void operator=(Logger const &) = delete;
 
 private:
   fs::path _file_path;
-  Timer _timer;
+  std::chrono::steady_clock::time_point _start_time;
   std::ofstream _file;
   std::mutex _mutex;
 
+  std::mutex _buffers_mutex;
+  std::vector<std::unique_ptr<LogBuffer>> _buffers;
+  std::thread _writer;
+  std::mutex _writer_mutex;
+  std::condition_variable _writer_cv;
+  std::atomic<bool> _running{false};
+  std::atomic<uint64_t> _pending{0};
+  std::atomic<uint64_t> _drained{0};
+
   Logger() = default;
   ~Logger();
+
+  LogBuffer *get_thread_buffer();
+  void write_direct(std::string_view message);
+  void run_writer();
+  bool drain_buffers();
 };
 
 #endif // CXL_PERF_APP_LOGGER_H
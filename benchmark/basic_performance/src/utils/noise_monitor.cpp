@@ -0,0 +1,248 @@
+/*
+ *
+ * MIT License
+ *
+ * Copyright (c) 2025 Jangseon Park
+ * Affiliation: University of California San Diego CSE
+ * Email: jap036@ucsd.edu
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <chrono>
+#include <fcntl.h>
+#include <fstream>
+#include <sstream>
+#include <sys/resource.h>
+#include <unistd.h>
+#include <utils/noise_monitor.h>
+
+#define MSR_SMI_COUNT 0x34
+#define MSR_IA32_MPERF 0xE7
+#define MSR_IA32_APERF 0xE8
+
+// Thresholds for flagging a window. Timer ticks (LOC) are expected and only
+// count against the rate of the remaining interrupts.
+static const double IRQ_RATE_LIMIT = 100.0; // non-timer interrupts per second
+static const double FREQ_DROP_LIMIT = 0.05;
+static const double APERF_MPERF_LIMIT = 0.95;
+
+static bool is_timer_interrupt(const std::string &name) {
+  return name == "LOC" || name == "TIMER" || name == "arch_timer";
+}
+
+NoiseMonitor::~NoiseMonitor() {
+  if (_msr_fd >= 0) {
+    ::close(_msr_fd);
+  }
+}
+
+void NoiseMonitor::open(int cpu) {
+  _cpu = cpu;
+  if (_msr_fd >= 0) {
+    ::close(_msr_fd);
+  }
+  std::string path = "/dev/cpu/" + std::to_string(cpu) + "/msr";
+  _msr_fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+}
+
+void NoiseMonitor::begin() {
+  _report = NoiseReport();
+  _begin = snapshot();
+}
+
+void NoiseMonitor::end() {
+  NoiseSnapshot end = snapshot();
+  NoiseReport &r = _report;
+  r.window_ns = end.time_ns - _begin.time_ns;
+  for (const auto &[name, count] : end.interrupts) {
+    auto it = _begin.interrupts.find(name);
+    uint64_t before = it == _begin.interrupts.end() ? 0 : it->second;
+    uint64_t delta = count > before ? count - before : 0;
+    if (is_timer_interrupt(name)) {
+      r.timer_interrupts += delta;
+    } else if (delta > r.top_interrupt_count) {
+      r.top_interrupt = name;
+      r.top_interrupt_count = delta;
+    }
+    r.interrupts += delta;
+  }
+  r.voluntary_cs = end.voluntary_cs - _begin.voluntary_cs;
+  r.involuntary_cs = end.involuntary_cs - _begin.involuntary_cs;
+  r.freq_begin_khz = _begin.freq_khz;
+  r.freq_end_khz = end.freq_khz;
+  r.aperf_valid = _begin.aperf_valid && end.aperf_valid &&
+                  end.mperf > _begin.mperf;
+  if (r.aperf_valid) {
+    r.aperf_mperf = static_cast<double>(end.aperf - _begin.aperf) /
+                    static_cast<double>(end.mperf - _begin.mperf);
+  }
+  r.smi_valid = _begin.smi_valid && end.smi_valid;
+  if (r.smi_valid) {
+    r.smi = end.smi - _begin.smi;
+  }
+  flag_outliers();
+}
+
+NoiseSnapshot NoiseMonitor::snapshot() const {
+  NoiseSnapshot snap;
+  snap.interrupts = read_interrupts();
+  snap.freq_khz = read_freq();
+  struct rusage usage {};
+  if (getrusage(RUSAGE_THREAD, &usage) == 0) {
+    snap.voluntary_cs = usage.ru_nvcsw;
+    snap.involuntary_cs = usage.ru_nivcsw;
+  }
+  snap.aperf_valid = read_msr(MSR_IA32_APERF, &snap.aperf) &&
+                     read_msr(MSR_IA32_MPERF, &snap.mperf);
+  snap.smi_valid = read_msr(MSR_SMI_COUNT, &snap.smi);
+  snap.time_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                     std::chrono::steady_clock::now().time_since_epoch())
+                     .count();
+  return snap;
+}
+
+// Reads the column of /proc/interrupts that belongs to the monitored CPU.
+// The header names the online CPUs, so the column is looked up rather than
+// assumed to be the CPU number.
+std::map<std::string, uint64_t> NoiseMonitor::read_interrupts() const {
+  std::map<std::string, uint64_t> counts;
+  std::ifstream file("/proc/interrupts");
+  std::string line;
+  if (_cpu < 0 || !std::getline(file, line)) {
+    return counts;
+  }
+  std::istringstream header(line);
+  std::string token, target = "CPU" + std::to_string(_cpu);
+  int column = -1;
+  for (int i = 0; header >> token; ++i) {
+    if (token == target) {
+      column = i;
+      break;
+    }
+  }
+  if (column < 0) {
+    return counts;
+  }
+  while (std::getline(file, line)) {
+    std::istringstream fields(line);
+    std::string name;
+    fields >> name;
+    if (name.empty() || name.back() != ':') {
+      continue;
+    }
+    name.pop_back();
+    uint64_t value = 0;
+    int i = 0;
+    for (; i <= column && fields >> value; ++i) {
+    }
+    if (i == column + 1) {
+      counts[name] = value;
+    }
+  }
+  return counts;
+}
+
+uint64_t NoiseMonitor::read_freq() const {
+  std::ifstream file("/sys/devices/system/cpu/cpu" + std::to_string(_cpu) +
+                     "/cpufreq/scaling_cur_freq");
+  uint64_t khz = 0;
+  file >> khz;
+  return khz;
+}
+
+bool NoiseMonitor::read_msr(uint32_t reg, uint64_t *value) const {
+  return _msr_fd >= 0 &&
+         pread(_msr_fd, value, sizeof(*value), reg) == sizeof(*value);
+}
+
+void NoiseMonitor::flag_outliers() {
+  NoiseReport &r = _report;
+  double seconds = static_cast<double>(r.window_ns) / 1e9;
+  uint64_t device_irqs = r.interrupts - r.timer_interrupts;
+  if (seconds > 0 && device_irqs / seconds > IRQ_RATE_LIMIT) {
+    r.flags.push_back("irq");
+  }
+  if (r.involuntary_cs != 0) {
+    r.flags.push_back("preempted");
+  }
+  if (r.freq_begin_khz != 0 && r.freq_end_khz != 0 &&
+      r.freq_end_khz < r.freq_begin_khz * (1.0 - FREQ_DROP_LIMIT)) {
+    r.flags.push_back("freq-drop");
+  }
+  if (r.aperf_valid && r.aperf_mperf < APERF_MPERF_LIMIT) {
+    r.flags.push_back("throttled");
+  }
+  if (r.smi_valid && r.smi != 0) {
+    r.flags.push_back("smi");
+  }
+}
+
+std::string NoiseReport::describe() const {
+  std::ostringstream out;
+  out << "irq=" << interrupts << " (timer=" << timer_interrupts;
+  if (!top_interrupt.empty()) {
+    out << ", top=" << top_interrupt << ":" << top_interrupt_count;
+  }
+  out << ") vcs=" << voluntary_cs << " ivcs=" << involuntary_cs;
+  if (freq_begin_khz != 0) {
+    out << " freq=" << freq_begin_khz / 1000 << "->" << freq_end_khz / 1000
+        << "MHz";
+  }
+  if (aperf_valid) {
+    out << " aperf/mperf=" << aperf_mperf;
+  }
+  if (smi_valid) {
+    out << " smi=" << smi;
+  }
+  if (flags.empty()) {
+    out << " [clean]";
+  } else {
+    out << " [NOISY:";
+    for (const auto &flag : flags) {
+      out << " " << flag;
+    }
+    out << "]";
+  }
+  return out.str();
+}
+
+JsonObject NoiseReport::to_json() const {
+  JsonObject json;
+  json.add("window_ns", window_ns)
+      .add("interrupts", interrupts)
+      .add("timer_interrupts", timer_interrupts)
+      .add("top_interrupt", top_interrupt)
+      .add("top_interrupt_count", top_interrupt_count)
+      .add("voluntary_cs", voluntary_cs)
+      .add("involuntary_cs", involuntary_cs);
+  if (freq_begin_khz != 0) {
+    json.add("freq_begin_khz", freq_begin_khz)
+        .add("freq_end_khz", freq_end_khz);
+  }
+  if (aperf_valid) {
+    json.add("aperf_mperf", aperf_mperf);
+  }
+  if (smi_valid) {
+    json.add("smi", smi);
+  }
+  json.add("flags", flags);
+  return json;
+}
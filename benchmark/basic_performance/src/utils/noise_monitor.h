@@ -0,0 +1,102 @@
+/*
+ *
+ * MIT License
+ *
+ * Copyright (c) 2025 Jangseon Park
+ * Affiliation: University of California San Diego CSE
+ * Email: jap036@ucsd.edu
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef CXL_PERF_APP_NOISE_MONITOR_H
+#define CXL_PERF_APP_NOISE_MONITOR_H
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utils/json_object.h>
+#include <vector>
+
+// Snapshot of everything on a core that can disturb a measurement window.
+// Sources that are not readable on this machine stay unset (valid flags).
+struct NoiseSnapshot {
+  uint64_t time_ns = 0;
+  std::map<std::string, uint64_t> interrupts;
+  uint64_t voluntary_cs = 0;
+  uint64_t involuntary_cs = 0;
+  uint64_t freq_khz = 0;
+  uint64_t aperf = 0;
+  uint64_t mperf = 0;
+  uint64_t smi = 0;
+  bool aperf_valid = false;
+  bool smi_valid = false;
+};
+
+// Differences between the snapshots taken around one measurement window.
+struct NoiseReport {
+  uint64_t window_ns = 0;
+  uint64_t interrupts = 0;
+  uint64_t timer_interrupts = 0;
+  std::string top_interrupt;
+  uint64_t top_interrupt_count = 0;
+  uint64_t voluntary_cs = 0;
+  uint64_t involuntary_cs = 0;
+  uint64_t freq_begin_khz = 0;
+  uint64_t freq_end_khz = 0;
+  double aperf_mperf = 0.0;
+  uint64_t smi = 0;
+  bool aperf_valid = false;
+  bool smi_valid = false;
+  std::vector<std::string> flags;
+
+  std::string describe() const;
+  JsonObject to_json() const;
+};
+
+// Watches the CPU a worker is pinned to. begin() and end() must run on the
+// worker thread itself, since context switches are read with
+// getrusage(RUSAGE_THREAD). APERF/MPERF and the SMI count need a readable
+// /dev/cpu/<n>/msr (msr module, root) and are skipped otherwise.
+class NoiseMonitor {
+public:
+  NoiseMonitor() = default;
+  ~NoiseMonitor();
+  NoiseMonitor(const NoiseMonitor &) = delete;
+  NoiseMonitor &operator=(const NoiseMonitor &) = delete;
+
+  void open(int cpu);
+  void begin();
+  void end();
+  const NoiseReport &report() const { return _report; }
+
+private:
+  int _cpu = -1;
+  int _msr_fd = -1;
+  NoiseSnapshot _begin;
+  NoiseReport _report;
+
+  NoiseSnapshot snapshot() const;
+  std::map<std::string, uint64_t> read_interrupts() const;
+  uint64_t read_freq() const;
+  bool read_msr(uint32_t reg, uint64_t *value) const;
+  void flag_outliers();
+};
+
+#endif // CXL_PERF_APP_NOISE_MONITOR_H
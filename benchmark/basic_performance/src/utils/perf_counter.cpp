@@ -0,0 +1,261 @@
+/*
+ *
+ * MIT License
+ *
+ * Copyright (c) 2025 Jangseon Park
+ * Affiliation: University of California San Diego CSE
+ * Email: jap036@ucsd.edu
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <linux/perf_event.h>
+#include <sstream>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <utils/perf_counter.h>
+
+#define PERF_HW_CACHE_CONFIG(cache, op, result)                                \
+  ((cache) | ((op) << 8) | ((result) << 16))
+
+// "default" expands to the core-side events that tell a core-bound run from
+// a device-bound one.
+static const char *DEFAULT_EVENTS =
+    "cycles,instructions,llc-load-misses,llc-misses,stalls-backend,"
+    "page-faults,context-switches";
+
+static const std::vector<PerfEventSpec> NAMED_EVENTS = {
+    {"cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, false},
+    {"instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS, false},
+    {"llc-misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES, false},
+    {"llc-load-misses", PERF_TYPE_HW_CACHE,
+     PERF_HW_CACHE_CONFIG(PERF_COUNT_HW_CACHE_LL, PERF_COUNT_HW_CACHE_OP_READ,
+                          PERF_COUNT_HW_CACHE_RESULT_MISS),
+     false},
+    {"stalls-frontend", PERF_TYPE_HARDWARE,
+     PERF_COUNT_HW_STALLED_CYCLES_FRONTEND, false},
+    {"stalls-backend", PERF_TYPE_HARDWARE,
+     PERF_COUNT_HW_STALLED_CYCLES_BACKEND, false},
+    {"page-faults", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS, false},
+    {"context-switches", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES,
+     false},
+    {"cpu-migrations", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CPU_MIGRATIONS,
+     false},
+    {"task-clock", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK, false},
+};
+
+static bool read_pmu_type(const std::string &pmu, uint32_t *type) {
+  std::ifstream file("/sys/bus/event_source/devices/" + pmu + "/type");
+  return static_cast<bool>(file >> *type);
+}
+
+// Accepts a comma-separated list of named events, raw core events written as
+// r<hex> (e.g. r01a3) and uncore events written as <pmu>/<config>
+// (e.g. uncore_imc_0/0x0304).
+std::vector<PerfEventSpec>
+PerfCounterGroup::parse_events(const std::string &events) {
+  std::vector<PerfEventSpec> specs;
+  std::stringstream stream(events);
+  std::string token;
+  while (std::getline(stream, token, ',')) {
+    token.erase(0, token.find_first_not_of(" \t"));
+    token.erase(token.find_last_not_of(" \t") + 1);
+    if (token.empty()) {
+      continue;
+    } else if (token == "default") {
+      auto defaults = parse_events(DEFAULT_EVENTS);
+      specs.insert(specs.end(), defaults.begin(), defaults.end());
+      continue;
+    }
+    bool found = false;
+    for (const auto &named : NAMED_EVENTS) {
+      if (named.name == token) {
+        specs.push_back(named);
+        found = true;
+        break;
+      }
+    }
+    if (found) {
+      continue;
+    }
+    try {
+      size_t slash = token.find('/');
+      if (slash != std::string::npos) {
+        PerfEventSpec spec{token, 0, 0, true};
+        if (!read_pmu_type(token.substr(0, slash), &spec.type)) {
+          std::cerr << "Warning: unknown PMU for perf event " << token
+                    << std::endl;
+          continue;
+        }
+        spec.config = std::stoull(token.substr(slash + 1), nullptr, 0);
+        specs.push_back(spec);
+      } else if (token[0] == 'r') {
+        specs.push_back(
+            {token, PERF_TYPE_RAW, std::stoull(token.substr(1), nullptr, 16),
+             false});
+      } else {
+        std::cerr << "Warning: unknown perf event " << token << std::endl;
+      }
+    } catch (const std::exception &e) {
+      std::cerr << "Warning: invalid perf event " << token << std::endl;
+    }
+  }
+  return specs;
+}
+
+int PerfCounterGroup::open_event(const PerfEventSpec &spec, int cpu,
+                                 int group_fd) {
+  struct perf_event_attr attr;
+  std::memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = spec.type;
+  attr.config = spec.config;
+  attr.disabled = (group_fd == -1) ? 1 : 0;
+  attr.read_format =
+      PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+  if (!spec.uncore) {
+    attr.read_format |= PERF_FORMAT_GROUP;
+  }
+
+  // Uncore PMUs count per socket, so they are bound to the worker's CPU
+  // instead of the calling thread.
+  pid_t pid = spec.uncore ? -1 : 0;
+  int event_cpu = spec.uncore ? cpu : -1;
+  int fd = static_cast<int>(
+      syscall(__NR_perf_event_open, &attr, pid, event_cpu, group_fd, 0));
+  if (fd < 0 && (errno == EACCES || errno == EPERM) && !spec.uncore) {
+    // perf_event_paranoid may only allow user-space counting
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    fd = static_cast<int>(
+        syscall(__NR_perf_event_open, &attr, pid, event_cpu, group_fd, 0));
+  }
+  return fd;
+}
+
+bool PerfCounterGroup::open(const std::string &events, int cpu) {
+  close();
+  std::vector<PerfEventSpec> specs = parse_events(events);
+  // Hardware events go first so a hardware event leads the group
+  std::stable_partition(specs.begin(), specs.end(), [](const auto &spec) {
+    return spec.type != PERF_TYPE_SOFTWARE;
+  });
+
+  std::vector<std::string> dropped;
+  for (const auto &spec : specs) {
+    int fd = open_event(spec, cpu, spec.uncore ? -1 : _leader_fd);
+    if (fd < 0) {
+      dropped.push_back(spec.name + " (" + strerror(errno) + ")");
+      continue;
+    }
+    if (spec.uncore) {
+      _uncore.push_back({spec.name, fd});
+    } else {
+      if (_leader_fd == -1) {
+        _leader_fd = fd;
+      }
+      _group.push_back({spec.name, fd});
+    }
+  }
+  if (!dropped.empty()) {
+    std::string msg;
+    for (const auto &name : dropped) {
+      msg += (msg.empty() ? "" : ", ") + name;
+    }
+    std::cerr << "Warning: perf events not available: " << msg << std::endl;
+  }
+  return _leader_fd != -1 || !_uncore.empty();
+}
+
+void PerfCounterGroup::enable() {
+  if (_leader_fd != -1) {
+    ioctl(_leader_fd, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+  }
+  for (const auto &counter : _uncore) {
+    ioctl(counter.fd, PERF_EVENT_IOC_ENABLE, 0);
+  }
+}
+
+void PerfCounterGroup::disable() {
+  if (_leader_fd != -1) {
+    ioctl(_leader_fd, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+  }
+  for (const auto &counter : _uncore) {
+    ioctl(counter.fd, PERF_EVENT_IOC_DISABLE, 0);
+  }
+}
+
+// Values are scaled by time_enabled / time_running when the kernel had to
+// multiplex the group with other events.
+static uint64_t scale_count(uint64_t value, uint64_t enabled,
+                            uint64_t running) {
+  if (running == 0) {
+    return 0;
+  }
+  if (running < enabled) {
+    return static_cast<uint64_t>(static_cast<double>(value) * enabled /
+                                 running);
+  }
+  return value;
+}
+
+PerfCounterValues PerfCounterGroup::read() const {
+  PerfCounterValues values;
+  if (_leader_fd != -1) {
+    // { nr, time_enabled, time_running, value[nr] }
+    std::vector<uint64_t> buf(3 + _group.size());
+    ssize_t len = ::read(_leader_fd, buf.data(), buf.size() * sizeof(uint64_t));
+    if (len >= static_cast<ssize_t>(3 * sizeof(uint64_t))) {
+      for (size_t i = 0; i < buf[0] && i < _group.size(); i++) {
+        values.emplace_back(_group[i].name,
+                            scale_count(buf[3 + i], buf[1], buf[2]));
+      }
+    }
+  }
+  for (const auto &counter : _uncore) {
+    // { value, time_enabled, time_running }
+    uint64_t buf[3];
+    if (::read(counter.fd, buf, sizeof(buf)) == sizeof(buf)) {
+      values.emplace_back(counter.name, scale_count(buf[0], buf[1], buf[2]));
+    }
+  }
+  return values;
+}
+
+void PerfCounterGroup::close() {
+  // Members first, the leader last
+  for (auto it = _group.rbegin(); it != _group.rend(); ++it) {
+    ::close(it->fd);
+  }
+  for (const auto &counter : _uncore) {
+    ::close(counter.fd);
+  }
+  _group.clear();
+  _uncore.clear();
+  _leader_fd = -1;
+}
+
+PerfCounterGroup::~PerfCounterGroup() { close(); }
@@ -0,0 +1,77 @@
+/*
+ *
+ * MIT License
+ *
+ * Copyright (c) 2025 Jangseon Park
+ * Affiliation: University of California San Diego CSE
+ * Email: jap036@ucsd.edu
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef CXL_PERF_APP_PERF_COUNTER_H
+#define CXL_PERF_APP_PERF_COUNTER_H
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+struct PerfEventSpec {
+  std::string name;
+  uint32_t type;
+  uint64_t config;
+  bool uncore;
+};
+
+using PerfCounterValues = std::vector<std::pair<std::string, uint64_t>>;
+
+// Counter group of the calling thread, opened with perf_event_open.
+// Core and software events share one group so they are scheduled and read
+// together; uncore events are opened per CPU next to it. Events the machine
+// does not support are dropped, so without a hardware PMU (VMs, CI) only the
+// software events remain.
+class PerfCounterGroup {
+public:
+  PerfCounterGroup() = default;
+  ~PerfCounterGroup();
+  PerfCounterGroup(const PerfCounterGroup &) = delete;
+  PerfCounterGroup &operator=(const PerfCounterGroup &) = delete;
+
+  static std::vector<PerfEventSpec> parse_events(const std::string &events);
+  bool open(const std::string &events, int cpu);
+  void enable();
+  void disable();
+  PerfCounterValues read() const;
+  void close();
+
+private:
+  struct Counter {
+    std::string name;
+    int fd;
+  };
+
+  int _leader_fd = -1;
+  std::vector<Counter> _group;
+  std::vector<Counter> _uncore;
+
+  static int open_event(const PerfEventSpec &spec, int cpu, int group_fd);
+};
+
+#endif // CXL_PERF_APP_PERF_COUNTER_H
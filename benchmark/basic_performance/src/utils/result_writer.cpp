@@ -0,0 +1,72 @@
+/*
+ *
+ * MIT License
+ *
+ * Copyright (c) 2025 Jangseon Park
+ * Affiliation: University of California San Diego CSE
+ * Email: jap036@ucsd.edu
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <chrono>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <utils/result_writer.h>
+
+ResultWriter::ResultWriter(const fs::path &directory)
+    : _file_path(directory / "result.jsonl") {}
+
+bool ResultWriter::write(const std::string &benchmark,
+                         const JsonObject &record) {
+  std::ofstream file(_file_path, std::ios::out | std::ios::app);
+  if (!file.is_open()) {
+    std::cerr << "Failed to open result file: " << _file_path << std::endl;
+    return false;
+  }
+  JsonObject header;
+  header.add("schema_version", SCHEMA_VERSION).add("benchmark", benchmark);
+  // Splice the header in front of the record's own fields
+  std::string body = record.str();
+  std::string line = header.str();
+  if (body.size() > 2) {
+    line.back() = ',';
+    line += body.substr(1);
+  }
+  file << line << "\n";
+  return static_cast<bool>(file);
+}
+
+// UTC, ISO 8601 with milliseconds
+std::string ResultWriter::get_timestamp() {
+  auto now = std::chrono::system_clock::now();
+  std::time_t now_time = std::chrono::system_clock::to_time_t(now);
+  auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                now.time_since_epoch())
+                .count() %
+            1000;
+  std::tm utc_time;
+  gmtime_r(&now_time, &utc_time);
+  char buf[40];
+  size_t len = strftime(buf, sizeof(buf), "%Y-%m-%dT%H:%M:%S", &utc_time);
+  snprintf(buf + len, sizeof(buf) - len, ".%03dZ", static_cast<int>(ms));
+  return buf;
+}
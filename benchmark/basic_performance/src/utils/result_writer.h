@@ -0,0 +1,54 @@
+/*
+ *
+ * MIT License
+ *
+ * Copyright (c) 2025 Jangseon Park
+ * Affiliation: University of California San Diego CSE
+ * Email: jap036@ucsd.edu
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef CXL_PERF_APP_RESULT_WRITER_H
+#define CXL_PERF_APP_RESULT_WRITER_H
+#include <filesystem>
+#include <string>
+#include <utils/json_object.h>
+
+namespace fs = std::filesystem;
+
+// Appends one JSON object per line to result.jsonl next to result.log.
+// Every record carries the schema version and benchmark name so the
+// nightly parser can reject files it does not understand.
+class ResultWriter {
+public:
+  static constexpr int SCHEMA_VERSION = 1;
+
+  explicit ResultWriter(const fs::path &directory);
+  ~ResultWriter() = default;
+
+  bool write(const std::string &benchmark, const JsonObject &record);
+  static std::string get_timestamp();
+
+private:
+  fs::path _file_path;
+};
+
+#endif // CXL_PERF_APP_RESULT_WRITER_H
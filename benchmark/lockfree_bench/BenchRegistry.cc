@@ -0,0 +1,25 @@
+#include <algorithm>
+
+#include "BenchRegistry.hh"
+
+BenchRegistry &BenchRegistry::instance() {
+  static BenchRegistry registry;
+  return registry;
+}
+
+void BenchRegistry::add(BenchEntry entry) {
+  auto pos = std::lower_bound(benches.begin(), benches.end(), entry.name,
+                              [](const BenchEntry &e, const std::string &name) {
+                                return e.name < name;
+                              });
+  benches.insert(pos, std::move(entry));
+}
+
+const BenchEntry *BenchRegistry::find(const std::string &name) const {
+  for (const BenchEntry &entry : benches) {
+    if (entry.name == name) {
+      return &entry;
+    }
+  }
+  return nullptr;
+}
@@ -0,0 +1,62 @@
+#ifndef CXLBENCH_BENCHREGISTRY_H
+#define CXLBENCH_BENCHREGISTRY_H
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "CXLBench.hh"
+
+// What a structure supports, checked against the config before it runs.
+// Structures left out of all only run when they are named.
+struct BenchCapabilities {
+  bool keyValue           = false; // a map, takes workload mixes
+  bool singleSetterGetter = false; // exactly one setter and one getter
+  bool batched            = false; // honours batchSize
+  bool inAll              = true;
+};
+
+// Sets up the structure's reclamation, runs init, run and clean on one
+// CXLBench and tears the reclamation down again.
+typedef std::function<void(const CXLBenchConfig &config, size_t rounds)>
+    BenchRunner;
+
+struct BenchEntry {
+  std::string name;
+  std::string reclamation;
+  BenchCapabilities capabilities;
+  BenchRunner run;
+};
+
+class BenchRegistry {
+public:
+  static BenchRegistry &instance();
+
+  void add(BenchEntry entry);
+  const BenchEntry *find(const std::string &name) const;
+  // sorted by name
+  const std::vector<BenchEntry> &entries() const { return benches; }
+
+private:
+  std::vector<BenchEntry> benches;
+};
+
+// Registers a structure from its translation unit at static init time
+struct BenchRegistration {
+  BenchRegistration(const std::string &name, const std::string &reclamation,
+                    BenchCapabilities capabilities, BenchRunner run) {
+    BenchRegistry::instance().add(
+        BenchEntry{name, reclamation, capabilities, std::move(run)});
+  }
+};
+
+// Runner of a structure that needs no reclamation setup
+template <typename T>
+void run_bench(const CXLBenchConfig &config, size_t rounds) {
+  CXLBench<T> bench(config);
+  bench.init();
+  bench.run(rounds);
+  bench.clean();
+}
+
+#endif
@@ -5,21 +5,24 @@
 #include <numa.h>
 #include <numaif.h>
 
+#include <barrier>
 #include <chrono>
 #include <iostream>
 #include <random>
 #include <thread>
 
 #include "BoostMPMCQueueBench.hh"
+#include "BenchRegistry.hh"
 #include "utils.hh"
 
 typedef boost::lockfree::queue<uint64_t> q_t;
 
-CXLBench<q_t>::CXLBench(size_t size, int qNumaNode, int setterNumaNode,
-                        int getterNumaNode, int setterCore, int getterCore)
-    : size(size), qNumaNode(qNumaNode), setterNumaNode(setterNumaNode),
-      getterNumaNode(getterNumaNode), setterCore(setterCore),
-      getterCore(getterCore) {}
+CXLBench<q_t>::CXLBench(const CXLBenchConfig &config)
+    : size(config.size), qNumaNode(config.dsNumaNode),
+      setterNumaNode(config.setterNumaNode),
+      getterNumaNode(config.getterNumaNode), setterCores(config.setterCores),
+      getterCores(config.getterCores),
+      sampleInterval(config.sampleInterval) {}
 
 void CXLBench<q_t>::init() {
   // elem: q_t::value_type == uint64_t
@@ -32,54 +35,74 @@ void CXLBench<q_t>::init() {
 }
 
 void CXLBench<q_t>::run(size_t rounds) {
-  decltype(std::chrono::steady_clock::now()) setterStart;
-  decltype(std::chrono::steady_clock::now()) getterStart;
-  decltype(std::chrono::steady_clock::now()) setterEnd;
-  decltype(std::chrono::steady_clock::now()) getterEnd;
-
-  std::thread set_thread([this, rounds, &setterStart, &setterEnd]() {
-    set_thread_affinity(pthread_self(), this->setterCore);
-    bind_numa_node(this->qNumaNode);
-
-    setterStart = std::chrono::steady_clock::now();
-
-    for (size_t i = 0; i < rounds; ++i) {
-      while (true) {
-        if (q->push((uint64_t)i))
-          break;
+  size_t setters = setterCores.size();
+  size_t getters = getterCores.size();
+  // every setter pushes `rounds` elements, getters share popping all of them
+  size_t elems = setters * rounds;
+
+  std::vector<ThreadResult> setterResults(setters);
+  std::vector<ThreadResult> getterResults(getters);
+  std::barrier startBarrier(setters + getters);
+  std::vector<std::thread> threads;
+
+  for (size_t t = 0; t < setters; ++t) {
+    threads.emplace_back([this, t, rounds, &setterResults, &startBarrier]() {
+      ThreadResult &result = setterResults[t];
+      result.core          = this->setterCores[t];
+      result.ops           = rounds;
+      result.latency.init(this->sampleInterval);
+      set_thread_affinity(pthread_self(), result.core);
+      bind_numa_node(this->qNumaNode);
+
+      startBarrier.arrive_and_wait();
+      result.start = std::chrono::steady_clock::now();
+
+      for (size_t i = 0; i < rounds; ++i) {
+        uint64_t tsc = result.latency.begin();
+        while (true) {
+          if (q->push((uint64_t)i))
+            break;
+        }
+        result.latency.end(tsc);
       }
-    }
-
-    setterEnd = std::chrono::steady_clock::now();
-  });
-
-  std::thread get_thread([this, rounds, &getterStart, &getterEnd]() {
-    set_thread_affinity(pthread_self(), this->getterCore);
-    // bind_numa_node(this->mapNumaNode);
 
-    uint64_t val;
-
-    getterStart = std::chrono::steady_clock::now();
-
-    for (size_t i = 0; i < rounds; ++i) {
-      while (true) {
-        if (q->pop(val))
-          break;
+      result.end = std::chrono::steady_clock::now();
+    });
+  }
+
+  for (size_t t = 0; t < getters; ++t) {
+    size_t share = elems / getters + (t < elems % getters ? 1 : 0);
+    threads.emplace_back([this, t, share, &getterResults, &startBarrier]() {
+      ThreadResult &result = getterResults[t];
+      result.core          = this->getterCores[t];
+      result.ops           = share;
+      result.latency.init(this->sampleInterval);
+      set_thread_affinity(pthread_self(), result.core);
+      // bind_numa_node(this->mapNumaNode);
+
+      uint64_t val;
+
+      startBarrier.arrive_and_wait();
+      result.start = std::chrono::steady_clock::now();
+
+      for (size_t i = 0; i < share; ++i) {
+        uint64_t tsc = result.latency.begin();
+        while (true) {
+          if (q->pop(val))
+            break;
+        }
+        result.latency.end(tsc);
       }
-    }
 
-    getterEnd = std::chrono::steady_clock::now();
-  });
+      result.end = std::chrono::steady_clock::now();
+    });
+  }
 
-  set_thread.join();
-  get_thread.join();
+  for (auto &thread : threads) {
+    thread.join();
+  }
 
-  auto start = std::min(setterStart, getterStart);
-  auto end   = std::max(setterEnd, getterEnd);
-
-  std::cout << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start)
-                   .count()
-            << " ns" << std::endl;
+  report_results("push", setterResults, "pop", getterResults);
 }
 
 void CXLBench<q_t>::clean() {
@@ -87,3 +110,6 @@ void CXLBench<q_t>::clean() {
   numa_free(q, sizeof(q_t));
   q = nullptr;
 }
+
+static BenchRegistration registration("boost_mpmc_queue", "none", {},
+                                      run_bench<q_t>);
@@ -5,21 +5,24 @@
 #include <numa.h>
 #include <numaif.h>
 
+#include <barrier>
 #include <chrono>
 #include <iostream>
 #include <random>
 #include <thread>
 
 #include "BoostSPSCQueueBench.hh"
+#include "BenchRegistry.hh"
 #include "utils.hh"
 
 typedef boost::lockfree::spsc_queue<uint64_t> q_t;
 
-CXLBench<q_t>::CXLBench(size_t size, int qNumaNode, int setterNumaNode,
-                        int getterNumaNode, int setterCore, int getterCore)
-    : size(size), qNumaNode(qNumaNode), setterNumaNode(setterNumaNode),
-      getterNumaNode(getterNumaNode), setterCore(setterCore),
-      getterCore(getterCore) {}
+CXLBench<q_t>::CXLBench(const CXLBenchConfig &config)
+    : size(config.size), qNumaNode(config.dsNumaNode),
+      setterNumaNode(config.setterNumaNode),
+      getterNumaNode(config.getterNumaNode), setterCores(config.setterCores),
+      getterCores(config.getterCores),
+      sampleInterval(config.sampleInterval) {}
 
 void CXLBench<q_t>::init() {
   // elem: q_t::value_type == uint64_t
@@ -32,54 +35,63 @@ void CXLBench<q_t>::init() {
 }
 
 void CXLBench<q_t>::run(size_t rounds) {
-  decltype(std::chrono::steady_clock::now()) setterStart;
-  decltype(std::chrono::steady_clock::now()) getterStart;
-  decltype(std::chrono::steady_clock::now()) setterEnd;
-  decltype(std::chrono::steady_clock::now()) getterEnd;
-
-  std::thread set_thread([this, rounds, &setterStart, &setterEnd]() {
-    set_thread_affinity(pthread_self(), this->setterCore);
+  // single producer, single consumer: only the first core of each role
+  std::vector<ThreadResult> setterResults(1);
+  std::vector<ThreadResult> getterResults(1);
+  std::barrier startBarrier(2);
+
+  std::thread set_thread([this, rounds, &setterResults, &startBarrier]() {
+    ThreadResult &result = setterResults[0];
+    result.core          = this->setterCores[0];
+    result.ops           = rounds;
+    result.latency.init(this->sampleInterval);
+    set_thread_affinity(pthread_self(), result.core);
     bind_numa_node(this->qNumaNode);
 
-    setterStart = std::chrono::steady_clock::now();
+    startBarrier.arrive_and_wait();
+    result.start = std::chrono::steady_clock::now();
 
     for (size_t i = 0; i < rounds; ++i) {
+      uint64_t tsc = result.latency.begin();
       while (true) {
         if (q->push((uint64_t)i))
           break;
       }
+      result.latency.end(tsc);
     }
 
-    setterEnd = std::chrono::steady_clock::now();
+    result.end = std::chrono::steady_clock::now();
   });
 
-  std::thread get_thread([this, rounds, &getterStart, &getterEnd]() {
-    set_thread_affinity(pthread_self(), this->getterCore);
+  std::thread get_thread([this, rounds, &getterResults, &startBarrier]() {
+    ThreadResult &result = getterResults[0];
+    result.core          = this->getterCores[0];
+    result.ops           = rounds;
+    result.latency.init(this->sampleInterval);
+    set_thread_affinity(pthread_self(), result.core);
     // bind_numa_node(this->mapNumaNode);
 
     uint64_t val;
 
-    getterStart = std::chrono::steady_clock::now();
+    startBarrier.arrive_and_wait();
+    result.start = std::chrono::steady_clock::now();
 
     for (size_t i = 0; i < rounds; ++i) {
+      uint64_t tsc = result.latency.begin();
       while (true) {
         if (q->pop(val))
           break;
       }
+      result.latency.end(tsc);
     }
 
-    getterEnd = std::chrono::steady_clock::now();
+    result.end = std::chrono::steady_clock::now();
   });
 
   set_thread.join();
   get_thread.join();
 
-  auto start = std::min(setterStart, getterStart);
-  auto end   = std::max(setterEnd, getterEnd);
-
-  std::cout << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start)
-                   .count()
-            << " ns" << std::endl;
+  report_results("push", setterResults, "pop", getterResults);
 }
 
 void CXLBench<q_t>::clean() {
@@ -87,3 +99,7 @@ void CXLBench<q_t>::clean() {
   numa_free(q, sizeof(q_t));
   q = nullptr;
 }
+
+static BenchRegistration registration("boost_spsc_queue", "none",
+                                      {.singleSetterGetter = true},
+                                      run_bench<q_t>);
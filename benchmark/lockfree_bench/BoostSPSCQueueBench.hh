@@ -13,12 +13,12 @@ private:
   int qNumaNode;
   int setterNumaNode;
   int getterNumaNode;
-  int setterCore;
-  int getterCore;
+  std::vector<int> setterCores;
+  std::vector<int> getterCores;
+  size_t sampleInterval;
 
 public:
-  CXLBench(size_t size, int qNumaNode, int setterNumaNode, int getterNumaNode,
-           int setterCore, int getterCore);
+  CXLBench(const CXLBenchConfig &config);
   void init();
   void run(size_t rounds);
   void clean();
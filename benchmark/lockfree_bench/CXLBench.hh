@@ -1,6 +1,35 @@
 #ifndef CXLBENCH_CXLBENCH_H
 #define CXLBENCH_CXLBENCH_H
 
+#include <cstddef>
+#include <vector>
+
+#include "KeyGenerator.hh"
+#include "Workload.hh"
+
+// Placement of the data structure and of the setter/getter threads. Each
+// role runs one thread per entry of its core list. Every sampleInterval-th
+// operation of a thread is timed into its latency histogram, 0 disables it.
+// The maps draw the keys of both roles from keyDist, and run every thread
+// on the operation mix of workload when it is enabled. The in-tree rings
+// publish and consume batchSize elements at a time. Maps with allocator
+// hooks put their metadata on dsMetaNumaNode and their entries on
+// dsEntryNumaNode, both dsNumaNode unless split.
+struct CXLBenchConfig {
+  size_t size;
+  int dsNumaNode;
+  int dsMetaNumaNode;
+  int dsEntryNumaNode;
+  int setterNumaNode;
+  int getterNumaNode;
+  std::vector<int> setterCores;
+  std::vector<int> getterCores;
+  size_t sampleInterval;
+  KeyDistribution keyDist;
+  WorkloadMix workload;
+  size_t batchSize;
+};
+
 template <typename T> class CXLBench {
   virtual ~CXLBench() = 0;
 
@@ -0,0 +1,116 @@
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <numa.h>
+#include <numaif.h>
+
+#include <algorithm>
+#include <barrier>
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+#include "CXLMPMCRingBench.hh"
+#include "BenchRegistry.hh"
+#include "utils.hh"
+
+typedef CXLMPMCRing<uint64_t> q_t;
+
+CXLBench<q_t>::CXLBench(const CXLBenchConfig &config)
+    : size(config.size), qNumaNode(config.dsNumaNode),
+      setterNumaNode(config.setterNumaNode),
+      getterNumaNode(config.getterNumaNode), setterCores(config.setterCores),
+      getterCores(config.getterCores), sampleInterval(config.sampleInterval),
+      batchSize(config.batchSize) {}
+
+void CXLBench<q_t>::init() {
+  // elem: q_t::Slot, a turn and a uint64_t
+  q = static_cast<q_t *>(numa_alloc_onnode(sizeof(q_t), qNumaNode));
+  new (q) q_t(size / sizeof(q_t::Slot), setterNumaNode, getterNumaNode,
+              qNumaNode);
+  qElemsNum = q->capacity();
+  std::cout << "Size of queue: " << qElemsNum * sizeof(q_t::Slot)
+            << std::endl;
+  std::cout << "Number of elements in queue: " << qElemsNum << std::endl;
+}
+
+void CXLBench<q_t>::run(size_t rounds) {
+  size_t setters = setterCores.size();
+  size_t getters = getterCores.size();
+  // every setter pushes `rounds` elements, getters share popping all of them
+  size_t elems = setters * rounds;
+
+  std::vector<ThreadResult> setterResults(setters);
+  std::vector<ThreadResult> getterResults(getters);
+  std::barrier startBarrier(setters + getters);
+  std::vector<std::thread> threads;
+
+  for (size_t t = 0; t < setters; ++t) {
+    threads.emplace_back([this, t, rounds, &setterResults, &startBarrier]() {
+      ThreadResult &result = setterResults[t];
+      result.core          = this->setterCores[t];
+      result.ops           = rounds;
+      result.latency.init(this->sampleInterval);
+      set_thread_affinity(pthread_self(), result.core);
+      bind_numa_node(this->qNumaNode);
+
+      std::vector<uint64_t> batch(this->batchSize);
+
+      startBarrier.arrive_and_wait();
+      result.start = std::chrono::steady_clock::now();
+
+      for (size_t i = 0; i < rounds; i += batch.size()) {
+        size_t n = std::min(batch.size(), rounds - i);
+        for (size_t j = 0; j < n; ++j) {
+          batch[j] = i + j;
+        }
+        uint64_t tsc = result.latency.begin();
+        q->push(batch.data(), n);
+        result.latency.end(tsc);
+      }
+
+      result.end = std::chrono::steady_clock::now();
+    });
+  }
+
+  for (size_t t = 0; t < getters; ++t) {
+    size_t share = elems / getters + (t < elems % getters ? 1 : 0);
+    threads.emplace_back([this, t, share, &getterResults, &startBarrier]() {
+      ThreadResult &result = getterResults[t];
+      result.core          = this->getterCores[t];
+      result.ops           = share;
+      result.latency.init(this->sampleInterval);
+      set_thread_affinity(pthread_self(), result.core);
+
+      std::vector<uint64_t> batch(this->batchSize);
+
+      startBarrier.arrive_and_wait();
+      result.start = std::chrono::steady_clock::now();
+
+      for (size_t i = 0; i < share; i += batch.size()) {
+        size_t n     = std::min(batch.size(), share - i);
+        uint64_t tsc = result.latency.begin();
+        q->pop(batch.data(), n);
+        result.latency.end(tsc);
+      }
+
+      result.end = std::chrono::steady_clock::now();
+    });
+  }
+
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  report_results("push", setterResults, "pop", getterResults);
+}
+
+void CXLBench<q_t>::clean() {
+  q->~q_t();
+  numa_free(q, sizeof(q_t));
+  q = nullptr;
+}
+
+static BenchRegistration registration("cxl_mpmc_ring_queue", "none",
+                                      {.batched = true}, run_bench<q_t>);
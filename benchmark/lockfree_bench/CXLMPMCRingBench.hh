@@ -0,0 +1,27 @@
+#ifndef CXLBENCH_CXL_MPMCRING_H
+#define CXLBENCH_CXL_MPMCRING_H
+
+#include "CXLBench.hh"
+#include "CXLRing.hh"
+
+template <> class CXLBench<CXLMPMCRing<uint64_t>> {
+private:
+  CXLMPMCRing<uint64_t> *q;
+  size_t size;
+  size_t qElemsNum;
+  int qNumaNode;
+  int setterNumaNode;
+  int getterNumaNode;
+  std::vector<int> setterCores;
+  std::vector<int> getterCores;
+  size_t sampleInterval;
+  size_t batchSize;
+
+public:
+  CXLBench(const CXLBenchConfig &config);
+  void init();
+  void run(size_t rounds);
+  void clean();
+};
+
+#endif
@@ -0,0 +1,187 @@
+#ifndef CXLBENCH_CXLRING_H
+#define CXLBENCH_CXLRING_H
+
+#include <numa.h>
+#include <x86intrin.h>
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+// Every index lives on its own cache line, allocated on the NUMA node of
+// the side that writes it, while the slots are allocated on their own
+// node. This splits the cost of index ping-pong from the cost of moving
+// the payload, e.g. indices in local DRAM and slots on CXL.
+struct alignas(64) CXLRingIndex {
+  std::atomic<uint64_t> value;
+};
+
+// private to one side, on its own line so the remote side never sees it
+struct alignas(64) CXLRingCache {
+  uint64_t value;
+};
+
+template <typename T> T *cxl_ring_alloc(size_t n, int node) {
+  T *p = static_cast<T *>(numa_alloc_onnode(n * sizeof(T), node));
+  if (p == nullptr) {
+    throw std::bad_alloc();
+  }
+  for (size_t i = 0; i < n; ++i) {
+    new (p + i) T();
+  }
+  return p;
+}
+
+template <typename T> void cxl_ring_free(T *p, size_t n) {
+  for (size_t i = 0; i < n; ++i) {
+    p[i].~T();
+  }
+  numa_free(p, n * sizeof(T));
+}
+
+// Single producer, single consumer ring. Each side keeps a cached copy of
+// the other side's index and only reads the remote index when the cached
+// one says the ring is full or empty. push() and pop() move up to n
+// elements and publish them with a single index store.
+template <typename T> class CXLSPSCRing {
+public:
+  typedef T value_type;
+
+  CXLSPSCRing(size_t capacity, int producerNode, int consumerNode,
+              int slotNode)
+      : cap(std::bit_floor(std::max<size_t>(capacity, 1))), mask(cap - 1) {
+    producer = cxl_ring_alloc<Producer>(1, producerNode);
+    consumer = cxl_ring_alloc<Consumer>(1, consumerNode);
+    slots    = cxl_ring_alloc<T>(cap, slotNode);
+  }
+
+  ~CXLSPSCRing() {
+    cxl_ring_free(producer, 1);
+    cxl_ring_free(consumer, 1);
+    cxl_ring_free(slots, cap);
+  }
+
+  size_t push(const T *items, size_t n) {
+    uint64_t head = producer->head.value.load(std::memory_order_relaxed);
+    if (cap - (head - producer->cachedTail.value) < n) {
+      producer->cachedTail.value =
+          consumer->tail.value.load(std::memory_order_acquire);
+    }
+    n = std::min<size_t>(n, cap - (head - producer->cachedTail.value));
+    for (size_t i = 0; i < n; ++i) {
+      slots[(head + i) & mask] = items[i];
+    }
+    if (n != 0) {
+      producer->head.value.store(head + n, std::memory_order_release);
+    }
+    return n;
+  }
+
+  size_t pop(T *items, size_t n) {
+    uint64_t tail = consumer->tail.value.load(std::memory_order_relaxed);
+    if (consumer->cachedHead.value - tail < n) {
+      consumer->cachedHead.value =
+          producer->head.value.load(std::memory_order_acquire);
+    }
+    n = std::min<size_t>(n, consumer->cachedHead.value - tail);
+    for (size_t i = 0; i < n; ++i) {
+      items[i] = slots[(tail + i) & mask];
+    }
+    if (n != 0) {
+      consumer->tail.value.store(tail + n, std::memory_order_release);
+    }
+    return n;
+  }
+
+  size_t capacity() const { return cap; }
+
+private:
+  struct Producer {
+    CXLRingIndex head;
+    CXLRingCache cachedTail;
+  };
+
+  struct Consumer {
+    CXLRingIndex tail;
+    CXLRingCache cachedHead;
+  };
+
+  size_t cap;
+  size_t mask;
+  Producer *producer;
+  Consumer *consumer;
+  T *slots;
+};
+
+// Multi producer, multi consumer ring. A side claims n consecutive
+// tickets with one fetch_add on its index, then waits for each claimed
+// slot's turn: even turns are free for the producer of that lap, odd ones
+// hold an element for its consumer. Claiming never fails, so push() and
+// pop() block until their slots turn over.
+template <typename T> class CXLMPMCRing {
+public:
+  typedef T value_type;
+
+  struct Slot {
+    std::atomic<uint64_t> turn;
+    T value;
+  };
+
+  CXLMPMCRing(size_t capacity, int producerNode, int consumerNode,
+              int slotNode)
+      : cap(std::bit_floor(std::max<size_t>(capacity, 1))), mask(cap - 1),
+        shift(std::countr_zero(cap)) {
+    head  = cxl_ring_alloc<CXLRingIndex>(1, producerNode);
+    tail  = cxl_ring_alloc<CXLRingIndex>(1, consumerNode);
+    slots = cxl_ring_alloc<Slot>(cap, slotNode);
+  }
+
+  ~CXLMPMCRing() {
+    cxl_ring_free(head, 1);
+    cxl_ring_free(tail, 1);
+    cxl_ring_free(slots, cap);
+  }
+
+  size_t push(const T *items, size_t n) {
+    uint64_t ticket = head->value.fetch_add(n, std::memory_order_relaxed);
+    for (size_t i = 0; i < n; ++i) {
+      Slot &slot    = slots[(ticket + i) & mask];
+      uint64_t turn = ((ticket + i) >> shift) * 2;
+      while (slot.turn.load(std::memory_order_acquire) != turn) {
+        _mm_pause();
+      }
+      slot.value = items[i];
+      slot.turn.store(turn + 1, std::memory_order_release);
+    }
+    return n;
+  }
+
+  size_t pop(T *items, size_t n) {
+    uint64_t ticket = tail->value.fetch_add(n, std::memory_order_relaxed);
+    for (size_t i = 0; i < n; ++i) {
+      Slot &slot    = slots[(ticket + i) & mask];
+      uint64_t turn = ((ticket + i) >> shift) * 2 + 1;
+      while (slot.turn.load(std::memory_order_acquire) != turn) {
+        _mm_pause();
+      }
+      items[i] = slot.value;
+      slot.turn.store(turn + 1, std::memory_order_release);
+    }
+    return n;
+  }
+
+  size_t capacity() const { return cap; }
+
+private:
+  size_t cap;
+  size_t mask;
+  unsigned int shift;
+  CXLRingIndex *head;
+  CXLRingIndex *tail;
+  Slot *slots;
+};
+
+#endif
@@ -0,0 +1,110 @@
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <numa.h>
+#include <numaif.h>
+
+#include <algorithm>
+#include <barrier>
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+#include "CXLSPSCRingBench.hh"
+#include "BenchRegistry.hh"
+#include "utils.hh"
+
+typedef CXLSPSCRing<uint64_t> q_t;
+
+CXLBench<q_t>::CXLBench(const CXLBenchConfig &config)
+    : size(config.size), qNumaNode(config.dsNumaNode),
+      setterNumaNode(config.setterNumaNode),
+      getterNumaNode(config.getterNumaNode), setterCores(config.setterCores),
+      getterCores(config.getterCores), sampleInterval(config.sampleInterval),
+      batchSize(config.batchSize) {}
+
+void CXLBench<q_t>::init() {
+  // elem: q_t::value_type == uint64_t
+  q = static_cast<q_t *>(numa_alloc_onnode(sizeof(q_t), qNumaNode));
+  new (q) q_t(size / sizeof(uint64_t), setterNumaNode, getterNumaNode,
+              qNumaNode);
+  qElemsNum = q->capacity();
+  std::cout << "Size of queue: " << qElemsNum * sizeof(uint64_t) << std::endl;
+  std::cout << "Number of elements in queue: " << qElemsNum << std::endl;
+}
+
+void CXLBench<q_t>::run(size_t rounds) {
+  // single producer, single consumer: only the first core of each role
+  std::vector<ThreadResult> setterResults(1);
+  std::vector<ThreadResult> getterResults(1);
+  std::barrier startBarrier(2);
+
+  std::thread set_thread([this, rounds, &setterResults, &startBarrier]() {
+    ThreadResult &result = setterResults[0];
+    result.core          = this->setterCores[0];
+    result.ops           = rounds;
+    result.latency.init(this->sampleInterval);
+    set_thread_affinity(pthread_self(), result.core);
+    bind_numa_node(this->qNumaNode);
+
+    std::vector<uint64_t> batch(this->batchSize);
+
+    startBarrier.arrive_and_wait();
+    result.start = std::chrono::steady_clock::now();
+
+    for (size_t i = 0; i < rounds; i += batch.size()) {
+      size_t n = std::min(batch.size(), rounds - i);
+      for (size_t j = 0; j < n; ++j) {
+        batch[j] = i + j;
+      }
+      uint64_t tsc = result.latency.begin();
+      for (size_t done = 0; done < n;) {
+        done += q->push(batch.data() + done, n - done);
+      }
+      result.latency.end(tsc);
+    }
+
+    result.end = std::chrono::steady_clock::now();
+  });
+
+  std::thread get_thread([this, rounds, &getterResults, &startBarrier]() {
+    ThreadResult &result = getterResults[0];
+    result.core          = this->getterCores[0];
+    result.ops           = rounds;
+    result.latency.init(this->sampleInterval);
+    set_thread_affinity(pthread_self(), result.core);
+
+    std::vector<uint64_t> batch(this->batchSize);
+
+    startBarrier.arrive_and_wait();
+    result.start = std::chrono::steady_clock::now();
+
+    for (size_t i = 0; i < rounds; i += batch.size()) {
+      size_t n     = std::min(batch.size(), rounds - i);
+      uint64_t tsc = result.latency.begin();
+      for (size_t done = 0; done < n;) {
+        done += q->pop(batch.data() + done, n - done);
+      }
+      result.latency.end(tsc);
+    }
+
+    result.end = std::chrono::steady_clock::now();
+  });
+
+  set_thread.join();
+  get_thread.join();
+
+  report_results("push", setterResults, "pop", getterResults);
+}
+
+void CXLBench<q_t>::clean() {
+  q->~q_t();
+  numa_free(q, sizeof(q_t));
+  q = nullptr;
+}
+
+static BenchRegistration
+    registration("cxl_spsc_ring_queue", "none",
+                 {.singleSetterGetter = true, .batched = true},
+                 run_bench<q_t>);
@@ -5,21 +5,19 @@
 #include <numa.h>
 #include <numaif.h>
 
-#include <chrono>
 #include <iostream>
-#include <random>
-#include <thread>
 
 #include "FollyAtomicHashMapBench.hh"
+#include "BenchRegistry.hh"
+#include "RolesRunner.hh"
+#include "WorkloadRunner.hh"
 #include "utils.hh"
 
-typedef folly::AtomicHashMap<uint64_t, uint64_t> map_t;
+typedef FollyAtomicHashMapT map_t;
 
-CXLBench<map_t>::CXLBench(size_t size, int mapNumaNode, int setterNumaNode,
-                          int getterNumaNode, int setterCore, int getterCore)
-    : size(size), mapNumaNode(mapNumaNode), setterNumaNode(setterNumaNode),
-      getterNumaNode(getterNumaNode), setterCore(setterCore),
-      getterCore(getterCore), setterSeq(nullptr), getterSeq(nullptr) {}
+CXLBench<map_t>::CXLBench(const CXLBenchConfig &config)
+    : size(config.size), metaNumaNode(config.dsMetaNumaNode),
+      config(config) {}
 
 void CXLBench<map_t>::init() {
   // key: uint64_t, val: uint64_t
@@ -27,7 +25,7 @@ void CXLBench<map_t>::init() {
   std::cout << "Size of map: " << size << std::endl;
   std::cout << "Number of entries in map: " << mapEntriesNum << std::endl;
 
-  m = static_cast<map_t *>(numa_alloc_onnode(sizeof(map_t), mapNumaNode));
+  m = static_cast<map_t *>(numa_alloc_onnode(sizeof(map_t), metaNumaNode));
   new (m) map_t(mapEntriesNum);
 
   for (size_t i = 0; i < mapEntriesNum; ++i) {
@@ -38,76 +36,69 @@ void CXLBench<map_t>::init() {
       }
     }
   }
+
+  report_placement("map object", m, sizeof(map_t));
+  numa_arena_report();
 }
 
 void CXLBench<map_t>::run(size_t rounds) {
-  setterSeq = static_cast<uint64_t *>(
-      numa_alloc_onnode(rounds * sizeof(uint64_t), setterNumaNode));
-  getterSeq = static_cast<uint64_t *>(
-      numa_alloc_onnode(rounds * sizeof(uint64_t), getterNumaNode));
-
-  std::random_device rd;
-  std::mt19937 gen(rd());
-  std::uniform_int_distribution<uint64_t> distrib(0, mapEntriesNum);
-
-  for (size_t i = 0; i < rounds; ++i) {
-    setterSeq[i] = distrib(gen);
-    getterSeq[i] = distrib(gen);
+  if (config.workload.enabled) {
+    runWorkload(rounds);
+    return;
   }
 
-  decltype(std::chrono::steady_clock::now()) setterStart;
-  decltype(std::chrono::steady_clock::now()) getterStart;
-  decltype(std::chrono::steady_clock::now()) setterEnd;
-  decltype(std::chrono::steady_clock::now()) getterEnd;
-
-  std::thread set_thread([this, rounds, &setterStart, &setterEnd]() {
-    set_thread_affinity(pthread_self(), this->setterCore);
-    bind_numa_node(this->mapNumaNode);
-
-    setterStart = std::chrono::steady_clock::now();
+  run_roles(config, mapEntriesNum, rounds,
+            [this](uint64_t key) {
+              auto ret = m->insert(key, key);
+              if (!ret.second) { // key already exists, overwrite its val
+                store_value(ret.first->second, key + 1);
+              }
+            },
+            [this](uint64_t key) {
+              auto ret = m->find(key);
+              if (ret != m->end()) {
+                load_value(ret->second);
+              }
+            });
+}
 
-    for (size_t i = 0; i < rounds; ++i) {
-      auto ret = m->insert(this->setterSeq[i], this->setterSeq[i]);
-      if (!ret.second) { // key already exists, increment val by 1
-        ret.first->second += 1;
+void CXLBench<map_t>::runWorkload(size_t rounds) {
+  run_workload(config, mapEntriesNum, rounds, [this](WorkloadThread &thread) {
+    thread.run([this](const WorkloadOp &op) {
+      switch (op.op) {
+      case MapOp::Read:
+        return m->find(op.key) != m->end();
+      case MapOp::Update: {
+        auto ret = m->find(op.key);
+        if (ret == m->end()) {
+          return false;
+        }
+        store_value(ret->second, op.key + 1);
+        return true;
       }
-    }
-
-    setterEnd = std::chrono::steady_clock::now();
-  });
-
-  std::thread get_thread([this, rounds, &getterStart, &getterEnd]() {
-    set_thread_affinity(pthread_self(), this->getterCore);
-    // bind_numa_node(this->mapNumaNode);
-
-    uint64_t val;
-
-    getterStart = std::chrono::steady_clock::now();
-
-    for (size_t i = 0; i < rounds; ++i) {
-      auto ret = m->find(this->getterSeq[i]);
-      if (ret != m->end()) {
-        val = ret->second;
+      case MapOp::Insert:
+        return m->insert(op.key, op.key).second;
+      case MapOp::ReadModifyWrite: {
+        auto ret = m->find(op.key);
+        if (ret == m->end()) {
+          return false;
+        }
+        store_value(ret->second, load_value(ret->second) + 1);
+        return true;
       }
-    }
-
-    getterEnd = std::chrono::steady_clock::now();
+      case MapOp::Delete:
+        return m->erase(op.key) != 0;
+      case MapOp::Scan: {
+        bool hit = false;
+        for (uint32_t i = 0; i < op.scanLength; ++i) {
+          hit |= m->find(op.key + i) != m->end();
+        }
+        return hit;
+      }
+      }
+      return false;
+    });
   });
-
-  set_thread.join();
-  get_thread.join();
-
-  numa_free(setterSeq, rounds * sizeof(uint64_t));
-  numa_free(getterSeq, rounds * sizeof(uint64_t));
-  setterSeq = nullptr;
-  getterSeq = nullptr;
-
-  auto start = std::min(setterStart, getterStart);
-  auto end   = std::max(setterEnd, getterEnd);
-
-  std::cout << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start)
-                   .count()
-            << " ns" << std::endl;
 }
 
 void CXLBench<map_t>::clean() {
@@ -115,3 +106,6 @@ void CXLBench<map_t>::clean() {
   numa_free(m, sizeof(map_t));
   m = nullptr;
 }
+
+static BenchRegistration registration("folly_atomichashmap_map", "none",
+                                      {.keyValue = true}, run_bench<map_t>);
@@ -2,27 +2,28 @@
 #define CXLBENCH_FOLLY_ATOMICHASHMAP_H
 
 #include "CXLBench.hh"
+#include "NUMAArena.hh"
 
 #include <folly/AtomicHashMap.h>
 
-template <> class CXLBench<folly::AtomicHashMap<uint64_t, uint64_t>> {
+// The submaps, the hash arrays holding the cells, come from Allocator
+typedef folly::AtomicHashMap<uint64_t, uint64_t, std::hash<uint64_t>,
+                             std::equal_to<uint64_t>, NUMAEntryAllocator<char>>
+    FollyAtomicHashMapT;
+
+template <> class CXLBench<FollyAtomicHashMapT> {
 private:
-  folly::AtomicHashMap<uint64_t, uint64_t> *m;
+  FollyAtomicHashMapT *m;
   size_t size;
   size_t mapEntriesNum;
-  int mapNumaNode;
-  int setterNumaNode;
-  int getterNumaNode;
-  int setterCore;
-  int getterCore;
-  uint64_t *setterSeq;
-  uint64_t *getterSeq;
+  int metaNumaNode;
+  CXLBenchConfig config;
 
 public:
-  CXLBench(size_t size, int mapNumaNode, int setterNumaNode, int getterNumaNode,
-           int setterCore, int getterCore);
+  CXLBench(const CXLBenchConfig &config);
   void init();
   void run(size_t rounds);
+  void runWorkload(size_t rounds);
   void clean();
 };
 
@@ -13,19 +13,14 @@ private:
   junction::ConcurrentMap_Grampa<uint64_t, uint64_t> *m;
   size_t size;
   size_t mapEntriesNum;
-  int mapNumaNode;
-  int setterNumaNode;
-  int getterNumaNode;
-  int setterCore;
-  int getterCore;
-  uint64_t *setterSeq;
-  uint64_t *getterSeq;
+  int metaNumaNode;
+  CXLBenchConfig config;
 
 public:
-  CXLBench(size_t size, int mapNumaNode, int setterNumaNode, int getterNumaNode,
-           int setterCore, int getterCore);
+  CXLBench(const CXLBenchConfig &config);
   void init(junction::QSBR::Context &context);
   void run(size_t rounds);
+  void runWorkload(size_t rounds);
   void clean();
 };
 
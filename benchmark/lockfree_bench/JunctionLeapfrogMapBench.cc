@@ -5,21 +5,20 @@
 #include <numa.h>
 #include <numaif.h>
 
-#include <chrono>
 #include <iostream>
-#include <random>
-#include <thread>
 
 #include "JunctionLeapfrogMapBench.hh"
+#include "BenchRegistry.hh"
+#include "JunctionRunner.hh"
+#include "RolesRunner.hh"
+#include "WorkloadRunner.hh"
 #include "utils.hh"
 
 typedef junction::ConcurrentMap_Leapfrog<uint64_t, uint64_t> map_t;
 
-CXLBench<map_t>::CXLBench(size_t size, int mapNumaNode, int setterNumaNode,
-                          int getterNumaNode, int setterCore, int getterCore)
-    : size(size), mapNumaNode(mapNumaNode), setterNumaNode(setterNumaNode),
-      getterNumaNode(getterNumaNode), setterCore(setterCore),
-      getterCore(getterCore), setterSeq(nullptr), getterSeq(nullptr) {}
+CXLBench<map_t>::CXLBench(const CXLBenchConfig &config)
+    : size(config.size), metaNumaNode(config.dsMetaNumaNode),
+      config(config) {}
 
 void CXLBench<map_t>::init(junction::QSBR::Context &context) {
   // key: uint64_t, val: uint64_t
@@ -27,7 +26,7 @@ void CXLBench<map_t>::init(junction::QSBR::Context &context) {
   std::cout << "Size of map: " << size << std::endl;
   std::cout << "Number of entries in map: " << mapEntriesNum << std::endl;
 
-  m = static_cast<map_t *>(numa_alloc_onnode(sizeof(map_t), mapNumaNode));
+  m = static_cast<map_t *>(numa_alloc_onnode(sizeof(map_t), metaNumaNode));
   new (m) map_t(mapEntriesNum);
 
   for (size_t i = 0; i < mapEntriesNum; ++i) {
@@ -36,85 +35,69 @@ void CXLBench<map_t>::init(junction::QSBR::Context &context) {
     if (i % 10000 == 0)
       junction::DefaultQSBR.update(context);
   }
+
+  report_placement("map object", m, sizeof(map_t));
 }
 
 void CXLBench<map_t>::run(size_t rounds) {
-  setterSeq = static_cast<uint64_t *>(
-      numa_alloc_onnode(rounds * sizeof(uint64_t), setterNumaNode));
-  getterSeq = static_cast<uint64_t *>(
-      numa_alloc_onnode(rounds * sizeof(uint64_t), getterNumaNode));
-
-  std::random_device rd;
-  std::mt19937 gen(rd());
-  std::uniform_int_distribution<uint64_t> distrib(0, mapEntriesNum);
-
-  for (size_t i = 0; i < rounds; ++i) {
-    setterSeq[i] = distrib(gen);
-    getterSeq[i] = distrib(gen);
+  if (config.workload.enabled) {
+    runWorkload(rounds);
+    return;
   }
 
-  decltype(std::chrono::steady_clock::now()) setterStart;
-  decltype(std::chrono::steady_clock::now()) getterStart;
-  decltype(std::chrono::steady_clock::now()) setterEnd;
-  decltype(std::chrono::steady_clock::now()) getterEnd;
-
-  std::thread set_thread([this, rounds, &setterStart, &setterEnd]() {
-    set_thread_affinity(pthread_self(), this->setterCore);
-    bind_numa_node(this->mapNumaNode);
-
-    junction::QSBR::Context context = junction::DefaultQSBR.createContext();
-
-    setterStart = std::chrono::steady_clock::now();
-
-    for (size_t i = 0; i < rounds; ++i) {
-      // std::cout << "setter: " << i << " " << this->setterSeq[i] << std::endl;
-      m->exchange(this->setterSeq[i], this->setterSeq[i] + 1);
-      // m->assign(this->setterSeq[i], this->setterSeq[i] + 1);
-      if (i % 10000 == 0)
-        junction::DefaultQSBR.update(context);
-    }
-
-    setterEnd = std::chrono::steady_clock::now();
-
-    junction::DefaultQSBR.destroyContext(context);
-  });
-
-  std::thread get_thread([this, rounds, &getterStart, &getterEnd]() {
-    set_thread_affinity(pthread_self(), this->getterCore);
-    // bind_numa_node(this->mapNumaNode);
+  // 0 is junction's null value, returned for a missing key
+  run_roles(
+      config, mapEntriesNum, rounds,
+      [this](uint64_t key) { m->exchange(key, key + 1); },
+      [this](uint64_t key) { m->get(key); },
+      [](auto &thread) {
+        junction::QSBR::Context context =
+            junction::DefaultQSBR.createContext();
+        // only the setters retire anything
+        thread.run([&context]() { junction::DefaultQSBR.update(context); },
+                   thread.isSetter() ? 10000 : 0);
+        junction::DefaultQSBR.destroyContext(context);
+      });
+}
 
+void CXLBench<map_t>::runWorkload(size_t rounds) {
+  run_workload(config, mapEntriesNum, rounds, [this](WorkloadThread &thread) {
     junction::QSBR::Context context = junction::DefaultQSBR.createContext();
 
-    uint64_t val;
-
-    getterStart = std::chrono::steady_clock::now();
-
-    for (size_t i = 0; i < rounds; ++i) {
-      // std::cout << "getter: " << i << " " << this->getterSeq[i] << std::endl;
-      val = m->get(this->getterSeq[i]);
-      // if (i % 10000 == 0)
-      // junction::DefaultQSBR.update(context);
-    }
-
-    getterEnd = std::chrono::steady_clock::now();
+    // 0 is junction's null value, returned for a missing key
+    thread.run(
+        [this](const WorkloadOp &op) {
+          switch (op.op) {
+          case MapOp::Read:
+            return m->get(op.key) != 0;
+          case MapOp::Update:
+            return m->exchange(op.key, op.key + 1) != 0;
+          case MapOp::Insert:
+            return m->assign(op.key, op.key) == 0;
+          case MapOp::ReadModifyWrite: {
+            uint64_t val = m->get(op.key);
+            if (val == 0) {
+              return false;
+            }
+            m->exchange(op.key, val + 1);
+            return true;
+          }
+          case MapOp::Delete:
+            return m->erase(op.key) != 0;
+          case MapOp::Scan: {
+            bool hit = false;
+            for (uint32_t i = 0; i < op.scanLength; ++i) {
+              hit |= m->get(op.key + i) != 0;
+            }
+            return hit;
+          }
+          }
+          return false;
+        },
+        [&context]() { junction::DefaultQSBR.update(context); }, 10000);
 
     junction::DefaultQSBR.destroyContext(context);
   });
-
-  set_thread.join();
-  get_thread.join();
-
-  numa_free(setterSeq, rounds * sizeof(uint64_t));
-  numa_free(getterSeq, rounds * sizeof(uint64_t));
-  setterSeq = nullptr;
-  getterSeq = nullptr;
-
-  auto start = std::min(setterStart, getterStart);
-  auto end   = std::max(setterEnd, getterEnd);
-
-  std::cout << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start)
-                   .count()
-            << " ns" << std::endl;
 }
 
 void CXLBench<map_t>::clean() {
@@ -122,3 +105,7 @@ void CXLBench<map_t>::clean() {
   numa_free(m, sizeof(map_t));
   m = nullptr;
 }
+
+static BenchRegistration registration("junction_leapfrogmap_map",
+                                      "junction QSBR", {.keyValue = true},
+                                      run_junction_bench<map_t>);
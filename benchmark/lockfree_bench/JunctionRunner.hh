@@ -0,0 +1,22 @@
+#ifndef CXLBENCH_JUNCTIONRUNNER_H
+#define CXLBENCH_JUNCTIONRUNNER_H
+
+#include <junction/QSBR.h>
+
+#include "CXLBench.hh"
+
+// Runs one junction map with the main thread's QSBR context, which init()
+// updates during the prefill.
+template <typename T>
+void run_junction_bench(const CXLBenchConfig &config, size_t rounds) {
+  junction::QSBR::Context context = junction::DefaultQSBR.createContext();
+
+  CXLBench<T> bench(config);
+  bench.init(context);
+  bench.run(rounds);
+  bench.clean();
+
+  junction::DefaultQSBR.destroyContext(context);
+}
+
+#endif
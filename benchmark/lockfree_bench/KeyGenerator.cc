@@ -0,0 +1,144 @@
+#include <algorithm>
+#include <cmath>
+
+#include "KeyGenerator.hh"
+
+static const struct {
+  const char *name;
+  KeyDistributionType type;
+} distributions[] = {
+    {"uniform", KeyDistributionType::Uniform},
+    {"zipfian", KeyDistributionType::Zipfian},
+    {"hotspot", KeyDistributionType::Hotspot},
+    {"sequential", KeyDistributionType::Sequential},
+    {"latest", KeyDistributionType::Latest},
+};
+
+bool parse_key_distribution(const std::string &name,
+                            KeyDistributionType *type) {
+  for (const auto &d : distributions) {
+    if (name == d.name) {
+      *type = d.type;
+      return true;
+    }
+  }
+  return false;
+}
+
+const char *key_distribution_name(KeyDistributionType type) {
+  for (const auto &d : distributions) {
+    if (type == d.type) {
+      return d.name;
+    }
+  }
+  return "unknown";
+}
+
+// Sum of 1 / i^theta for i in [1, n]. Maps hold up to hundreds of millions
+// of keys, so past the first 2^20 terms the tail is approximated by its
+// integral with the Euler-Maclaurin end correction.
+static double zeta(uint64_t n, double theta) {
+  uint64_t exact = std::min<uint64_t>(n, 1 << 20);
+  double sum     = 0.0;
+  for (uint64_t i = 1; i <= exact; ++i) {
+    sum += 1.0 / std::pow(static_cast<double>(i), theta);
+  }
+  if (n > exact) {
+    double a = static_cast<double>(exact);
+    double b = static_cast<double>(n);
+    sum += (std::pow(b, 1.0 - theta) - std::pow(a, 1.0 - theta)) /
+               (1.0 - theta) +
+           (std::pow(b, -theta) - std::pow(a, -theta)) / 2.0;
+  }
+  return sum;
+}
+
+KeyGenerator::KeyGenerator(const KeyDistribution &dist, uint64_t keys)
+    : dist(dist), keys(std::max<uint64_t>(keys, 1)), hotKeys(0), sequence(0),
+      gen(std::random_device{}()), uniform(0.0, 1.0), zetan(0.0), theta(0.0),
+      alpha(0.0), eta(0.0) {
+  if (dist.type == KeyDistributionType::Hotspot) {
+    hotKeys = static_cast<uint64_t>(this->keys * dist.hotKeysPct / 100.0);
+    hotKeys = std::clamp<uint64_t>(hotKeys, 1, this->keys);
+  }
+  if (dist.type == KeyDistributionType::Zipfian ||
+      dist.type == KeyDistributionType::Latest) {
+    theta        = dist.zipfTheta;
+    zetan        = zeta(this->keys, theta);
+    double zeta2 = zeta(2, theta);
+    alpha        = 1.0 / (1.0 - theta);
+    eta = (1.0 - std::pow(2.0 / this->keys, 1.0 - theta)) /
+          (1.0 - zeta2 / zetan);
+  }
+}
+
+// YCSB's FNV-1a 64 over the bytes of v
+static uint64_t fnv_hash64(uint64_t v) {
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  for (int i = 0; i < 8; ++i) {
+    hash ^= v & 0xff;
+    hash *= 1099511628211ULL;
+    v >>= 8;
+  }
+  return hash;
+}
+
+// rank 0 is the most popular key
+uint64_t KeyGenerator::zipfian() {
+  double u  = uniform(gen);
+  double uz = u * zetan;
+  if (uz < 1.0) {
+    return 0;
+  }
+  if (uz < 1.0 + std::pow(0.5, theta)) {
+    return 1;
+  }
+  uint64_t rank = static_cast<uint64_t>(
+      keys * std::pow(eta * u - eta + 1.0, alpha));
+  return std::min(rank, keys - 1);
+}
+
+uint64_t KeyGenerator::next() {
+  switch (dist.type) {
+  case KeyDistributionType::Zipfian:
+    // scattered like YCSB's ScrambledZipfian, so the hot keys do not share
+    // buckets, cache lines and pages just because they are adjacent
+    return fnv_hash64(zipfian()) % keys;
+  case KeyDistributionType::Hotspot:
+    if (uniform(gen) < dist.hotOpsPct / 100.0 || hotKeys == keys) {
+      return std::uniform_int_distribution<uint64_t>(0, hotKeys - 1)(gen);
+    }
+    return std::uniform_int_distribution<uint64_t>(hotKeys, keys - 1)(gen);
+  case KeyDistributionType::Sequential:
+    return sequence++ % keys;
+  case KeyDistributionType::Latest:
+    // the prefill inserts keys in ascending order, the newest are the
+    // highest ones
+    return keys - 1 - zipfian();
+  case KeyDistributionType::Uniform:
+  default:
+    return std::uniform_int_distribution<uint64_t>(0, keys - 1)(gen);
+  }
+}
+
+// Ranks count back from newestKey through the stream's inserts, then
+// through the prefill. They stay those of a zipfian over the prefilled
+// keys, where YCSB's SkewedLatestGenerator grows its key count with every
+// insert. The skew of the newest keys is about the same.
+uint64_t KeyGenerator::next(uint64_t inserted, uint64_t newestKey,
+                            uint64_t stride) {
+  if (dist.type != KeyDistributionType::Latest || inserted == 0) {
+    return next();
+  }
+  uint64_t rank = zipfian();
+  if (rank < inserted) {
+    return newestKey - rank * stride;
+  }
+  return keys - 1 - (rank - inserted);
+}
+
+void KeyGenerator::fill(uint64_t *seq, size_t n) {
+  for (size_t i = 0; i < n; ++i) {
+    seq[i] = next();
+  }
+}
@@ -0,0 +1,59 @@
+#ifndef CXLBENCH_KEYGENERATOR_H
+#define CXLBENCH_KEYGENERATOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+
+enum class KeyDistributionType {
+  Uniform,
+  Zipfian,
+  Hotspot,
+  Sequential,
+  Latest,
+};
+
+// zipfian and latest are skewed by zipfTheta in (0, 1), hotspot sends
+// hotOpsPct percent of the operations to the lowest hotKeysPct percent of
+// the keys
+struct KeyDistribution {
+  KeyDistributionType type;
+  double zipfTheta;
+  double hotOpsPct;
+  double hotKeysPct;
+};
+
+bool parse_key_distribution(const std::string &name,
+                            KeyDistributionType *type);
+const char *key_distribution_name(KeyDistributionType type);
+
+// Draws keys in [0, keys) of a prefilled map
+class KeyGenerator {
+public:
+  KeyGenerator(const KeyDistribution &dist, uint64_t keys);
+  uint64_t next();
+  // Like next(), but latest also counts the keys one insert stream added
+  // after the prefill, inserted of them ending at newestKey and stride
+  // apart, as the newest ones
+  uint64_t next(uint64_t inserted, uint64_t newestKey, uint64_t stride);
+  void fill(uint64_t *seq, size_t n);
+
+private:
+  uint64_t zipfian();
+
+  KeyDistribution dist;
+  uint64_t keys;
+  uint64_t hotKeys;
+  uint64_t sequence;
+  std::mt19937_64 gen;
+  std::uniform_real_distribution<double> uniform;
+  // YCSB zipfian constants, see Gray et al., "Quickly Generating
+  // Billion-Record Synthetic Databases", SIGMOD 1994
+  double zetan;
+  double theta;
+  double alpha;
+  double eta;
+};
+
+#endif
@@ -5,23 +5,20 @@
 #include <numa.h>
 #include <numaif.h>
 
-#include <chrono>
 #include <iostream>
-#include <random>
-#include <thread>
 
 #include "LibcdsBronsonAVLTreeMapBench.hh"
+#include "BenchRegistry.hh"
+#include "LibcdsRunner.hh"
+#include "RolesRunner.hh"
+#include "WorkloadRunner.hh"
 #include "utils.hh"
 
-typedef cds::container::BronsonAVLTreeMap<
-    cds::urcu::gc<cds::urcu::general_buffered<>>, uint64_t, uint64_t>
-    map_t;
+typedef BronsonAVLTreeMapT map_t;
 
-CXLBench<map_t>::CXLBench(size_t size, int mapNumaNode, int setterNumaNode,
-                          int getterNumaNode, int setterCore, int getterCore)
-    : size(size), mapNumaNode(mapNumaNode), setterNumaNode(setterNumaNode),
-      getterNumaNode(getterNumaNode), setterCore(setterCore),
-      getterCore(getterCore), setterSeq(nullptr), getterSeq(nullptr) {}
+CXLBench<map_t>::CXLBench(const CXLBenchConfig &config)
+    : size(config.size), metaNumaNode(config.dsMetaNumaNode),
+      config(config) {}
 
 void CXLBench<map_t>::init() {
   // key: uint64_t, val: uint64_t
@@ -29,7 +26,7 @@ void CXLBench<map_t>::init() {
   std::cout << "Size of map: " << size << std::endl;
   std::cout << "Number of entries in map: " << mapEntriesNum << std::endl;
 
-  m = static_cast<map_t *>(numa_alloc_onnode(sizeof(map_t), mapNumaNode));
+  m = static_cast<map_t *>(numa_alloc_onnode(sizeof(map_t), metaNumaNode));
   new (m) map_t();
 
   for (size_t i = 0; i < mapEntriesNum; ++i) {
@@ -39,102 +36,100 @@ void CXLBench<map_t>::init() {
         break;
     }
   }
+
+  report_placement("map object", m, sizeof(map_t));
+  numa_arena_report();
 }
 
 void CXLBench<map_t>::run(size_t rounds) {
-  setterSeq = static_cast<uint64_t *>(
-      numa_alloc_onnode(rounds * sizeof(uint64_t), setterNumaNode));
-  getterSeq = static_cast<uint64_t *>(
-      numa_alloc_onnode(rounds * sizeof(uint64_t), getterNumaNode));
-
-  std::random_device rd;
-  std::mt19937 gen(rd());
-  std::uniform_int_distribution<uint64_t> distrib(0, mapEntriesNum);
-
-  for (size_t i = 0; i < rounds; ++i) {
-    setterSeq[i] = distrib(gen);
-    getterSeq[i] = distrib(gen);
+  if (config.workload.enabled) {
+    runWorkload(rounds);
+    return;
   }
 
-  decltype(std::chrono::steady_clock::now()) setterStart;
-  decltype(std::chrono::steady_clock::now()) getterStart;
-  decltype(std::chrono::steady_clock::now()) setterEnd;
-  decltype(std::chrono::steady_clock::now()) getterEnd;
-
-  std::thread set_thread([this, rounds, &setterStart, &setterEnd]() {
-    set_thread_affinity(pthread_self(), this->setterCore);
-    bind_numa_node(this->mapNumaNode);
+  run_roles(
+      config, mapEntriesNum, rounds,
+      [this](uint64_t key) {
+        auto map_updater = [](bool bNew, map_t::key_type const &key,
+                              map_t::mapped_type &item) {
+          if (!bNew) { // key already exists, overwrite its val
+            store_value(item, key + 1);
+          }
+        };
+        while (true) {
+          auto res = m->update(key, map_updater);
+          if (res.first) {
+            break;
+          }
+        }
+      },
+      [this](uint64_t key) {
+        auto map_get_val = [](map_t::key_type const &key,
+                              map_t::mapped_type &item) { load_value(item); };
+        while (true) {
+          if (m->find(key, map_get_val))
+            break;
+        }
+      },
+      [](auto &thread) {
+        // Attach the thread to libcds infrastructure
+        cds::threading::Manager::attachThread();
+        thread.run();
+        // Detach thread when terminating
+        cds::threading::Manager::detachThread();
+      });
+}
 
+void CXLBench<map_t>::runWorkload(size_t rounds) {
+  run_workload(config, mapEntriesNum, rounds, [this](WorkloadThread &thread) {
     // Attach the thread to libcds infrastructure
     cds::threading::Manager::attachThread();
 
-    auto map_updater = [](bool bNew, map_t::key_type const &key,
-                          map_t::mapped_type &item) {
-      if (!bNew) { // key already exists, increment val by 1
-        item = item + 1;
+    thread.run([this](const WorkloadOp &op) {
+      uint64_t val;
+      auto map_get_val = [&val](map_t::key_type const &key,
+                                map_t::mapped_type &item) {
+        val = load_value(item);
+      };
+
+      switch (op.op) {
+      case MapOp::Read:
+        return m->find(op.key, map_get_val);
+      case MapOp::Update: {
+        auto map_updater = [&op](bool, map_t::key_type const &key,
+                                 map_t::mapped_type &item) {
+          store_value(item, op.key + 1);
+        };
+        return m->update(op.key, map_updater, false).first;
       }
-    };
-
-    setterStart = std::chrono::steady_clock::now();
-
-    for (size_t i = 0; i < rounds; ++i) {
-      // std::cout << "setter: " << i << " " << this->setterSeq[i] << std::endl;
-      while (true) {
-        auto res = m->update(this->setterSeq[i], map_updater);
-        if (res.first) {
-          break;
+      case MapOp::Insert:
+        return m->insert(op.key, op.key);
+      case MapOp::ReadModifyWrite: {
+        if (!m->find(op.key, map_get_val)) {
+          return false;
         }
+        auto map_updater = [val](bool, map_t::key_type const &key,
+                                 map_t::mapped_type &item) {
+          store_value(item, val + 1);
+        };
+        return m->update(op.key, map_updater, false).first;
       }
-    }
-
-    setterEnd = std::chrono::steady_clock::now();
-
-    // Detach thread when terminating
-    cds::threading::Manager::detachThread();
-  });
-
-  std::thread get_thread([this, rounds, &getterStart, &getterEnd]() {
-    set_thread_affinity(pthread_self(), this->getterCore);
-    // bind_numa_node(this->mapNumaNode);
-
-    // Attach the thread to libcds infrastructure
-    cds::threading::Manager::attachThread();
-
-    uint64_t val;
-
-    auto map_get_val = [&val](map_t::key_type const &key,
-                              map_t::mapped_type &item) { val = item; };
-
-    getterStart = std::chrono::steady_clock::now();
-
-    for (size_t i = 0; i < rounds; ++i) {
-      // std::cout << "getter: " << i << " " << this->getterSeq[i] << std::endl;
-      while (true) {
-        if (m->find(this->getterSeq[i], map_get_val))
-          break;
+      case MapOp::Delete:
+        return m->erase(op.key);
+      case MapOp::Scan: {
+        bool hit = false;
+        for (uint32_t i = 0; i < op.scanLength; ++i) {
+          hit |= m->find(op.key + i, map_get_val);
+        }
+        return hit;
       }
-    } // Destructor of guarded_ptr releases internal HP guard
-
-    getterEnd = std::chrono::steady_clock::now();
+      }
+      return false;
+    });
 
     // Detach thread when terminating
     cds::threading::Manager::detachThread();
   });
-
-  set_thread.join();
-  get_thread.join();
-
-  numa_free(setterSeq, rounds * sizeof(uint64_t));
-  numa_free(getterSeq, rounds * sizeof(uint64_t));
-  setterSeq = nullptr;
-  getterSeq = nullptr;
-
-  auto start = std::min(setterStart, getterStart);
-  auto end   = std::max(setterEnd, getterEnd);
-
-  std::cout << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start)
-                   .count()
-            << " ns" << std::endl;
 }
 
 void CXLBench<map_t>::clean() {
@@ -142,3 +137,10 @@ void CXLBench<map_t>::clean() {
   numa_free(m, sizeof(map_t));
   m = nullptr;
 }
+
+static BenchRegistration registration(
+    "libcds_bronsonavltreemap_map", "libcds general_buffered RCU",
+    {.keyValue = true}, [](const CXLBenchConfig &config, size_t rounds) {
+      run_libcds_bench<map_t, cds::urcu::gc<cds::urcu::general_buffered<>>>(
+          config, rounds);
+    });
@@ -2,32 +2,37 @@
 #define CXLBENCH_LIBCDS_BRONSONAVLTREEMAP_H
 
 #include "CXLBench.hh"
+#include "NUMAArena.hh"
 
 #include <cds/urcu/general_buffered.h>
 
 #include <cds/container/bronson_avltree_map_rcu.h>
 
-template <>
-class CXLBench<cds::container::BronsonAVLTreeMap<
-    cds::urcu::gc<cds::urcu::general_buffered<>>, uint64_t, uint64_t>> {
+// Tree nodes are the metadata, the values they point to the entries
+struct BronsonAVLTreeMapTraits
+    : public cds::container::bronson_avltree::traits {
+  typedef NUMAMetadataAllocator<int> node_allocator;
+  typedef NUMAEntryAllocator<int> allocator;
+};
+
+typedef cds::container::BronsonAVLTreeMap<
+    cds::urcu::gc<cds::urcu::general_buffered<>>, uint64_t, uint64_t,
+    BronsonAVLTreeMapTraits>
+    BronsonAVLTreeMapT;
+
+template <> class CXLBench<BronsonAVLTreeMapT> {
 private:
-  cds::container::BronsonAVLTreeMap<
-      cds::urcu::gc<cds::urcu::general_buffered<>>, uint64_t, uint64_t> *m;
+  BronsonAVLTreeMapT *m;
   size_t size;
   size_t mapEntriesNum;
-  int mapNumaNode;
-  int setterNumaNode;
-  int getterNumaNode;
-  int setterCore;
-  int getterCore;
-  uint64_t *setterSeq;
-  uint64_t *getterSeq;
+  int metaNumaNode;
+  CXLBenchConfig config;
 
 public:
-  CXLBench(size_t size, int mapNumaNode, int setterNumaNode, int getterNumaNode,
-           int setterCore, int getterCore);
+  CXLBench(const CXLBenchConfig &config);
   void init();
   void run(size_t rounds);
+  void runWorkload(size_t rounds);
   void clean();
 };
 
@@ -2,31 +2,35 @@
 #define CXLBENCH_LIBCDS_FELDMANHASHMAP_H
 
 #include "CXLBench.hh"
+#include "NUMAArena.hh"
 
 #include <cds/container/feldman_hashmap_hp.h>
 #include <cds/gc/hp.h> // for cds::HP (Hazard Pointer) SMR
 #include <cds/init.h>  // for cds::Initialize and cds::Terminate
 
-template <>
-class CXLBench<
-    cds::container::FeldmanHashMap<cds::gc::HP, uint64_t, uint64_t>> {
+// Array nodes are the metadata, data nodes the entries
+struct FeldmanMapTraits : public cds::container::feldman_hashmap::traits {
+  typedef NUMAMetadataAllocator<int> node_allocator;
+  typedef NUMAEntryAllocator<int> allocator;
+};
+
+typedef cds::container::FeldmanHashMap<cds::gc::HP, uint64_t, uint64_t,
+                                       FeldmanMapTraits>
+    FeldmanHashMapT;
+
+template <> class CXLBench<FeldmanHashMapT> {
 private:
-  cds::container::FeldmanHashMap<cds::gc::HP, uint64_t, uint64_t> *m;
+  FeldmanHashMapT *m;
   size_t size;
   size_t mapEntriesNum;
-  int mapNumaNode;
-  int setterNumaNode;
-  int getterNumaNode;
-  int setterCore;
-  int getterCore;
-  uint64_t *setterSeq;
-  uint64_t *getterSeq;
+  int metaNumaNode;
+  CXLBenchConfig config;
 
 public:
-  CXLBench(size_t size, int mapNumaNode, int setterNumaNode, int getterNumaNode,
-           int setterCore, int getterCore);
+  CXLBench(const CXLBenchConfig &config);
   void init();
   void run(size_t rounds);
+  void runWorkload(size_t rounds);
   void clean();
 };
 
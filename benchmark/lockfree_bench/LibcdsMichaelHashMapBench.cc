@@ -5,23 +5,22 @@
 #include <numa.h>
 #include <numaif.h>
 
-#include <chrono>
 #include <iostream>
-#include <random>
-#include <thread>
 
 #include "LibcdsMichaelHashMapBench.hh"
+#include "BenchRegistry.hh"
+#include "LibcdsRunner.hh"
+#include "RolesRunner.hh"
+#include "WorkloadRunner.hh"
 #include "utils.hh"
 
 typedef cds::container::MichaelHashMap<cds::gc::HP, MichaelListT,
                                        MichaelMapTraits>
     map_t;
 
-CXLBench<map_t>::CXLBench(size_t size, int mapNumaNode, int setterNumaNode,
-                          int getterNumaNode, int setterCore, int getterCore)
-    : size(size), mapNumaNode(mapNumaNode), setterNumaNode(setterNumaNode),
-      getterNumaNode(getterNumaNode), setterCore(setterCore),
-      getterCore(getterCore), setterSeq(nullptr), getterSeq(nullptr) {}
+CXLBench<map_t>::CXLBench(const CXLBenchConfig &config)
+    : size(config.size), metaNumaNode(config.dsMetaNumaNode),
+      config(config) {}
 
 void CXLBench<map_t>::init() {
   // key: uint64_t, val: uint64_t
@@ -29,7 +28,7 @@ void CXLBench<map_t>::init() {
   std::cout << "Size of map: " << size << std::endl;
   std::cout << "Number of entries in map: " << mapEntriesNum << std::endl;
 
-  m = static_cast<map_t *>(numa_alloc_onnode(sizeof(map_t), mapNumaNode));
+  m = static_cast<map_t *>(numa_alloc_onnode(sizeof(map_t), metaNumaNode));
   new (m) map_t(mapEntriesNum, 1);
 
   for (size_t i = 0; i < mapEntriesNum; ++i) {
@@ -38,101 +37,100 @@ void CXLBench<map_t>::init() {
         break;
     }
   }
+
+  report_placement("map object", m, sizeof(map_t));
+  numa_arena_report();
 }
 
 void CXLBench<map_t>::run(size_t rounds) {
-  setterSeq = static_cast<uint64_t *>(
-      numa_alloc_onnode(rounds * sizeof(uint64_t), setterNumaNode));
-  getterSeq = static_cast<uint64_t *>(
-      numa_alloc_onnode(rounds * sizeof(uint64_t), getterNumaNode));
-
-  std::random_device rd;
-  std::mt19937 gen(rd());
-  std::uniform_int_distribution<uint64_t> distrib(0, mapEntriesNum);
-
-  for (size_t i = 0; i < rounds; ++i) {
-    setterSeq[i] = distrib(gen);
-    getterSeq[i] = distrib(gen);
+  if (config.workload.enabled) {
+    runWorkload(rounds);
+    return;
   }
 
-  decltype(std::chrono::steady_clock::now()) setterStart;
-  decltype(std::chrono::steady_clock::now()) getterStart;
-  decltype(std::chrono::steady_clock::now()) setterEnd;
-  decltype(std::chrono::steady_clock::now()) getterEnd;
-
-  std::thread set_thread([this, rounds, &setterStart, &setterEnd]() {
-    set_thread_affinity(pthread_self(), this->setterCore);
-    bind_numa_node(this->mapNumaNode);
+  run_roles(
+      config, mapEntriesNum, rounds,
+      [this](uint64_t key) {
+        auto map_updater = [key](bool ifInserted, map_t::value_type &kv) {
+          if (!ifInserted) { // key already exists, overwrite its val
+            store_value(kv.second, key + 1);
+          }
+        };
+        while (true) {
+          auto res = m->update(key, map_updater);
+          if (res.first) {
+            break;
+          }
+        }
+      },
+      [this](uint64_t key) {
+        while (true) {
+          map_t::guarded_ptr gp(m->get(key));
+          if (gp) {
+            load_value(gp->second);
+            break;
+          }
+        }
+      },
+      [](auto &thread) {
+        // Attach the thread to libcds infrastructure
+        cds::threading::Manager::attachThread();
+        thread.run();
+        // Detach thread when terminating
+        cds::threading::Manager::detachThread();
+      });
+}
 
+void CXLBench<map_t>::runWorkload(size_t rounds) {
+  run_workload(config, mapEntriesNum, rounds, [this](WorkloadThread &thread) {
     // Attach the thread to libcds infrastructure
     cds::threading::Manager::attachThread();
 
-    auto map_updater = [](bool ifInserted, map_t::value_type &kv) {
-      if (!ifInserted) { // key already exists, increment val by 1
-        kv.second = kv.second + 1;
+    thread.run([this](const WorkloadOp &op) {
+      switch (op.op) {
+      case MapOp::Read: {
+        map_t::guarded_ptr gp(m->get(op.key));
+        return static_cast<bool>(gp);
       }
-    };
-
-    setterStart = std::chrono::steady_clock::now();
-
-    for (size_t i = 0; i < rounds; ++i) {
-      // std::cout << "setter: " << i << " " << this->setterSeq[i] << std::endl;
-      while (true) {
-        auto res = m->update(this->setterSeq[i], map_updater);
-        if (res.first) {
-          break;
+      case MapOp::Update: {
+        auto map_updater = [&op](bool, map_t::value_type &kv) {
+          store_value(kv.second, op.key + 1);
+        };
+        return m->update(op.key, map_updater, false).first;
+      }
+      case MapOp::Insert:
+        return m->insert(op.key, op.key);
+      case MapOp::ReadModifyWrite: {
+        uint64_t val;
+        {
+          map_t::guarded_ptr gp(m->get(op.key));
+          if (!gp) {
+            return false;
+          }
+          val = load_value(gp->second);
         }
+        auto map_updater = [val](bool, map_t::value_type &kv) {
+          store_value(kv.second, val + 1);
+        };
+        return m->update(op.key, map_updater, false).first;
       }
-    }
-
-    setterEnd = std::chrono::steady_clock::now();
-
-    // Detach thread when terminating
-    cds::threading::Manager::detachThread();
-  });
-
-  std::thread get_thread([this, rounds, &getterStart, &getterEnd]() {
-    set_thread_affinity(pthread_self(), this->getterCore);
-    // bind_numa_node(this->mapNumaNode);
-
-    // Attach the thread to libcds infrastructure
-    cds::threading::Manager::attachThread();
-
-    uint64_t val;
-
-    getterStart = std::chrono::steady_clock::now();
-
-    for (size_t i = 0; i < rounds; ++i) {
-      // std::cout << "getter: " << i << " " << this->getterSeq[i] << std::endl;
-      while (true) {
-        map_t::guarded_ptr gp(m->get(this->getterSeq[i]));
-        if (gp) {
-          val = gp->second;
-          break;
+      case MapOp::Delete:
+        return m->erase(op.key);
+      case MapOp::Scan: {
+        bool hit = false;
+        for (uint32_t i = 0; i < op.scanLength; ++i) {
+          map_t::guarded_ptr gp(m->get(op.key + i));
+          hit |= static_cast<bool>(gp);
         }
+        return hit;
       }
-    } // Destructor of guarded_ptr releases internal HP guard
-
-    getterEnd = std::chrono::steady_clock::now();
+      }
+      return false;
+    });
 
     // Detach thread when terminating
     cds::threading::Manager::detachThread();
   });
-
-  set_thread.join();
-  get_thread.join();
-
-  numa_free(setterSeq, rounds * sizeof(uint64_t));
-  numa_free(getterSeq, rounds * sizeof(uint64_t));
-  setterSeq = nullptr;
-  getterSeq = nullptr;
-
-  auto start = std::min(setterStart, getterStart);
-  auto end   = std::max(setterEnd, getterEnd);
-
-  std::cout << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start)
-                   .count()
-            << " ns" << std::endl;
 }
 
 void CXLBench<map_t>::clean() {
@@ -140,3 +138,9 @@ void CXLBench<map_t>::clean() {
   numa_free(m, sizeof(map_t));
   m = nullptr;
 }
+
+static BenchRegistration registration(
+    "libcds_michaelhashmap_map", "libcds hazard pointers", {.keyValue = true},
+    [](const CXLBenchConfig &config, size_t rounds) {
+      run_libcds_bench<map_t, cds::gc::HP>(config, rounds);
+    });
@@ -2,15 +2,17 @@
 #define CXLBENCH_LIBCDS_MICHAELHASHMAP_H
 
 #include "CXLBench.hh"
+#include "NUMAArena.hh"
 
 #include <cds/container/michael_kvlist_hp.h> // MichaelKVList for gc::HP
 #include <cds/container/michael_map.h>       // MichaelHashMap
 #include <cds/gc/hp.h>                       // for cds::HP (Hazard Pointer) SMR
 #include <cds/init.h> // for cds::Initialize and cds::Terminate
 
-// List traits based on std::less predicate
+// List traits based on std::less predicate, list nodes are the entries
 struct MichaelListTraits : public cds::container::michael_list::traits {
   typedef std::less<uint64_t> less;
+  typedef NUMAEntryAllocator<int> allocator;
 };
 
 // Ordered list
@@ -18,8 +20,9 @@ typedef cds::container::MichaelKVList<cds::gc::HP, uint64_t, uint64_t,
                                       MichaelListTraits>
     MichaelListT;
 
-// Map traits
+// Map traits, the bucket table is the metadata
 struct MichaelMapTraits : public cds::container::michael_map::traits {
+  typedef NUMAMetadataAllocator<int> allocator;
   struct hash {
     size_t operator()(uint64_t i) const {
       return cds::opt::v::hash<uint64_t>()(i);
@@ -35,19 +38,14 @@ private:
       *m;
   size_t size;
   size_t mapEntriesNum;
-  int mapNumaNode;
-  int setterNumaNode;
-  int getterNumaNode;
-  int setterCore;
-  int getterCore;
-  uint64_t *setterSeq;
-  uint64_t *getterSeq;
+  int metaNumaNode;
+  CXLBenchConfig config;
 
 public:
-  CXLBench(size_t size, int mapNumaNode, int setterNumaNode, int getterNumaNode,
-           int setterCore, int getterCore);
+  CXLBench(const CXLBenchConfig &config);
   void init();
   void run(size_t rounds);
+  void runWorkload(size_t rounds);
   void clean();
 };
 
@@ -0,0 +1,32 @@
+#ifndef CXLBENCH_LIBCDSRUNNER_H
+#define CXLBENCH_LIBCDSRUNNER_H
+
+#include <cds/init.h> // for cds::Initialize and cds::Terminate
+
+#include "CXLBench.hh"
+
+// Runs one libcds map under a fresh GC of type GC, built from gcArgs. The
+// GC and libcds are torn down before returning, so every retired node has
+// been freed by then.
+template <typename T, typename GC, typename... Args>
+void run_libcds_bench(const CXLBenchConfig &config, size_t rounds,
+                      Args... gcArgs) {
+  // Initialize libcds
+  cds::Initialize();
+  {
+    GC gc(gcArgs...);
+    cds::threading::Manager::attachThread();
+
+    CXLBench<T> bench(config);
+    bench.init();
+    bench.run(rounds);
+    bench.clean();
+
+    // Detach thread when terminating
+    cds::threading::Manager::detachThread();
+  }
+  // Terminate libcds
+  cds::Terminate();
+}
+
+#endif
@@ -2,30 +2,34 @@
 #define CXLBENCH_LIBCDS_SKIPLISTMAP_H
 
 #include "CXLBench.hh"
+#include "NUMAArena.hh"
 
 #include <cds/container/skip_list_map_hp.h>
 #include <cds/gc/hp.h> // for cds::HP (Hazard Pointer) SMR
 #include <cds/init.h>  // for cds::Initialize and cds::Terminate
 
-template <>
-class CXLBench<cds::container::SkipListMap<cds::gc::HP, uint64_t, uint64_t>> {
+// Nodes and their towers are the entries, the head tower stays in the map
+struct SkipListMapTraits : public cds::container::skip_list::traits {
+  typedef NUMAEntryAllocator<int> allocator;
+};
+
+typedef cds::container::SkipListMap<cds::gc::HP, uint64_t, uint64_t,
+                                    SkipListMapTraits>
+    SkipListMapT;
+
+template <> class CXLBench<SkipListMapT> {
 private:
-  cds::container::SkipListMap<cds::gc::HP, uint64_t, uint64_t> *m;
+  SkipListMapT *m;
   size_t size;
   size_t mapEntriesNum;
-  int mapNumaNode;
-  int setterNumaNode;
-  int getterNumaNode;
-  int setterCore;
-  int getterCore;
-  uint64_t *setterSeq;
-  uint64_t *getterSeq;
+  int metaNumaNode;
+  CXLBenchConfig config;
 
 public:
-  CXLBench(size_t size, int mapNumaNode, int setterNumaNode, int getterNumaNode,
-           int setterCore, int getterCore);
+  CXLBench(const CXLBenchConfig &config);
   void init();
   void run(size_t rounds);
+  void runWorkload(size_t rounds);
   void clean();
 };
 
@@ -0,0 +1,155 @@
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <numa.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <map>
+#include <new>
+#include <string>
+
+#include "NUMAArena.hh"
+#include "utils.hh"
+
+namespace {
+
+// A thread's run and free lists of one arena, dropped whenever the arena
+// was initialized again since the thread last used it.
+struct ThreadCache {
+  uint64_t generation;
+  char *cur;
+  char *end;
+  void *freeList[NUMAArena::kSizeClasses];
+};
+
+thread_local ThreadCache threadCaches[kNUMAArenaRoles];
+uint64_t nextGeneration = 1;
+
+} // namespace
+
+void NUMAArena::init(int node) {
+  release();
+
+  std::lock_guard<std::mutex> guard(lock);
+  this->node = node;
+  generation.store(nextGeneration++, std::memory_order_relaxed);
+}
+
+void *NUMAArena::allocate(size_t bytes, size_t align) {
+  if (bytes > kMaxSmall || align > kSmallAlign) {
+    std::lock_guard<std::mutex> guard(lock);
+    return bump(bytes, std::max<size_t>(align, 64));
+  }
+
+  ThreadCache &cache = threadCaches[static_cast<size_t>(role)];
+  uint64_t current   = generation.load(std::memory_order_relaxed);
+  if (cache.generation != current) {
+    cache = ThreadCache{current, nullptr, nullptr, {}};
+  }
+
+  size_t cls = bytes == 0 ? 0 : (bytes - 1) / kSmallAlign;
+  void *p    = cache.freeList[cls];
+  if (p != nullptr) {
+    cache.freeList[cls] = *static_cast<void **>(p);
+    return p;
+  }
+
+  size_t classSize = (cls + 1) * kSmallAlign;
+  if (static_cast<size_t>(cache.end - cache.cur) < classSize) {
+    std::lock_guard<std::mutex> guard(lock);
+    cache.cur = bump(kRunSize, kSmallAlign);
+    cache.end = cache.cur + kRunSize;
+  }
+  p = cache.cur;
+  cache.cur += classSize;
+  return p;
+}
+
+void NUMAArena::deallocate(void *p, size_t bytes, size_t align) {
+  // large blocks stay in their chunk until release()
+  if (p == nullptr || bytes > kMaxSmall || align > kSmallAlign) {
+    return;
+  }
+
+  ThreadCache &cache = threadCaches[static_cast<size_t>(role)];
+  uint64_t current   = generation.load(std::memory_order_relaxed);
+  if (cache.generation != current) {
+    cache = ThreadCache{current, nullptr, nullptr, {}};
+  }
+
+  size_t cls               = bytes == 0 ? 0 : (bytes - 1) / kSmallAlign;
+  *static_cast<void **>(p) = cache.freeList[cls];
+  cache.freeList[cls]      = p;
+}
+
+void NUMAArena::release() {
+  std::lock_guard<std::mutex> guard(lock);
+  for (Chunk &chunk : chunks) {
+    numa_free(chunk.base, chunk.size);
+  }
+  chunks.clear();
+  generation.store(0, std::memory_order_relaxed);
+}
+
+// called with lock held
+char *NUMAArena::bump(size_t bytes, size_t align) {
+  if (!chunks.empty()) {
+    Chunk &chunk  = chunks.back();
+    size_t offset = (chunk.used + align - 1) & ~(align - 1);
+    if (offset + bytes <= chunk.size) {
+      chunk.used = offset + bytes;
+      return chunk.base + offset;
+    }
+  }
+
+  size_t pageSize  = sysconf(_SC_PAGESIZE);
+  size_t chunkSize =
+      std::max(kChunkSize, (bytes + pageSize - 1) & ~(pageSize - 1));
+  char *base = static_cast<char *>(numa_alloc_onnode(chunkSize, node));
+  if (base == nullptr) {
+    throw std::bad_alloc();
+  }
+
+  // a block bigger than a chunk gets one of its own, and the partly used
+  // chunk stays the one to bump from
+  if (chunkSize > kChunkSize && !chunks.empty()) {
+    chunks.insert(chunks.end() - 1, Chunk{base, chunkSize, bytes});
+  } else {
+    chunks.push_back(Chunk{base, chunkSize, bytes});
+  }
+  return base;
+}
+
+void NUMAArena::report(const char *name) {
+  std::lock_guard<std::mutex> guard(lock);
+  std::map<int, size_t> pages;
+  for (const Chunk &chunk : chunks) {
+    count_page_nodes(chunk.base, chunk.used, pages);
+  }
+  report_placement(std::string(name) + " arena (node " +
+                       std::to_string(node) + ")",
+                   pages);
+}
+
+NUMAArena &numa_arena(NUMAArenaRole role) {
+  static NUMAArena arenas[kNUMAArenaRoles] = {
+      NUMAArena(NUMAArenaRole::Metadata), NUMAArena(NUMAArenaRole::Entries)};
+  return arenas[static_cast<size_t>(role)];
+}
+
+void numa_arena_init(int metaNode, int entryNode) {
+  numa_arena(NUMAArenaRole::Metadata).init(metaNode);
+  numa_arena(NUMAArenaRole::Entries).init(entryNode);
+}
+
+void numa_arena_report() {
+  numa_arena(NUMAArenaRole::Metadata).report("metadata");
+  numa_arena(NUMAArenaRole::Entries).report("entries");
+}
+
+void numa_arena_release() {
+  numa_arena(NUMAArenaRole::Metadata).release();
+  numa_arena(NUMAArenaRole::Entries).release();
+}
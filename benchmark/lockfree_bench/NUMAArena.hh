@@ -0,0 +1,107 @@
+#ifndef CXLBENCH_NUMAARENA_H
+#define CXLBENCH_NUMAARENA_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+// What a map allocates through its allocator hooks: the index part of the
+// structure (bucket tables, array nodes, tree nodes) or its key/value
+// entries (list and skiplist nodes, values, hash array cells).
+enum class NUMAArenaRole { Metadata, Entries };
+
+constexpr size_t kNUMAArenaRoles = 2;
+
+// Per-node arena. Memory comes in chunks from numa_alloc_onnode, so every
+// page of the arena is bound to its node whatever thread touches it first.
+// Small blocks are carved from per-thread runs into 16 byte size classes
+// and recycled through per-thread free lists. Larger blocks are bumped
+// from the shared chunk under a lock and only come back on release().
+//
+// release() unmaps every chunk, so it must run after everything that can
+// still free into the arena is gone, including the deferred reclamation
+// of libcds and junction.
+class NUMAArena {
+public:
+  static constexpr size_t kChunkSize   = 64 << 20;
+  static constexpr size_t kRunSize     = 256 << 10;
+  static constexpr size_t kSmallAlign  = 16;
+  static constexpr size_t kMaxSmall    = 512;
+  static constexpr size_t kSizeClasses = kMaxSmall / kSmallAlign;
+
+  explicit NUMAArena(NUMAArenaRole role) : role(role) {}
+  ~NUMAArena() { release(); }
+
+  void init(int node);
+  void *allocate(size_t bytes, size_t align);
+  void deallocate(void *p, size_t bytes, size_t align);
+  void release();
+
+  int numaNode() const { return node; }
+  // prints the node of every page handed out so far, found by move_pages
+  void report(const char *name);
+
+private:
+  struct Chunk {
+    char *base;
+    size_t size;
+    size_t used;
+  };
+
+  char *bump(size_t bytes, size_t align);
+
+  NUMAArenaRole role;
+  int node = 0;
+  // read by allocate and deallocate without the lock, init and release
+  // change it between runs
+  std::atomic<uint64_t> generation{0};
+  std::mutex lock;
+  std::vector<Chunk> chunks;
+};
+
+NUMAArena &numa_arena(NUMAArenaRole role);
+void numa_arena_init(int metaNode, int entryNode);
+void numa_arena_report();
+void numa_arena_release();
+
+// Stateless std allocator over one of the two process-wide arenas, for the
+// allocator hooks of libcds (opt::allocator) and Folly (Allocator).
+template <typename T, NUMAArenaRole Role> class NUMAArenaAllocator {
+public:
+  typedef T value_type;
+
+  template <typename U> struct rebind {
+    typedef NUMAArenaAllocator<U, Role> other;
+  };
+
+  NUMAArenaAllocator() = default;
+  template <typename U>
+  NUMAArenaAllocator(const NUMAArenaAllocator<U, Role> &) {}
+
+  T *allocate(size_t n) {
+    return static_cast<T *>(
+        numa_arena(Role).allocate(n * sizeof(T), alignof(T)));
+  }
+
+  void deallocate(T *p, size_t n) {
+    numa_arena(Role).deallocate(p, n * sizeof(T), alignof(T));
+  }
+
+  template <typename U>
+  bool operator==(const NUMAArenaAllocator<U, Role> &) const {
+    return true;
+  }
+  template <typename U>
+  bool operator!=(const NUMAArenaAllocator<U, Role> &) const {
+    return false;
+  }
+};
+
+template <typename T>
+using NUMAMetadataAllocator = NUMAArenaAllocator<T, NUMAArenaRole::Metadata>;
+template <typename T>
+using NUMAEntryAllocator = NUMAArenaAllocator<T, NUMAArenaRole::Entries>;
+
+#endif
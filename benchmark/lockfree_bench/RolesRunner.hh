@@ -0,0 +1,128 @@
+#ifndef CXLBENCH_ROLESRUNNER_H
+#define CXLBENCH_ROLESRUNNER_H
+
+#include <numa.h>
+
+#include <barrier>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "CXLBench.hh"
+#include "KeyGenerator.hh"
+#include "utils.hh"
+
+// One thread's view of a setter/getter run. run() applies the op of the
+// thread's role to each key of its sequence. quiesce, when given, is called
+// every quiesceInterval operations outside of the latency samples.
+template <typename SetOp, typename GetOp> class RoleThread {
+public:
+  RoleThread(ThreadResult &result, bool setter, const uint64_t *seq, size_t n,
+             std::barrier<> &startBarrier, SetOp &setOp, GetOp &getOp)
+      : result(result), setter(setter), seq(seq), n(n),
+        startBarrier(startBarrier), setOp(setOp), getOp(getOp) {}
+
+  bool isSetter() const { return setter; }
+
+  void run() { run([]() {}, 0); }
+
+  template <typename Quiesce>
+  void run(Quiesce quiesce, size_t quiesceInterval) {
+    if (setter) {
+      loop(setOp, quiesce, quiesceInterval);
+    } else {
+      loop(getOp, quiesce, quiesceInterval);
+    }
+  }
+
+private:
+  template <typename Op, typename Quiesce>
+  void loop(Op &op, Quiesce &quiesce, size_t quiesceInterval) {
+    startBarrier.arrive_and_wait();
+    result.start = std::chrono::steady_clock::now();
+
+    for (size_t i = 0; i < n; ++i) {
+      uint64_t tsc = result.latency.begin();
+      op(seq[i]);
+      result.latency.end(tsc);
+      if (quiesceInterval != 0 && i % quiesceInterval == 0) {
+        quiesce();
+      }
+    }
+
+    result.end = std::chrono::steady_clock::now();
+  }
+
+  ThreadResult &result;
+  bool setter;
+  const uint64_t *seq;
+  size_t n;
+  std::barrier<> &startBarrier;
+  SetOp &setOp;
+  GetOp &getOp;
+};
+
+// Runs setOp on one thread per setter core and getOp on one thread per
+// getter core, each over its own `rounds` keys of `keys` drawn from
+// keyDist and allocated on its role's NUMA node. body(RoleThread &) sets
+// up the structure's per-thread state and calls run() on the thread.
+template <typename SetOp, typename GetOp, typename Body>
+void run_roles(const CXLBenchConfig &config, uint64_t keys, size_t rounds,
+               SetOp setOp, GetOp getOp, Body body) {
+  size_t setters = config.setterCores.size();
+  size_t getters = config.getterCores.size();
+
+  uint64_t *setterSeq = static_cast<uint64_t *>(numa_alloc_onnode(
+      setters * rounds * sizeof(uint64_t), config.setterNumaNode));
+  uint64_t *getterSeq = static_cast<uint64_t *>(numa_alloc_onnode(
+      getters * rounds * sizeof(uint64_t), config.getterNumaNode));
+
+  KeyGenerator keyGen(config.keyDist, keys);
+  keyGen.fill(setterSeq, setters * rounds);
+  keyGen.fill(getterSeq, getters * rounds);
+
+  std::vector<ThreadResult> setterResults(setters);
+  std::vector<ThreadResult> getterResults(getters);
+  std::barrier startBarrier(setters + getters);
+  std::vector<std::thread> pool;
+
+  for (size_t t = 0; t < setters + getters; ++t) {
+    pool.emplace_back([&, t]() {
+      bool setter          = t < setters;
+      size_t idx           = setter ? t : t - setters;
+      ThreadResult &result = setter ? setterResults[idx] : getterResults[idx];
+      result.core =
+          setter ? config.setterCores[idx] : config.getterCores[idx];
+      result.ops = rounds;
+      result.latency.init(config.sampleInterval);
+      set_thread_affinity(pthread_self(), result.core);
+      if (setter) {
+        bind_numa_node(config.dsEntryNumaNode);
+      }
+
+      const uint64_t *seq = (setter ? setterSeq : getterSeq) + idx * rounds;
+      RoleThread<SetOp, GetOp> thread(result, setter, seq, rounds,
+                                      startBarrier, setOp, getOp);
+      body(thread);
+    });
+  }
+
+  for (auto &thread : pool) {
+    thread.join();
+  }
+
+  numa_free(setterSeq, setters * rounds * sizeof(uint64_t));
+  numa_free(getterSeq, getters * rounds * sizeof(uint64_t));
+
+  report_results("insert", setterResults, "find", getterResults);
+}
+
+// For structures without per-thread state
+template <typename SetOp, typename GetOp>
+void run_roles(const CXLBenchConfig &config, uint64_t keys, size_t rounds,
+               SetOp setOp, GetOp getOp) {
+  run_roles(config, keys, rounds, setOp, getOp,
+            [](RoleThread<SetOp, GetOp> &thread) { thread.run(); });
+}
+
+#endif
@@ -0,0 +1,135 @@
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <random>
+
+#include "Workload.hh"
+
+static const char *opNames[kMapOps] = {
+    "read", "update", "insert", "read-modify-write", "delete", "scan",
+};
+
+// YCSB core workloads A-F
+static const struct {
+  const char *name;
+  double pct[kMapOps];
+} presets[] = {
+    {"A", {50, 50, 0, 0, 0, 0}}, {"B", {95, 5, 0, 0, 0, 0}},
+    {"C", {100, 0, 0, 0, 0, 0}}, {"D", {95, 0, 5, 0, 0, 0}},
+    {"E", {0, 0, 5, 0, 0, 95}},  {"F", {50, 0, 0, 50, 0, 0}},
+};
+
+// YCSB's default maxscanlength
+static const uint32_t kMaxScanLength = 100;
+
+bool parse_workload(const std::string &name, WorkloadMix *mix) {
+  for (const auto &preset : presets) {
+    if (name == preset.name) {
+      mix->enabled = true;
+      for (size_t i = 0; i < kMapOps; ++i) {
+        mix->pct[i] = preset.pct[i];
+      }
+      return true;
+    }
+  }
+  return false;
+}
+
+// read, update, insert, read-modify-write, delete and an optional scan
+bool parse_workload_mix(const std::vector<double> &pct, WorkloadMix *mix) {
+  if (pct.size() != kMapOps && pct.size() != kMapOps - 1) {
+    return false;
+  }
+
+  double sum = 0.0;
+  for (size_t i = 0; i < kMapOps; ++i) {
+    mix->pct[i] = i < pct.size() ? pct[i] : 0.0;
+    if (mix->pct[i] < 0.0) {
+      return false;
+    }
+    sum += mix->pct[i];
+  }
+  mix->enabled = true;
+  return sum > 99.999 && sum < 100.001;
+}
+
+const char *map_op_name(MapOp op) { return opNames[static_cast<size_t>(op)]; }
+
+void generate_workload(const WorkloadMix &mix, KeyGenerator &keys,
+                       uint64_t firstNewKey, uint64_t stride, WorkloadOp *ops,
+                       size_t n) {
+  std::mt19937_64 gen(std::random_device{}());
+  std::uniform_real_distribution<double> uniform(0.0, 100.0);
+  std::uniform_int_distribution<uint32_t> scanLength(1, kMaxScanLength);
+  uint64_t newKey   = firstNewKey;
+  uint64_t inserted = 0;
+
+  for (size_t i = 0; i < n; ++i) {
+    double pick = uniform(gen);
+    size_t type = 0;
+    while (type < kMapOps - 1 && pick >= mix.pct[type]) {
+      pick -= mix.pct[type];
+      type++;
+    }
+    // rounding can leave pick past the last non-empty op
+    while (mix.pct[type] == 0.0 && type > 0) {
+      type--;
+    }
+
+    ops[i].op         = static_cast<MapOp>(type);
+    ops[i].scanLength = 0;
+    if (ops[i].op == MapOp::Insert) {
+      ops[i].key = newKey;
+      newKey += stride;
+      inserted++;
+    } else {
+      // latest favours this stream's own inserts, newest first
+      ops[i].key = keys.next(inserted, newKey - stride, stride);
+    }
+    if (ops[i].op == MapOp::Scan) {
+      ops[i].scanLength = scanLength(gen);
+    }
+  }
+}
+
+// Every line but the last starts with a word, the last one is the wall
+// time of the run that run_bench.py parses.
+void report_workload(const std::vector<WorkloadResult> &results) {
+  std::vector<ThreadResult> threads;
+  size_t count[kMapOps] = {};
+  size_t hits[kMapOps]  = {};
+  LatencyHistogram latency[kMapOps];
+
+  for (const WorkloadResult &r : results) {
+    threads.push_back(r.thread);
+    for (size_t type = 0; type < kMapOps; ++type) {
+      count[type] += r.count[type];
+      hits[type] += r.hits[type];
+      latency[type].merge(r.latency[type]);
+    }
+  }
+
+  auto start = threads[0].start;
+  auto end   = threads[0].end;
+  for (const ThreadResult &r : threads) {
+    start = std::min(start, r.start);
+    end   = std::max(end, r.end);
+  }
+  uint64_t ns = elapsed_ns(start, end);
+
+  std::cout << std::fixed << std::setprecision(2);
+  report_role("thread", threads);
+  for (size_t type = 0; type < kMapOps; ++type) {
+    if (count[type] == 0) {
+      continue;
+    }
+    std::cout << opNames[type] << ": " << count[type] << " ops, "
+              << hits[type] << " hits, " << mops(count[type], ns)
+              << " Mops/s" << std::endl;
+  }
+  for (size_t type = 0; type < kMapOps; ++type) {
+    report_latency(opNames[type], latency[type]);
+  }
+
+  std::cout << ns << " ns" << std::endl;
+}
@@ -0,0 +1,106 @@
+#ifndef CXLBENCH_WORKLOAD_H
+#define CXLBENCH_WORKLOAD_H
+
+#include <barrier>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "KeyGenerator.hh"
+#include "utils.hh"
+
+enum class MapOp : uint32_t {
+  Read,
+  Update,
+  Insert,
+  ReadModifyWrite,
+  Delete,
+  Scan,
+};
+
+constexpr size_t kMapOps = 6;
+
+// Percent of each MapOp in every thread's operation stream
+struct WorkloadMix {
+  bool enabled;
+  double pct[kMapOps];
+};
+
+bool parse_workload(const std::string &name, WorkloadMix *mix);
+bool parse_workload_mix(const std::vector<double> &pct, WorkloadMix *mix);
+const char *map_op_name(MapOp op);
+
+// A scan reads scanLength consecutive keys starting at key
+struct WorkloadOp {
+  uint64_t key;
+  MapOp op;
+  uint32_t scanLength;
+};
+
+// Inserted keys start at firstNewKey and advance by stride, so threads
+// given distinct offsets never insert the same key.
+void generate_workload(const WorkloadMix &mix, KeyGenerator &keys,
+                       uint64_t firstNewKey, uint64_t stride, WorkloadOp *ops,
+                       size_t n);
+
+struct alignas(64) WorkloadResult {
+  ThreadResult thread;
+  size_t count[kMapOps];
+  size_t hits[kMapOps];
+  LatencyHistogram latency[kMapOps];
+};
+
+void report_workload(const std::vector<WorkloadResult> &results);
+
+// One thread's view of a workload run. The structure specific body hands
+// run() a callable that executes one WorkloadOp and returns whether it
+// found, inserted or removed its key. quiesce, when given, is called every
+// quiesceInterval operations outside of the latency samples.
+class WorkloadThread {
+public:
+  WorkloadThread(WorkloadResult &result, const WorkloadOp *ops, size_t n,
+                 std::barrier<> &startBarrier)
+      : result(result), ops(ops), n(n), startBarrier(startBarrier) {}
+
+  template <typename Exec> void run(Exec exec) {
+    run(exec, []() {}, 0);
+  }
+
+  template <typename Exec, typename Quiesce>
+  void run(Exec exec, Quiesce quiesce, size_t quiesceInterval) {
+    size_t count[kMapOps] = {};
+    size_t hits[kMapOps]  = {};
+
+    startBarrier.arrive_and_wait();
+    result.thread.start = std::chrono::steady_clock::now();
+
+    for (size_t i = 0; i < n; ++i) {
+      const WorkloadOp &op = ops[i];
+      size_t type          = static_cast<size_t>(op.op);
+      uint64_t tsc         = result.latency[type].begin();
+      bool hit             = exec(op);
+      result.latency[type].end(tsc);
+      count[type]++;
+      hits[type] += hit;
+      if (quiesceInterval != 0 && i % quiesceInterval == 0) {
+        quiesce();
+      }
+    }
+
+    result.thread.end = std::chrono::steady_clock::now();
+
+    for (size_t type = 0; type < kMapOps; ++type) {
+      result.count[type] = count[type];
+      result.hits[type]  = hits[type];
+    }
+  }
+
+private:
+  WorkloadResult &result;
+  const WorkloadOp *ops;
+  size_t n;
+  std::barrier<> &startBarrier;
+};
+
+#endif
@@ -0,0 +1,69 @@
+#ifndef CXLBENCH_WORKLOADRUNNER_H
+#define CXLBENCH_WORKLOADRUNNER_H
+
+#include <numa.h>
+
+#include <barrier>
+#include <thread>
+#include <vector>
+
+#include "CXLBench.hh"
+#include "Workload.hh"
+#include "utils.hh"
+
+// Runs the mix on one thread per setter and getter core, each on its own
+// precomputed stream of `rounds` operations allocated on its role's NUMA
+// node. body(WorkloadThread &) sets up the structure's per-thread state
+// and calls run() on the thread.
+template <typename Body>
+void run_workload(const CXLBenchConfig &config, uint64_t keys, size_t rounds,
+                  Body body) {
+  std::vector<int> cores(config.setterCores);
+  cores.insert(cores.end(), config.getterCores.begin(),
+               config.getterCores.end());
+  size_t threads = cores.size();
+  size_t setters = config.setterCores.size();
+
+  KeyGenerator keyGen(config.keyDist, keys);
+  std::vector<WorkloadOp *> streams(threads);
+  for (size_t t = 0; t < threads; ++t) {
+    int node   = t < setters ? config.setterNumaNode : config.getterNumaNode;
+    streams[t] = static_cast<WorkloadOp *>(
+        numa_alloc_onnode(rounds * sizeof(WorkloadOp), node));
+    generate_workload(config.workload, keyGen, keys + t, threads, streams[t],
+                      rounds);
+  }
+
+  std::vector<WorkloadResult> results(threads);
+  std::barrier startBarrier(threads);
+  std::vector<std::thread> pool;
+
+  for (size_t t = 0; t < threads; ++t) {
+    pool.emplace_back([&, t]() {
+      WorkloadResult &result = results[t];
+      result.thread.core     = cores[t];
+      result.thread.ops      = rounds;
+      for (LatencyHistogram &latency : result.latency) {
+        latency.init(config.sampleInterval);
+      }
+      set_thread_affinity(pthread_self(), cores[t]);
+      // every thread of the mix may insert
+      bind_numa_node(config.dsEntryNumaNode);
+
+      WorkloadThread thread(result, streams[t], rounds, startBarrier);
+      body(thread);
+    });
+  }
+
+  for (auto &thread : pool) {
+    thread.join();
+  }
+
+  for (size_t t = 0; t < threads; ++t) {
+    numa_free(streams[t], rounds * sizeof(WorkloadOp));
+  }
+
+  report_workload(results);
+}
+
+#endif
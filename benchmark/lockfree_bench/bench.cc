@@ -5,22 +5,61 @@
 #include <sys/prctl.h>
 
 #include <iostream>
+#include <string>
+#include <vector>
 
 #include <cxxopts.hpp>
 
+#include "BenchRegistry.hh"
+#include "NUMAArena.hh"
 #include "utils.hh"
 
-#include "BoostMPMCQueueBench.hh"
-#include "BoostSPSCQueueBench.hh"
-#include "FollyAtomicHashMapBench.hh"
-#include "JunctionGrampaMapBench.hh"
-#include "JunctionLeapfrogMapBench.hh"
-#include "JunctionLinearMapBench.hh"
-#include "LibcdsBronsonAVLTreeMapBench.hh"
-#include "LibcdsFeldmanHashMapBench.hh"
-#include "LibcdsMichaelHashMapBench.hh"
-#include "LibcdsSkipListMapBench.hh"
-// #include "TervelWFHashMapBench.hh"
+// Threads of one role are placed on its core list round-robin, so a
+// single core with several threads oversubscribes that core.
+static std::vector<int> thread_cores(const std::vector<int> &cores,
+                                     size_t threads) {
+  if (threads == 0) {
+    return cores;
+  }
+
+  std::vector<int> placement;
+  for (size_t i = 0; i < threads && !cores.empty(); ++i) {
+    placement.push_back(cores[i % cores.size()]);
+  }
+  return placement;
+}
+
+static void list_benches() {
+  for (const BenchEntry &bench : BenchRegistry::instance().entries()) {
+    const BenchCapabilities &caps = bench.capabilities;
+    std::cout << bench.name << ": " << (caps.keyValue ? "map" : "queue")
+              << ", reclamation: " << bench.reclamation;
+    if (caps.singleSetterGetter) {
+      std::cout << ", one setter and one getter";
+    }
+    if (caps.batched) {
+      std::cout << ", batched";
+    }
+    if (!caps.inAll) {
+      std::cout << ", not in all";
+    }
+    std::cout << std::endl;
+  }
+}
+
+// returns why the structure cannot run this config, nullptr if it can
+static const char *unsupported(const BenchEntry &bench,
+                               const CXLBenchConfig &config) {
+  const BenchCapabilities &caps = bench.capabilities;
+  if (caps.singleSetterGetter &&
+      (config.setterCores.size() != 1 || config.getterCores.size() != 1)) {
+    return "runs exactly one setter and one getter";
+  }
+  if (config.workload.enabled && !caps.keyValue) {
+    return "takes no workload mix";
+  }
+  return nullptr;
+}
 
 int main(int argc, char *argv[]) {
   cxxopts::Options options("CXLBench", "");
@@ -28,38 +67,183 @@ int main(int argc, char *argv[]) {
   options.add_options()("list", "List all supported data structures",
                         cxxopts::value<bool>()->default_value("false"));
   options.add_options()(
-      "ds_type", "Data structure type",
-      cxxopts::value<std::string>()->default_value("boost_spsc_queue"));
+      "ds_type",
+      "Data structure types to run one after another, comma separated, or "
+      "all",
+      cxxopts::value<std::vector<std::string>>()->default_value(
+          "boost_spsc_queue"));
   options.add_options()("ds_size_mb", "Data structure's size in MB",
                         cxxopts::value<size_t>()->default_value("8"));
   options.add_options()("loop_rounds", "Loop rounds of operations",
                         cxxopts::value<size_t>()->default_value("1000000"));
-  options.add_options()("setter_core", "Setter thread CPU core binding",
-                        cxxopts::value<int>()->default_value("0"));
-  options.add_options()("getter_core", "Getter thread CPU core binding",
-                        cxxopts::value<int>()->default_value("1"));
+  options.add_options()(
+      "setter_core", "Setter threads CPU core binding, comma separated list",
+      cxxopts::value<std::vector<int>>()->default_value("0"));
+  options.add_options()(
+      "getter_core", "Getter threads CPU core binding, comma separated list",
+      cxxopts::value<std::vector<int>>()->default_value("1"));
+  options.add_options()(
+      "setter_threads",
+      "Number of setter threads, 0 runs one per setter core",
+      cxxopts::value<size_t>()->default_value("0"));
+  options.add_options()(
+      "getter_threads",
+      "Number of getter threads, 0 runs one per getter core",
+      cxxopts::value<size_t>()->default_value("0"));
+  options.add_options()(
+      "latency_sample_interval",
+      "Time every Nth operation of each thread into a latency histogram, "
+      "0 disables sampling",
+      cxxopts::value<size_t>()->default_value("0"));
+  options.add_options()(
+      "key_dist",
+      "Map key distribution: uniform, zipfian, hotspot, sequential, latest",
+      cxxopts::value<std::string>()->default_value("uniform"));
+  options.add_options()("zipf_theta",
+                        "Skew of the zipfian and latest distributions",
+                        cxxopts::value<double>()->default_value("0.99"));
+  options.add_options()("hotspot_ops_pct",
+                        "Percent of the operations on the hot keys",
+                        cxxopts::value<double>()->default_value("90"));
+  options.add_options()("hotspot_keys_pct",
+                        "Percent of the keys that are hot",
+                        cxxopts::value<double>()->default_value("10"));
+  options.add_options()(
+      "workload",
+      "Run every map thread on a YCSB core workload mix: A, B, C, D, E, F",
+      cxxopts::value<std::string>()->default_value(""));
+  options.add_options()(
+      "workload_mix",
+      "Run every map thread on a custom mix, comma separated percents of "
+      "read, update, insert, read-modify-write, delete and optionally scan",
+      cxxopts::value<std::vector<double>>());
+  options.add_options()(
+      "batch_size",
+      "Elements the cxl rings publish and consume with one index update",
+      cxxopts::value<size_t>()->default_value("1"));
   options.add_options()("setter_numa_node", "Setter thread numa node binding",
                         cxxopts::value<int>()->default_value("0"));
   options.add_options()("getter_numa_node", "Getter thread numa node binding",
                         cxxopts::value<int>()->default_value("0"));
   options.add_options()("ds_numa_node", "Data structure placement numa node",
                         cxxopts::value<int>()->default_value("0"));
+  options.add_options()(
+      "ds_meta_numa_node",
+      "Numa node of the map metadata, -1 places it on ds_numa_node",
+      cxxopts::value<int>()->default_value("-1"));
+  options.add_options()(
+      "ds_entry_numa_node",
+      "Numa node of the map entries, -1 places them on ds_numa_node",
+      cxxopts::value<int>()->default_value("-1"));
 
   auto opts_result = options.parse(argc, argv);
   if (opts_result["list"].as<bool>()) {
+    list_benches();
     return 0;
   }
 
-  std::string dsType = opts_result["ds_type"].as<std::string>();
-  size_t dsSizeMB    = opts_result["ds_size_mb"].as<size_t>();
-  size_t dsSize      = dsSizeMB << 20;
-  size_t loopRounds  = opts_result["loop_rounds"].as<size_t>();
+  std::vector<std::string> dsTypes =
+      opts_result["ds_type"].as<std::vector<std::string>>();
+  size_t dsSizeMB   = opts_result["ds_size_mb"].as<size_t>();
+  size_t dsSize     = dsSizeMB << 20;
+  size_t loopRounds = opts_result["loop_rounds"].as<size_t>();
 
-  int setterCore     = opts_result["setter_core"].as<int>();
-  int getterCore     = opts_result["getter_core"].as<int>();
-  int setterNumaNode = opts_result["setter_numa_node"].as<int>();
-  int getterNumaNode = opts_result["getter_numa_node"].as<int>();
-  int dsNumaNode     = opts_result["ds_numa_node"].as<int>();
+  int setterNumaNode  = opts_result["setter_numa_node"].as<int>();
+  int getterNumaNode  = opts_result["getter_numa_node"].as<int>();
+  int dsNumaNode      = opts_result["ds_numa_node"].as<int>();
+  int dsMetaNumaNode  = opts_result["ds_meta_numa_node"].as<int>();
+  int dsEntryNumaNode = opts_result["ds_entry_numa_node"].as<int>();
+
+  CXLBenchConfig config;
+  config.size            = dsSize;
+  config.dsNumaNode      = dsNumaNode;
+  config.dsMetaNumaNode  = dsMetaNumaNode < 0 ? dsNumaNode : dsMetaNumaNode;
+  config.dsEntryNumaNode = dsEntryNumaNode < 0 ? dsNumaNode : dsEntryNumaNode;
+  config.setterNumaNode  = setterNumaNode;
+  config.getterNumaNode  = getterNumaNode;
+  config.setterCores     =
+      thread_cores(opts_result["setter_core"].as<std::vector<int>>(),
+                   opts_result["setter_threads"].as<size_t>());
+  config.getterCores     =
+      thread_cores(opts_result["getter_core"].as<std::vector<int>>(),
+                   opts_result["getter_threads"].as<size_t>());
+  config.sampleInterval  = opts_result["latency_sample_interval"].as<size_t>();
+  config.keyDist.zipfTheta  = opts_result["zipf_theta"].as<double>();
+  config.keyDist.hotOpsPct  = opts_result["hotspot_ops_pct"].as<double>();
+  config.keyDist.hotKeysPct = opts_result["hotspot_keys_pct"].as<double>();
+  if (!parse_key_distribution(opts_result["key_dist"].as<std::string>(),
+                              &config.keyDist.type)) {
+    std::cerr << "Key distribution is not supported!" << std::endl;
+    return 1;
+  }
+  if (config.keyDist.zipfTheta <= 0.0 || config.keyDist.zipfTheta >= 1.0) {
+    std::cerr << "zipf_theta must be in (0, 1)" << std::endl;
+    return 1;
+  }
+  config.batchSize = opts_result["batch_size"].as<size_t>();
+  if (config.batchSize == 0) {
+    std::cerr << "batch_size must be at least 1" << std::endl;
+    return 1;
+  }
+
+  config.workload.enabled = false;
+  std::string workload    = opts_result["workload"].as<std::string>();
+  if (!workload.empty() && opts_result.count("workload_mix")) {
+    std::cerr << "workload and workload_mix are exclusive" << std::endl;
+    return 1;
+  }
+  if (!workload.empty() && !parse_workload(workload, &config.workload)) {
+    std::cerr << "Workload is not supported!" << std::endl;
+    return 1;
+  }
+  if (opts_result.count("workload_mix") &&
+      !parse_workload_mix(
+          opts_result["workload_mix"].as<std::vector<double>>(),
+          &config.workload)) {
+    std::cerr << "workload_mix needs 5 or 6 percents adding up to 100"
+              << std::endl;
+    return 1;
+  }
+  if (config.keyDist.hotOpsPct < 0.0 || config.keyDist.hotOpsPct > 100.0 ||
+      config.keyDist.hotKeysPct <= 0.0 || config.keyDist.hotKeysPct > 100.0) {
+    std::cerr << "hotspot percentages must be in [0, 100]" << std::endl;
+    return 1;
+  }
+  if (config.setterCores.empty() || config.getterCores.empty()) {
+    std::cerr << "At least one setter and one getter thread are required"
+              << std::endl;
+    return 1;
+  }
+
+  // named structures must all fit the config, all skips those that do not
+  std::vector<const BenchEntry *> benches;
+  if (dsTypes.size() == 1 && dsTypes[0] == "all") {
+    for (const BenchEntry &bench : BenchRegistry::instance().entries()) {
+      if (!bench.capabilities.inAll) {
+        continue;
+      }
+      if (const char *reason = unsupported(bench, config)) {
+        std::cout << "Skipping " << bench.name << ", it " << reason
+                  << std::endl;
+        continue;
+      }
+      benches.push_back(&bench);
+    }
+  } else {
+    for (const std::string &dsType : dsTypes) {
+      const BenchEntry *bench = BenchRegistry::instance().find(dsType);
+      if (bench == nullptr) {
+        std::cerr << "Data structure type is not supported: " << dsType
+                  << std::endl;
+        return 1;
+      }
+      if (const char *reason = unsupported(*bench, config)) {
+        std::cerr << dsType << " " << reason << std::endl;
+        return 1;
+      }
+      benches.push_back(bench);
+    }
+  }
 
   // disable transparent huge page table
   if (prctl(PR_SET_THP_DISABLE, 1, 0, 0, 0) == -1) {
@@ -67,161 +251,18 @@ int main(int argc, char *argv[]) {
     return 1;
   }
 
-  // bind the main thread to the numa node of the data structure
-  bind_numa_node(dsNumaNode);
-
-  if (dsType == "boost_spsc_queue") {
-    typedef boost::lockfree::spsc_queue<uint64_t> q_t;
-    CXLBench<q_t> bench(dsSize, dsNumaNode, setterNumaNode, getterNumaNode,
-                        setterCore, getterCore);
-    bench.init();
-    bench.run(loopRounds);
-    bench.clean();
-  } else if (dsType == "boost_mpmc_queue") {
-    typedef boost::lockfree::queue<uint64_t> q_t;
-    CXLBench<q_t> bench(dsSize, dsNumaNode, setterNumaNode, getterNumaNode,
-                        setterCore, getterCore);
-    bench.init();
-    bench.run(loopRounds);
-    bench.clean();
-  } else if (dsType == "folly_atomichashmap_map") {
-    typedef folly::AtomicHashMap<uint64_t, uint64_t> map_t;
-    CXLBench<map_t> bench(dsSize, dsNumaNode, setterNumaNode, getterNumaNode,
-                          setterCore, getterCore);
-    bench.init();
-    bench.run(loopRounds);
-    bench.clean();
-  } else if (dsType == "libcds_michaelhashmap_map") {
-    // Initialize libcds
-    cds::Initialize();
-    {
-      cds::gc::HP hpGC;
-      cds::threading::Manager::attachThread();
-
-      typedef cds::container::MichaelHashMap<cds::gc::HP, MichaelListT,
-                                             MichaelMapTraits>
-          map_t;
-      CXLBench<map_t> bench(dsSize, dsNumaNode, setterNumaNode, getterNumaNode,
-                            setterCore, getterCore);
-      bench.init();
-      bench.run(loopRounds);
-      bench.clean();
-
-      // Detach thread when terminating
-      cds::threading::Manager::detachThread();
-    }
-    // Terminate libcds
-    cds::Terminate();
-  } else if (dsType == "libcds_feldmanhashmap_map") {
-    // Initialize libcds
-    cds::Initialize();
-    {
-      cds::gc::HP hpGC;
-      cds::threading::Manager::attachThread();
-
-      typedef cds::container::FeldmanHashMap<cds::gc::HP, uint64_t, uint64_t>
-          map_t;
-      CXLBench<map_t> bench(dsSize, dsNumaNode, setterNumaNode, getterNumaNode,
-                            setterCore, getterCore);
-      bench.init();
-      bench.run(loopRounds);
-      bench.clean();
-
-      // Detach thread when terminating
-      cds::threading::Manager::detachThread();
-    }
-    // Terminate libcds
-    cds::Terminate();
-  } else if (dsType == "libcds_skiplistmap_map") {
-    // Initialize libcds
-    cds::Initialize();
-    {
-      cds::gc::HP myhp(67);
-      cds::threading::Manager::attachThread();
-
-      typedef cds::container::SkipListMap<cds::gc::HP, uint64_t, uint64_t>
-          map_t;
-      CXLBench<map_t> bench(dsSize, dsNumaNode, setterNumaNode, getterNumaNode,
-                            setterCore, getterCore);
-      bench.init();
-      bench.run(loopRounds);
-      bench.clean();
-
-      // Detach thread when terminating
-      cds::threading::Manager::detachThread();
-    }
-    // Terminate libcds
-    cds::Terminate();
-  } else if (dsType == "libcds_bronsonavltreemap_map") {
-    // Initialize libcds
-    cds::Initialize();
-    {
-      // Initialize general_buffered RCU
-      cds::urcu::gc<cds::urcu::general_buffered<>> gpbRCU;
-      cds::threading::Manager::attachThread();
-
-      typedef cds::container::BronsonAVLTreeMap<
-          cds::urcu::gc<cds::urcu::general_buffered<>>, uint64_t, uint64_t>
-          map_t;
-      CXLBench<map_t> bench(dsSize, dsNumaNode, setterNumaNode, getterNumaNode,
-                            setterCore, getterCore);
-      bench.init();
-      bench.run(loopRounds);
-      bench.clean();
-
-      // Detach thread when terminating
-      cds::threading::Manager::detachThread();
-    }
-    // Terminate libcds
-    cds::Terminate();
-  } else if (dsType == "junction_linearmap_map") {
-    junction::QSBR::Context context = junction::DefaultQSBR.createContext();
-
-    typedef junction::ConcurrentMap_Linear<uint64_t, uint64_t> map_t;
-    CXLBench<map_t> bench(dsSize, dsNumaNode, setterNumaNode, getterNumaNode,
-                          setterCore, getterCore);
-    bench.init(context);
-    bench.run(loopRounds);
-    bench.clean();
-
-    junction::DefaultQSBR.destroyContext(context);
-    // } else if (dsType == "tervel_wfhashmap_map") {
-    //   tervel::Tervel m_tervel(3); // 3 threads: main, setter, getter
-    //   auto m_context = new tervel::ThreadContext(&m_tervel);
-
-    //   typedef tervel::containers::wf::HashMap<uint64_t, uint64_t> map_t;
-    //   CXLBench<map_t> bench(dsSize, dsNumaNode, setterNumaNode,
-    //   getterNumaNode,
-    //                         setterCore, getterCore);
-    //   bench.init();
-    //   bench.run(loopRounds, &m_tervel);
-    //   bench.clean();
-
-    //   delete m_context;
-  } else if (dsType == "junction_leapfrogmap_map") {
-    junction::QSBR::Context context = junction::DefaultQSBR.createContext();
-
-    typedef junction::ConcurrentMap_Leapfrog<uint64_t, uint64_t> map_t;
-    CXLBench<map_t> bench(dsSize, dsNumaNode, setterNumaNode, getterNumaNode,
-                          setterCore, getterCore);
-    bench.init(context);
-    bench.run(loopRounds);
-    bench.clean();
-
-    junction::DefaultQSBR.destroyContext(context);
-  } else if (dsType == "junction_grampamap_map") {
-    junction::QSBR::Context context = junction::DefaultQSBR.createContext();
-
-    typedef junction::ConcurrentMap_Grampa<uint64_t, uint64_t> map_t;
-    CXLBench<map_t> bench(dsSize, dsNumaNode, setterNumaNode, getterNumaNode,
-                          setterCore, getterCore);
-    bench.init(context);
-    bench.run(loopRounds);
-    bench.clean();
-
-    junction::DefaultQSBR.destroyContext(context);
-  } else {
-    std::cerr << "Data structure type is not supported!" << std::endl;
+  // Every structure runs with the same pinning, placement and rounds. The
+  // arenas are released after each run, when the structure's reclamation
+  // has been torn down and nothing frees into them any more.
+  for (const BenchEntry *bench : benches) {
+    std::cout << "Data structure: " << bench->name << std::endl;
+
+    // bind the main thread to the numa node of the data structure entries,
+    // where whatever the maps allocate outside the arenas should land
+    bind_numa_node(config.dsEntryNumaNode);
+    numa_arena_init(config.dsMetaNumaNode, config.dsEntryNumaNode);
+    bench->run(config, loopRounds);
+    numa_arena_release();
   }
 
   return 0;
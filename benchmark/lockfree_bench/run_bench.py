@@ -79,6 +79,12 @@ def build():
         h_utils_cmd.run("make clean && make")
 
 
+def core_list(cores):
+    if isinstance(cores, (list, tuple)):
+        return ",".join(str(core) for core in cores)
+    return str(cores)
+
+
 def run(machine: str, timestamp: str, results: map):
     with h_utils_path.chdir(h_utils_path.get_workspace_path() / "benchmark/lockfree_bench"):
         
@@ -99,7 +105,12 @@ def run(machine: str, timestamp: str, results: map):
 
 
         ds_configs = {
-            "queue": ["boost_spsc_queue", "boost_mpmc_queue"],
+            "queue": [
+                "boost_spsc_queue",
+                "boost_mpmc_queue",
+                "cxl_spsc_ring_queue",
+                "cxl_mpmc_ring_queue",
+            ],
             "map": [
                 "folly_atomichashmap_map",
                 "junction_linearmap_map",
@@ -115,8 +126,8 @@ def run(machine: str, timestamp: str, results: map):
         # {
         #   machine_name: {
         #       numa_config_name: [
-        #           setter_core,
-        #           getter_core,
+        #           setter_core,  # a core or a list of cores, one thread each
+        #           getter_core,  # a core or a list of cores, one thread each
         #           setter_numa_node,
         #           getter_numa_node,
         #           ds_numa_node
@@ -180,8 +191,8 @@ def run(machine: str, timestamp: str, results: map):
                                 f"--ds_type {ds_type} "
                                 f"--ds_size_mb {ds_size_mb} "
                                 f"--loop_rounds {loop_rounds} "
-                                f"--setter_core {numa_config[0]} "
-                                f"--getter_core {numa_config[1]} "
+                                f"--setter_core {core_list(numa_config[0])} "
+                                f"--getter_core {core_list(numa_config[1])} "
                                 f"--setter_numa_node {numa_config[2]} "
                                 f"--getter_numa_node {numa_config[3]} "
                                 f"--ds_numa_node {numa_config[4]}"
@@ -4,8 +4,15 @@
 
 #include <numa.h>
 #include <numaif.h>
+#include <unistd.h>
 
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iomanip>
 #include <iostream>
+#include <string>
+#include <thread>
 
 #include "utils.hh"
 
@@ -28,3 +35,234 @@ void bind_numa_node(int node) {
   numa_bitmask_setbit(mask, node);
   numa_set_membind(mask);
 }
+
+void count_page_nodes(const void *addr, size_t len,
+                      std::map<int, size_t> &pages) {
+  const size_t kBatch = 4096;
+  uintptr_t pageSize  = sysconf(_SC_PAGESIZE);
+  uintptr_t first     = reinterpret_cast<uintptr_t>(addr) & ~(pageSize - 1);
+  uintptr_t last      = reinterpret_cast<uintptr_t>(addr) + len;
+
+  std::vector<void *> batch;
+  std::vector<int> status(kBatch);
+  for (uintptr_t page = first; page < last; page += pageSize) {
+    batch.push_back(reinterpret_cast<void *>(page));
+    if (batch.size() == kBatch || page + pageSize >= last) {
+      // with no target nodes move_pages only reports where the pages are
+      if (move_pages(0, batch.size(), batch.data(), nullptr, status.data(),
+                     0) != 0) {
+        std::cerr << "move_pages failed: " << strerror(errno) << std::endl;
+        return;
+      }
+      for (size_t i = 0; i < batch.size(); ++i) {
+        pages[status[i]]++;
+      }
+      batch.clear();
+    }
+  }
+}
+
+void report_placement(const std::string &name,
+                      const std::map<int, size_t> &pages) {
+  size_t total = 0;
+  for (const auto &[node, count] : pages) {
+    total += count;
+  }
+
+  // nodes first, then the negative errno of pages move_pages cannot place
+  std::cout << name << " placement: " << total << " pages";
+  for (auto it = pages.lower_bound(0); it != pages.end(); ++it) {
+    std::cout << ", node " << it->first << ": " << it->second;
+  }
+  for (auto it = pages.begin(); it != pages.lower_bound(0); ++it) {
+    if (it->first == -ENOENT) {
+      std::cout << ", not faulted: " << it->second;
+    } else {
+      std::cout << ", error " << -it->first << ": " << it->second;
+    }
+  }
+  std::cout << std::endl;
+}
+
+void report_placement(const std::string &name, const void *addr, size_t len) {
+  std::map<int, size_t> pages;
+  count_page_nodes(addr, len, pages);
+  report_placement(name, pages);
+}
+
+void LatencyHistogram::init(size_t interval) {
+  this->interval  = interval;
+  this->countdown = interval;
+  samples         = 0;
+  maxCycles       = 0;
+  buckets.assign(interval == 0 ? 0 : kBuckets, 0);
+}
+
+static unsigned int bucket_index(uint64_t cycles) {
+  if (cycles < LatencyHistogram::kSubBuckets) {
+    return cycles;
+  }
+  unsigned int msb   = 63 - __builtin_clzll(cycles);
+  unsigned int shift = msb - LatencyHistogram::kSubBits;
+  return (shift + 1) * LatencyHistogram::kSubBuckets +
+         ((cycles >> shift) & (LatencyHistogram::kSubBuckets - 1));
+}
+
+static uint64_t bucket_value(unsigned int index) {
+  if (index < LatencyHistogram::kSubBuckets) {
+    return index;
+  }
+  unsigned int shift = index / LatencyHistogram::kSubBuckets - 1;
+  uint64_t sub       = index % LatencyHistogram::kSubBuckets;
+  return (LatencyHistogram::kSubBuckets | sub) << shift;
+}
+
+void LatencyHistogram::record(uint64_t cycles) {
+  buckets[bucket_index(cycles)]++;
+  samples++;
+  maxCycles = std::max(maxCycles, cycles);
+}
+
+void LatencyHistogram::merge(const LatencyHistogram &other) {
+  if (other.samples == 0) {
+    return;
+  }
+  if (buckets.empty()) {
+    buckets.assign(kBuckets, 0);
+    interval = other.interval;
+  }
+  for (unsigned int i = 0; i < kBuckets; ++i) {
+    buckets[i] += other.buckets[i];
+  }
+  samples += other.samples;
+  maxCycles = std::max(maxCycles, other.maxCycles);
+}
+
+// lower bound of the bucket holding the p-th percentile sample
+uint64_t LatencyHistogram::percentile(double p) const {
+  if (samples == 0) {
+    return 0;
+  }
+  uint64_t rank = static_cast<uint64_t>(p / 100.0 * (samples - 1)) + 1;
+  uint64_t seen = 0;
+  for (unsigned int i = 0; i < kBuckets; ++i) {
+    seen += buckets[i];
+    if (seen >= rank) {
+      return std::min(bucket_value(i), maxCycles);
+    }
+  }
+  return maxCycles;
+}
+
+uint64_t elapsed_ns(std::chrono::steady_clock::time_point start,
+                    std::chrono::steady_clock::time_point end) {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(end - start)
+      .count();
+}
+
+// TSC cycles per ns, measured once against the steady clock
+static double tsc_per_ns() {
+  static double ratio = 0.0;
+  if (ratio == 0.0) {
+    auto clockStart   = std::chrono::steady_clock::now();
+    uint64_t tscStart = __rdtsc();
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    uint64_t tscEnd = __rdtsc();
+    auto clockEnd   = std::chrono::steady_clock::now();
+    ratio = (tscEnd - tscStart) /
+            static_cast<double>(elapsed_ns(clockStart, clockEnd));
+  }
+  return ratio;
+}
+
+// ops per ns is the same number as Gops/s, scale it to Mops/s
+double mops(size_t ops, uint64_t ns) {
+  return ns == 0 ? 0.0 : ops * 1000.0 / ns;
+}
+
+void report_role(const std::string &role,
+                 const std::vector<ThreadResult> &results) {
+  if (results.empty()) {
+    return;
+  }
+
+  size_t ops = 0;
+  auto start = results[0].start;
+  auto end   = results[0].end;
+  for (size_t i = 0; i < results.size(); ++i) {
+    const ThreadResult &r = results[i];
+    uint64_t ns           = elapsed_ns(r.start, r.end);
+    std::cout << role << " " << i << " (core " << r.core << "): " << r.ops
+              << " ops in " << ns << " ns, " << mops(r.ops, ns) << " Mops/s"
+              << std::endl;
+    ops += r.ops;
+    start = std::min(start, r.start);
+    end   = std::max(end, r.end);
+  }
+  std::cout << role << " aggregate: " << ops << " ops, "
+            << mops(ops, elapsed_ns(start, end)) << " Mops/s" << std::endl;
+}
+
+static LatencyHistogram
+merge_latency(const std::vector<ThreadResult> &results) {
+  LatencyHistogram latency;
+  for (const ThreadResult &r : results) {
+    latency.merge(r.latency);
+  }
+  return latency;
+}
+
+void report_latency(const std::string &op, const LatencyHistogram &latency) {
+  if (latency.count() == 0) {
+    return;
+  }
+
+  static const struct {
+    const char *name;
+    double value;
+  } percentiles[] = {
+      {"p50", 50.0}, {"p90", 90.0}, {"p99", 99.0}, {"p99.9", 99.9},
+      {"p99.99", 99.99},
+  };
+  double ratio = tsc_per_ns();
+
+  std::cout << op << " latency, 1 of every " << latency.sampleInterval()
+            << " ops sampled:" << std::endl;
+  std::cout << "  samples: " << latency.count() << std::endl;
+  for (const auto &p : percentiles) {
+    uint64_t cycles = latency.percentile(p.value);
+    std::cout << "  " << p.name << ": " << cycles / ratio << " ns, " << cycles
+              << " cycles" << std::endl;
+  }
+  std::cout << "  max: " << latency.max() / ratio << " ns, " << latency.max()
+            << " cycles" << std::endl;
+}
+
+// The last line keeps the "<ns> ns" wall time of the whole run that
+// run_bench.py parses, every other line starts with a word.
+void report_results(const char *setterOp,
+                    const std::vector<ThreadResult> &setters,
+                    const char *getterOp,
+                    const std::vector<ThreadResult> &getters) {
+  std::vector<ThreadResult> all(setters);
+  all.insert(all.end(), getters.begin(), getters.end());
+
+  size_t ops = 0;
+  auto start = all[0].start;
+  auto end   = all[0].end;
+  for (const ThreadResult &r : all) {
+    ops += r.ops;
+    start = std::min(start, r.start);
+    end   = std::max(end, r.end);
+  }
+
+  std::cout << std::fixed << std::setprecision(2);
+  report_role("setter", setters);
+  report_role("getter", getters);
+  std::cout << "total aggregate: " << ops << " ops, "
+            << mops(ops, elapsed_ns(start, end)) << " Mops/s" << std::endl;
+  report_latency(setterOp, merge_latency(setters));
+  report_latency(getterOp, merge_latency(getters));
+
+  std::cout << elapsed_ns(start, end) << " ns" << std::endl;
+}
@@ -2,8 +2,96 @@
 #define CXLBENCH_UTILS_H
 
 #include <pthread.h>
+#include <x86intrin.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+// Per-thread latency histogram of every Nth operation, in TSC cycles.
+// Buckets are log-linear: 16 linear sub-buckets per power of two, so a
+// percentile is accurate to 1/16 of its value. The buckets are allocated
+// by init() before timing starts.
+class LatencyHistogram {
+public:
+  static constexpr unsigned kSubBits    = 4;
+  static constexpr unsigned kSubBuckets = 1 << kSubBits;
+  static constexpr unsigned kBuckets    = (64 - kSubBits + 1) * kSubBuckets;
+
+  void init(size_t interval);
+
+  // returns 0 when this operation is not sampled
+  inline uint64_t begin() {
+    if (interval == 0 || --countdown != 0) {
+      return 0;
+    }
+    countdown = interval;
+    _mm_lfence();
+    return __rdtsc();
+  }
+
+  inline void end(uint64_t start) {
+    if (start == 0) {
+      return;
+    }
+    unsigned int aux;
+    record(__rdtscp(&aux) - start);
+  }
+
+  void record(uint64_t cycles);
+  void merge(const LatencyHistogram &other);
+  uint64_t percentile(double p) const;
+  uint64_t count() const { return samples; }
+  uint64_t max() const { return maxCycles; }
+  size_t sampleInterval() const { return interval; }
+
+private:
+  size_t interval    = 0;
+  size_t countdown   = 0;
+  uint64_t samples   = 0;
+  uint64_t maxCycles = 0;
+  std::vector<uint64_t> buckets;
+};
+
+// aligned so that threads updating neighbouring results never share a line
+struct alignas(64) ThreadResult {
+  int core;
+  size_t ops;
+  std::chrono::steady_clock::time_point start;
+  std::chrono::steady_clock::time_point end;
+  LatencyHistogram latency;
+};
+
+// Maps that hand out references to their values let several threads
+// write and read one value at once; these keep such accesses atomic.
+inline void store_value(uint64_t &value, uint64_t v) {
+  std::atomic_ref<uint64_t>(value).store(v, std::memory_order_relaxed);
+}
+inline uint64_t load_value(uint64_t &value) {
+  return std::atomic_ref<uint64_t>(value).load(std::memory_order_relaxed);
+}
 
 void set_thread_affinity(pthread_t thread, int core_id);
 void bind_numa_node(int node);
+// Adds the node of every page of [addr, addr + len) to pages, as reported
+// by move_pages. Pages never touched count under -ENOENT.
+void count_page_nodes(const void *addr, size_t len,
+                      std::map<int, size_t> &pages);
+void report_placement(const std::string &name,
+                      const std::map<int, size_t> &pages);
+void report_placement(const std::string &name, const void *addr, size_t len);
+uint64_t elapsed_ns(std::chrono::steady_clock::time_point start,
+                    std::chrono::steady_clock::time_point end);
+double mops(size_t ops, uint64_t ns);
+void report_role(const std::string &role,
+                 const std::vector<ThreadResult> &results);
+void report_latency(const std::string &op, const LatencyHistogram &latency);
+void report_results(const char *setterOp,
+                    const std::vector<ThreadResult> &setters,
+                    const char *getterOp,
+                    const std::vector<ThreadResult> &getters);
 
 #endif